@@ -95,6 +95,16 @@
 #define CH_NO_IDLE_THREAD               FALSE
 #endif
 
+/**
+ * @brief   Tickless idle.
+ * @details The idle thread skips the system ticks before the next virtual
+ *          timer deadline, the "ticks" shell command shows how many timer
+ *          interrupts were actually served.
+ */
+#if !defined(CH_USE_TICKLESS) || defined(__DOXYGEN__)
+#define CH_USE_TICKLESS                 TRUE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
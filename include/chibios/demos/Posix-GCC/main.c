@@ -68,6 +68,26 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
   } while (tp != NULL);
 }
 
+static void cmd_ticks(BaseSequentialStream *chp, int argc, char *argv[]) {
+  systime_t now, irqs;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: ticks\r\n");
+    return;
+  }
+  now = chTimeNow();
+#if CH_USE_TICKLESS
+  irqs = now - vtlist.vt_skipped;
+#else
+  irqs = now;
+#endif
+  chprintf(chp, "system ticks      : %lu\r\n", (uint32_t)now);
+  chprintf(chp, "timer interrupts  : %lu\r\n", (uint32_t)irqs);
+  chprintf(chp, "interrupts/minute : %lu\r\n",
+           now ? (uint32_t)((uint64_t)irqs * S2ST(60) / now) : 0);
+}
+
 static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
   Thread *tp;
 
@@ -88,6 +108,7 @@ static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
 static const ShellCommand commands[] = {
   {"mem", cmd_mem},
   {"threads", cmd_threads},
+  {"ticks", cmd_ticks},
   {"test", cmd_test},
   {NULL, NULL}
 };
@@ -67,8 +67,8 @@ void GDISP_LLD1(drawline)(coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_
 	void GDISP_LLD1(fillarc)(coord_t x, coord_t y, coord_t radius, coord_t startangle, coord_t endangle, color_t color);
 #endif
 #if GDISP_NEED_TEXT
-	void GDISP_LLD1(drawchar)(coord_t x, coord_t y, char c, font_t font, color_t color);
-	void GDISP_LLD1(fillchar)(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+	void GDISP_LLD1(drawchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color);
+	void GDISP_LLD1(fillchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor);
 #endif
 #if GDISP_NEED_PIXELREAD
 	color_t GDISP_LLD1(getpixelcolor)(coord_t x, coord_t y);
@@ -105,8 +105,8 @@ void GDISP_LLD2(drawline)(coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_
 	void GDISP_LLD2(fillarc)(coord_t x, coord_t y, coord_t radius, coord_t startangle, coord_t endangle, color_t color);
 #endif
 #if GDISP_NEED_TEXT
-	void GDISP_LLD2(drawchar)(coord_t x, coord_t y, char c, font_t font, color_t color);
-	void GDISP_LLD2(fillchar)(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+	void GDISP_LLD2(drawchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color);
+	void GDISP_LLD2(fillchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor);
 #endif
 #if GDISP_NEED_PIXELREAD
 	color_t GDISP_LLD2(getpixelcolor)(coord_t x, coord_t y);
@@ -144,8 +144,8 @@ void GDISP_LLD_VMT(fillellipse)(coord_t x, coord_t y, coord_t a, coord_t b, colo
 
 /* Text Rendering Functions */
 #if GDISP_NEED_TEXT
-void GDISP_LLD_VMT(drawchar)(coord_t x, coord_t y, char c, font_t font, color_t color);
-void GDISP_LLD_VMT(fillchar)(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+void GDISP_LLD_VMT(drawchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color);
+void GDISP_LLD_VMT(fillchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor);
 #endif
 
 /* Pixel readback */
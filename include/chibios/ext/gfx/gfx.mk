@@ -5,6 +5,7 @@ endif
 
 GFXSRC +=   $(GFXLIB)/src/gdisp.c \
             $(GFXLIB)/src/gdisp_fonts.c \
+            $(GFXLIB)/src/gdisp_image.c \
 			$(GFXLIB)/src/gevent.c \
 			$(GFXLIB)/src/gtimer.c \
             $(GFXLIB)/src/gwin.c \
@@ -97,6 +97,39 @@
 	#ifndef GDISP_NEED_ASYNC
 		#define GDISP_NEED_ASYNC	FALSE
 	#endif
+
+	/**
+	 * @brief   Are compressed image functions needed.
+	 * @details	Defaults to FALSE
+	 */
+	#ifndef GDISP_NEED_IMAGE
+		#define GDISP_NEED_IMAGE	FALSE
+	#endif
+
+	/**
+	 * @brief   The number of pixels decoded before each blit when drawing an image.
+	 * @details	Defaults to 64
+	 * @note	The buffer lives on the stack of the drawing thread.
+	 */
+	#ifndef GDISP_IMAGE_BLIT_PIXELS
+		#define GDISP_IMAGE_BLIT_PIXELS	64
+	#endif
+
+	/**
+	 * @brief   Are laid out text runs needed.
+	 * @details	Defaults to FALSE
+	 */
+	#ifndef GDISP_NEED_TEXTRUN
+		#define GDISP_NEED_TEXTRUN	FALSE
+	#endif
+
+	/**
+	 * @brief   The maximum number of lines in a text run.
+	 * @details	Defaults to 8
+	 */
+	#ifndef GDISP_TEXTRUN_MAX_LINES
+		#define GDISP_TEXTRUN_MAX_LINES	8
+	#endif
 /** @} */
 
 #if GDISP_NEED_MULTITHREAD && GDISP_NEED_ASYNC
@@ -134,6 +167,28 @@ typedef enum justify {justifyLeft, justifyCenter, justifyRight} justify_t;
  */
 typedef enum fontmetric {fontHeight, fontDescendersHeight, fontLineSpacing, fontCharPadding, fontMinWidth, fontMaxWidth} fontmetric_t;
 
+#if (GDISP_NEED_TEXT && GDISP_NEED_TEXTRUN) || defined(__DOXYGEN__)
+/**
+ * @brief   A laid out text run.
+ * @details	Filled in once by gdispTextRunLayout() and then drawn as often
+ *			as needed. The string must not change while the run is in use.
+ */
+typedef struct textrun {
+	const char			*str;
+	font_t				font;
+	coord_t				cx, cy;			/**< The box the text was laid out for */
+	coord_t				y;				/**< The offset of the first line in the box */
+	coord_t				width;			/**< The width of the widest line */
+	uint8_t				lineCount;
+	struct textline {
+		uint16_t		start;			/**< The byte offset of the line in str */
+		uint16_t		length;			/**< The byte length of the line */
+		coord_t			x;				/**< The justified offset of the line in the box */
+		coord_t			width;
+	} lines[GDISP_TEXTRUN_MAX_LINES];
+} textrun_t;
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -204,8 +259,8 @@ extern "C" {
 
 	/* Basic Text Rendering Functions */
 	#if GDISP_NEED_TEXT
-	void gdispDrawChar(coord_t x, coord_t y, char c, font_t font, color_t color);
-	void gdispFillChar(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+	void gdispDrawChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color);
+	void gdispFillChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor);
 	#endif
 	
 	/* Read a pixel Function */
@@ -268,10 +323,22 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	void gdispDrawStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, justify_t justify);
 	void gdispFillStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, color_t bgColor, justify_t justify);
 	coord_t gdispGetFontMetric(font_t font, fontmetric_t metric);
-	coord_t gdispGetCharWidth(char c, font_t font);
+	coord_t gdispGetCharWidth(fontchar_t c, font_t font);
 	coord_t gdispGetStringWidth(const char* str, font_t font);
 #endif
 
+/* Text Run Functions */
+#if GDISP_NEED_TEXT && GDISP_NEED_TEXTRUN
+	void gdispTextRunLayout(textrun_t *run, const char *str, font_t font, coord_t cx, coord_t cy, justify_t justify, bool_t wrap);
+	void gdispDrawTextRun(coord_t x, coord_t y, const textrun_t *run, coord_t scroll, color_t color);
+	void gdispFillTextRun(coord_t x, coord_t y, const textrun_t *run, coord_t scroll, color_t color, color_t bgcolor);
+#endif
+
+/* Compressed Image Functions */
+#if GDISP_NEED_IMAGE
+	void gdispDrawImagePart(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, image_t img);
+#endif
+
 /* Extra Arc Functions */
 #if GDISP_NEED_ARC
 	void gdispDrawRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color);
@@ -289,6 +356,9 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 /* Now obsolete functions */
 #define gdispBlitArea(x, y, cx, cy, buffer)						gdispBlitAreaEx(x, y, cx, cy, 0, 0, cx, buffer)
 
+/* Draw a whole compressed image */
+#define gdispDrawImage(x, y, img)								gdispDrawImagePart(x, y, 0x7FFF, 0x7FFF, 0, 0, img)
+
 /* Macro definitions for common gets and sets */
 #define gdispSetPowerMode(powerMode)			gdispControl(GDISP_CONTROL_POWER, (void *)(unsigned)(powerMode))
 #define gdispSetOrientation(newOrientation)		gdispControl(GDISP_CONTROL_ORIENTATION, (void *)(unsigned)(newOrientation))
@@ -305,6 +375,13 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 /* More interesting macro's */
 #define gdispUnsetClip()						gdispSetClip(0,0,gdispGetWidth(),gdispGetHeight())
 
+/* Glyph cache statistics - no mutex required as we only read two counters.
+ * Glyphs too large for the cache count as misses.
+ */
+#if GDISP_NEED_TEXT && GDISP_NEED_GLYPHCACHE
+	#define gdispGetGlyphCacheStats(hits, misses)	GDISP_LLD(glyphcachestats)(hits, misses)
+#endif
+
 
 #ifdef __cplusplus
 }
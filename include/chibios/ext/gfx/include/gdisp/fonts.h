@@ -63,6 +63,24 @@
  *				3. Each characters array of column data (fontcolumn_t)
  *			Each sub-structure must be padded to a multiple of 8 bytes
  *			to allow the tables to work across many different compilers.
+ * @note	A span font sets @p spanTable instead of @p dataTable. The offset
+ *			table then holds byte offsets into @p spanTable and the font is
+ *			not limited by @p GDISP_MAX_FONT_HEIGHT. Each glyph is stored as:
+ *				1. The first row with pixels (uint8_t)
+ *				2. The number of rows following it (uint8_t)
+ *				3. For every row an op byte:
+ *					0nnnnnnn	- n spans follow, each as an x offset byte and
+ *								  an aa:2/length:6 byte. aa is the 2 bit coverage
+ *								  (3 = solid) of the span.
+ *					1nnnnnnn	- repeat the previous row n+1 times.
+ *			Span fonts are generated from BDF files by tools/bdf2font.
+ * @note	Characters are unicode code points. The range @p minChar to
+ *			@p maxChar is indexed directly. Any further characters are listed
+ *			in ascending order in @p charTable and found by a binary search;
+ *			their widths and offsets follow those of the direct range. A font
+ *			without a direct range sets @p minChar to 1 and @p maxChar to 0.
+ * @note	Characters missing from a font are looked up in its @p fallback
+ *			font (and so on down the chain) by the string functions.
  */
 struct font {
 	uint8_t				height;
@@ -78,14 +96,75 @@ struct font {
 	const uint8_t		*widthTable;
 	const uint16_t      *offsetTable;
 	const fontcolumn_t  *dataTable;
+	const uint8_t		*spanTable;
+	const uint16_t		*charTable;
+	uint16_t			charCount;
+	const struct font	*fallback;
 };
 
+/**
+ * @brief   Get the table index of a character.
+ * @return  The index into the width and offset tables or -1 if the font
+ *			does not have the character.
+ */
+static inline int _getCharIndex(const struct font *f, unsigned c) {
+	unsigned	lo, hi, mid;
+
+	if (c >= (uint8_t)f->minChar && c <= (uint8_t)f->maxChar)
+		return c - (uint8_t)f->minChar;
+
+	lo = 0;
+	hi = f->charCount;
+	while(lo < hi) {
+		mid = (lo + hi) / 2;
+		if (f->charTable[mid] == c)
+			return (uint8_t)f->maxChar - (uint8_t)f->minChar + 1 + mid;
+		if (f->charTable[mid] < c)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return -1;
+}
+
+/**
+ * @brief   Get the font in the fallback chain of @p f that has a character.
+ * @return  The font or NULL if no font in the chain has the character.
+ */
+static inline const struct font *_getCharFont(const struct font *f, unsigned c) {
+	for(; f; f = f->fallback) {
+		if (_getCharIndex(f, c) >= 0)
+			return f;
+	}
+	return 0;
+}
+
+/**
+ * @brief   Get the width of a character, 0 if the font does not have it.
+ */
+static inline uint8_t _getCharWidth(const struct font *f, unsigned c) {
+	int		i;
+
+	i = _getCharIndex(f, c);
+	return i < 0 ? 0 : f->widthTable[i];
+}
+
 /**
  * @brief   Macros to get to the complex parts of the font structure.
+ * @note	Only valid for characters the font has.
  */
-#define _getCharWidth(f,c)		(((c) < (f)->minChar || (c) > (f)->maxChar) ? 0 : (f)->widthTable[(c) - (f)->minChar])
-#define _getCharOffset(f,c)		((f)->offsetTable[(c) - (f)->minChar])
+#define _getCharOffset(f,c)		((f)->offsetTable[_getCharIndex(f, c)])
 #define _getCharData(f,c)		(&(f)->dataTable[_getCharOffset(f, c)])
+#define _getCharSpans(f,c)		(&(f)->spanTable[_getCharOffset(f, c)])
+
+/**
+ * @brief   Span font op byte and span helpers.
+ */
+#define FONT_SPAN_REPEAT		0x80
+#define FONT_SPAN_COUNT_MASK	0x7F
+#define FONT_SPAN_AA(l)			((l) >> 6)
+#define FONT_SPAN_LENGTH(l)		((l) & 0x3F)
+#define FONT_SPAN_SOLID			3
 
 #endif /* _GDISP_FONTS_H */
 /** @} */
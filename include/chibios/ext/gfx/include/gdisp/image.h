@@ -0,0 +1,180 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    include/gdisp/image.h
+ * @brief   GDISP internal compressed image definitions.
+ * @details	This is not generally needed by an application. It is used
+ * 			by the image drawing routines and by the host side encoder.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+
+#ifndef _GDISP_IMAGE_H
+#define _GDISP_IMAGE_H
+
+/* Don't test against GFX_USE_GDISP as we may want to use this in other non-GDISP utilities. */
+
+/**
+ * @brief   The image opcodes.
+ * @details	The stream is a QOI style byte oriented encoding of RGB565 pixels.
+ *			Every opcode starts on a byte boundary and is identified by its
+ *			top two bits (or the whole byte for the two 8 bit tags).
+ *				IMAGE_OP_INDEX	00iiiiii			- pixel from the 64 entry color index
+ *				IMAGE_OP_DIFF	01rrggbb			- r, g and b each differ by -2..1
+ *				IMAGE_OP_LUMA	10gggggg rrrrbbbb	- g differs by -32..31, r and b by g-8..g+7
+ *				IMAGE_OP_RUN	11nnnnnn			- repeat the previous pixel n+1 times (n < 62)
+ *				IMAGE_OP_RGB	11111110 hhhhhhhh llllllll	- a literal RGB565 pixel
+ *				IMAGE_OP_LRUN	11111111 nnnnnnnn	- repeat the previous pixel n+63 times
+ */
+#define IMAGE_OP_INDEX		0x00
+#define IMAGE_OP_DIFF		0x40
+#define IMAGE_OP_LUMA		0x80
+#define IMAGE_OP_RUN		0xC0
+#define IMAGE_OP_RGB		0xFE
+#define IMAGE_OP_LRUN		0xFF
+#define IMAGE_OP_MASK		0xC0
+
+/**
+ * @brief   The longest run a single IMAGE_OP_RUN or IMAGE_OP_LRUN can hold.
+ */
+#define IMAGE_RUN_MAX		62
+#define IMAGE_LRUN_MAX		(255+63)
+
+/**
+ * @brief   The color index slot of an RGB565 pixel.
+ */
+#define IMAGE_HASH(c)		((((c) >> 11) * 3 + (((c) >> 5) & 0x3F) * 5 + ((c) & 0x1F) * 7) & 0x3F)
+
+/**
+ * @brief   Internal compressed image structure.
+ * @details	The pixel stream is split into blocks of @p syncRows rows. The
+ *			decoder state (previous pixel, color index and runs) is reset at
+ *			the start of every block so that drawing can start at any block
+ *			without decoding the image from the top.
+ *			@p syncTable holds the byte offset of each block within @p data.
+ */
+struct image {
+	uint16_t			width;
+	uint16_t			height;
+	uint16_t			syncRows;
+	uint16_t			syncCount;
+	const uint32_t		*syncTable;
+	const uint8_t		*data;
+};
+
+/**
+ * @brief   The state of an image decode.
+ */
+typedef struct imagedecoder {
+	const uint8_t		*ptr;
+	uint16_t			pixel;
+	uint16_t			run;
+	uint16_t			index[64];
+} imagedecoder_t;
+
+/**
+ * @brief   Start decoding at the sync block that contains row @p y.
+ * @return  The first row of the sync block. The caller must skip
+ *			(y - return value) rows to get to row @p y.
+ */
+static inline unsigned _imageDecodeStart(imagedecoder_t *d, const struct image *img, unsigned y) {
+	unsigned	i, blk;
+
+	blk = y / img->syncRows;
+	d->ptr = img->data + img->syncTable[blk];
+	d->pixel = 0;
+	d->run = 0;
+	for(i = 0; i < 64; i++)
+		d->index[i] = 0;
+	return blk * img->syncRows;
+}
+
+/**
+ * @brief   Decode the next @p n pixels.
+ * @note	If @p buf is NULL the pixels are decoded but not stored.
+ */
+static inline void _imageDecode(imagedecoder_t *d, uint16_t *buf, unsigned n) {
+	const uint8_t	*p;
+	unsigned		px, r, g, b, op, cnt;
+
+	p = d->ptr;
+	px = d->pixel;
+
+	while(n) {
+		/* Flush any outstanding run first */
+		if (d->run) {
+			cnt = d->run < n ? d->run : n;
+			d->run -= cnt;
+			n -= cnt;
+			if (buf) {
+				while(cnt--)
+					*buf++ = px;
+			}
+			continue;
+		}
+
+		op = *p++;
+		switch(op & IMAGE_OP_MASK) {
+		case IMAGE_OP_INDEX:
+			px = d->index[op];
+			break;
+		case IMAGE_OP_DIFF:
+			r = ((px >> 11) + ((op >> 4) & 0x03) - 2) & 0x1F;
+			g = (((px >> 5) & 0x3F) + ((op >> 2) & 0x03) - 2) & 0x3F;
+			b = ((px & 0x1F) + (op & 0x03) - 2) & 0x1F;
+			px = (r << 11) | (g << 5) | b;
+			break;
+		case IMAGE_OP_LUMA:
+			g = (op & 0x3F) - 32;
+			r = ((px >> 11) + g + (*p >> 4) - 8) & 0x1F;
+			b = ((px & 0x1F) + g + (*p & 0x0F) - 8) & 0x1F;
+			g = (((px >> 5) & 0x3F) + g) & 0x3F;
+			p++;
+			px = (r << 11) | (g << 5) | b;
+			break;
+		default:
+			if (op == IMAGE_OP_RGB) {
+				px = (p[0] << 8) | p[1];
+				p += 2;
+			} else {
+				/* A run - the first pixel of it is emitted below */
+				d->run = op == IMAGE_OP_LRUN ? *p++ + 63u - 1 : op & 0x3Fu;
+				if (buf)
+					*buf++ = px;
+				n--;
+				continue;
+			}
+			break;
+		}
+
+		d->index[IMAGE_HASH(px)] = px;
+		if (buf)
+			*buf++ = px;
+		n--;
+	}
+
+	d->ptr = p;
+	d->pixel = px;
+}
+
+#endif /* _GDISP_IMAGE_H */
+/** @} */
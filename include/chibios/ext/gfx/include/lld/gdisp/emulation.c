@@ -484,8 +484,232 @@
 	#include "gdisp/fonts.h"
 #endif
 
+#if (GDISP_NEED_TEXT && GDISP_NEED_GLYPHCACHE && (!GDISP_HARDWARE_TEXT || !GDISP_HARDWARE_TEXTFILLS)) || defined(__DOXYGEN__)
+	/*
+	 * A cached glyph. The character is pre-expanded (including the font
+	 * scaling) into one bit mask per pixel row, LSBit is the left most pixel.
+	 * A zero width marks an unused slot.
+	 */
+	static struct glyphcache {
+		font_t			font;
+		uint32_t		stamp;
+		fontchar_t		c;
+		uint8_t			width;
+		uint8_t			height;
+		uint32_t		rows[GDISP_GLYPHCACHE_MAX_HEIGHT];
+	} glyphCache[GDISP_GLYPHCACHE_SIZE];
+
+	static uint32_t	glyphCacheClock;
+	static uint32_t	glyphCacheHits;
+	static uint32_t	glyphCacheMisses;
+
+	/*
+	 * @brief				Internal helper function to get a cached glyph
+	 *
+	 * @note				DO NOT USE DIRECTLY!
+	 *
+	 * @param[in] font		The font to use
+	 * @param[in] c			The character to get
+	 *
+	 * @return				The glyph or NULL if it is too large to be cached
+	 *
+	 * @notapi
+	 */
+	static const struct glyphcache *_getGlyph(font_t font, fontchar_t c) {
+		struct glyphcache	*g, *lru;
+		const fontcolumn_t	*ptr;
+		fontcolumn_t		column;
+		uint32_t			mask;
+		coord_t				width, height, xscale, yscale;
+		coord_t				i, j, ys;
+
+		/* Look for the glyph and remember the least recently used slot on the way */
+		lru = glyphCache;
+		for(g = glyphCache; g < &glyphCache[GDISP_GLYPHCACHE_SIZE]; g++) {
+			if (g->width && g->font == font && g->c == c) {
+				g->stamp = ++glyphCacheClock;
+				glyphCacheHits++;
+				return g;
+			}
+			if (g->stamp < lru->stamp)
+				lru = g;
+		}
+
+		/* Glyphs too large for the cache are drawn uncached, they count as misses too */
+		glyphCacheMisses++;
+
+		xscale = font->xscale;
+		yscale = font->yscale;
+		width = _getCharWidth(font, c) * xscale;
+		height = font->height * yscale;
+		if (width > 32 || height > GDISP_GLYPHCACHE_MAX_HEIGHT)
+			return 0;
+
+		/* Expand the font columns into the row masks */
+		g = lru;
+		g->font = font;
+		g->c = c;
+		g->width = width;
+		g->height = height;
+		g->stamp = ++glyphCacheClock;
+		for(j = 0; j < height; j++)
+			g->rows[j] = 0;
+
+		/* A shift by the full 32 bits is undefined, i stays below the width */
+		mask = xscale >= 32 ? 0xFFFFFFFFUL : ((uint32_t)1 << xscale) - 1;
+		ptr = _getCharData(font, c);
+		for(i = 0; i < width; i += xscale) {
+			column = *ptr++;
+			for(j = 0; j < height; j += yscale, column >>= 1) {
+				if (column & 0x01) {
+					for(ys = 0; ys < yscale; ys++)
+						g->rows[j+ys] |= mask << i;
+				}
+			}
+		}
+		return g;
+	}
+
+	/*
+	 * @brief				Internal helper function to draw the set pixels of a glyph
+	 *						as horizontal runs.
+	 *
+	 * @note				DO NOT USE DIRECTLY!
+	 *
+	 * @notapi
+	 */
+	static void _drawGlyph(coord_t x, coord_t y, const struct glyphcache *g, color_t color) {
+		uint32_t	bits;
+		coord_t		i, j, n;
+
+		for(j = 0; j < g->height; j++) {
+			for(bits = g->rows[j], i = 0; bits; ) {
+				if (!(bits & 0x01)) {
+					bits >>= 1;
+					i++;
+					continue;
+				}
+				for(n = 0; bits & 0x01; n++)
+					bits >>= 1;
+				GDISP_LLD(fillarea)(x+i, y+j, n, 1, color);
+				i += n;
+			}
+		}
+	}
+
+	void GDISP_LLD(glyphcachestats)(uint32_t *hits, uint32_t *misses) {
+		*hits = glyphCacheHits;
+		*misses = glyphCacheMisses;
+	}
+#endif
+
+#if (GDISP_NEED_TEXT && (!GDISP_HARDWARE_TEXT || !GDISP_HARDWARE_TEXTFILLS)) || defined(__DOXYGEN__)
+	/*
+	 * @brief				Internal helper function to mix two colors
+	 *
+	 * @note				DO NOT USE DIRECTLY!
+	 *
+	 * @param[in] alpha		The coverage of fg, from 0 (all bg) to FONT_SPAN_SOLID (all fg)
+	 *
+	 * @notapi
+	 */
+	static color_t _blendColor(color_t fg, color_t bg, unsigned alpha) {
+		return RGB2COLOR(
+			(RED_OF(fg) * alpha + RED_OF(bg) * (FONT_SPAN_SOLID - alpha)) / FONT_SPAN_SOLID,
+			(GREEN_OF(fg) * alpha + GREEN_OF(bg) * (FONT_SPAN_SOLID - alpha)) / FONT_SPAN_SOLID,
+			(BLUE_OF(fg) * alpha + BLUE_OF(bg) * (FONT_SPAN_SOLID - alpha)) / FONT_SPAN_SOLID);
+	}
+
+	/*
+	 * @brief				Internal helper function to draw a span font character
+	 *
+	 * @note				DO NOT USE DIRECTLY!
+	 * @note				Repeated rows are drawn as one fill per span. Anti-aliased
+	 *						spans are blended against bgcolor when filling, against the
+	 *						screen if it can be read back, or else drawn solid when at
+	 *						least half covered.
+	 *
+	 * @param[in] x, y		The position for the text
+	 * @param[in] c			The character to draw
+	 * @param[in] font		The font to use
+	 * @param[in] color		The color to use
+	 * @param[in] fill		Fill the character cell with bgcolor first
+	 * @param[in] bgcolor	The background color to use
+	 *
+	 * @notapi
+	 */
+	static void _drawSpanChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, bool_t fill, color_t bgcolor) {
+		const uint8_t	*p, *spans;
+		coord_t			xscale, yscale, rows, h, sx, sl;
+		unsigned		op, n, k, aa;
+
+		xscale = font->xscale;
+		yscale = font->yscale;
+		if (fill)
+			GDISP_LLD(fillarea)(x, y, _getCharWidth(font, c) * xscale, font->height * yscale, bgcolor);
+
+		p = _getCharSpans(font, c);
+		y += *p++ * yscale;
+		rows = *p++;
+		spans = p;
+		n = 0;
+
+		while(rows > 0) {
+			op = *p++;
+			if (op & FONT_SPAN_REPEAT) {
+				/* Draw the previous rows spans again - as one taller fill */
+				h = (op & FONT_SPAN_COUNT_MASK) + 1;
+			} else {
+				n = op;
+				spans = p;
+				p += 2 * n;
+				h = 1;
+			}
+			rows -= h;
+			h *= yscale;
+
+			for(k = 0; k < n; k++) {
+				sx = x + spans[2*k] * xscale;
+				sl = FONT_SPAN_LENGTH(spans[2*k+1]) * xscale;
+				aa = FONT_SPAN_AA(spans[2*k+1]);
+
+				if (aa == FONT_SPAN_SOLID)
+					GDISP_LLD(fillarea)(sx, y, sl, h, color);
+				else if (fill)
+					GDISP_LLD(fillarea)(sx, y, sl, h, _blendColor(color, bgcolor, aa));
+				else {
+					#if GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD
+						coord_t		i, j, x0, y0, x1, y1;
+
+						/* Only read back what is drawn, getpixelcolor() need not check the bounds */
+						#if GDISP_NEED_CLIP || GDISP_NEED_VALIDATION
+							x0 = GDISP.clipx0; y0 = GDISP.clipy0;
+							x1 = GDISP.clipx1; y1 = GDISP.clipy1;
+						#else
+							x0 = 0; y0 = 0;
+							x1 = GDISP.Width; y1 = GDISP.Height;
+						#endif
+						if (x0 < sx) x0 = sx;
+						if (y0 < y) y0 = y;
+						if (x1 > sx + sl) x1 = sx + sl;
+						if (y1 > y + h) y1 = y + h;
+
+						for(j = y0; j < y1; j++)
+							for(i = x0; i < x1; i++)
+								GDISP_LLD(drawpixel)(i, j, _blendColor(color, GDISP_LLD(getpixelcolor)(i, j), aa));
+					#else
+						if (aa >= 2)
+							GDISP_LLD(fillarea)(sx, y, sl, h, color);
+					#endif
+				}
+			}
+			y += h;
+		}
+	}
+#endif
+
 #if GDISP_NEED_TEXT && !GDISP_HARDWARE_TEXT
-	void GDISP_LLD(drawchar)(coord_t x, coord_t y, char c, font_t font, color_t color) {
+	void GDISP_LLD(drawchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color) {
 		const fontcolumn_t	*ptr;
 		fontcolumn_t		column;
 		coord_t				width, height, xscale, yscale;
@@ -495,6 +719,24 @@
 		width = _getCharWidth(font, c);
 		if (!width) return;
 		
+		/* Span fonts are drawn span by span */
+		if (font->spanTable) {
+			_drawSpanChar(x, y, c, font, color, FALSE, color);
+			return;
+		}
+
+		#if GDISP_NEED_GLYPHCACHE
+		{
+			const struct glyphcache	*g;
+
+			/* Draw from the pre-expanded glyph if possible */
+			if ((g = _getGlyph(font, c))) {
+				_drawGlyph(x, y, g, color);
+				return;
+			}
+		}
+		#endif
+
 		xscale = font->xscale;
 		yscale = font->yscale;
 		height = font->height * yscale;
@@ -520,7 +762,7 @@
 #endif
 
 #if GDISP_NEED_TEXT && !GDISP_HARDWARE_TEXTFILLS
-	void GDISP_LLD(fillchar)(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor) {
+	void GDISP_LLD(fillchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor) {
 		coord_t			width, height;
 		coord_t			xscale, yscale;
 		
@@ -533,6 +775,38 @@
 		height = font->height * yscale;
 		width *= xscale;
 
+		/* Span fonts are drawn span by span */
+		if (font->spanTable) {
+			_drawSpanChar(x, y, c, font, color, TRUE, bgcolor);
+			return;
+		}
+
+		/* Method 0: Use the pre-expanded glyph from the glyph cache */
+		#if GDISP_NEED_GLYPHCACHE && !GDISP_HARDWARE_TEXT
+		{
+			const struct glyphcache	*g;
+
+			if ((g = _getGlyph(font, c))) {
+				#if GDISP_HARDWARE_BITFILLS
+					/* Expand and blit one row at a time */
+					pixel_t		buf[32];
+					uint32_t	bits;
+					coord_t		i, j;
+
+					for(j = 0; j < height; j++) {
+						for(bits = g->rows[j], i = 0; i < width; i++, bits >>= 1)
+							gdispPackPixels(buf, width, i, 0, (bits & 0x01) ? color : bgcolor);
+						GDISP_LLD(blitareaex)(x, y+j, width, 1, 0, 0, width, buf);
+					}
+				#else
+					GDISP_LLD(fillarea)(x, y, width, height, bgcolor);
+					_drawGlyph(x, y, g, color);
+				#endif
+				return;
+			}
+		}
+		#endif
+
 		/* Method 1: Use background fill and then draw the text */
 		#if GDISP_HARDWARE_TEXT || GDISP_SOFTWARE_TEXTFILLDRAW
 			
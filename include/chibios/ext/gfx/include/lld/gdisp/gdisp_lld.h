@@ -86,6 +86,34 @@
 		#define GDISP_NEED_TEXT			TRUE
 	#endif
 
+	/**
+	 * @brief   Should drawn characters be kept pre-expanded in a glyph cache.
+	 * @details	Defaults to FALSE
+	 * @note	Only used when the driver has no hardware text support.
+	 *			Each slot takes 12 + 4 * GDISP_GLYPHCACHE_MAX_HEIGHT bytes
+	 *			of RAM.
+	 */
+	#ifndef GDISP_NEED_GLYPHCACHE
+		#define GDISP_NEED_GLYPHCACHE	FALSE
+	#endif
+
+	/**
+	 * @brief   The number of glyphs in the glyph cache.
+	 * @details	Defaults to 16
+	 */
+	#ifndef GDISP_GLYPHCACHE_SIZE
+		#define GDISP_GLYPHCACHE_SIZE	16
+	#endif
+
+	/**
+	 * @brief   The tallest (scaled) glyph the glyph cache can hold.
+	 * @details	Defaults to 32. Wider than 32 pixels or taller glyphs
+	 *			are drawn directly from the font.
+	 */
+	#ifndef GDISP_GLYPHCACHE_MAX_HEIGHT
+		#define GDISP_GLYPHCACHE_MAX_HEIGHT	32
+	#endif
+
 	/**
 	 * @brief   Is scrolling needed.
 	 * @details	Defaults to FALSE
@@ -549,6 +577,15 @@ typedef color_t		pixel_t;
  * @brief   The type of a font.
  */
 typedef const struct font *font_t;
+/**
+ * @brief   The type of a text character (a unicode code point).
+ * @note	Only the basic multilingual plane is supported.
+ */
+typedef uint16_t	fontchar_t;
+/**
+ * @brief   The type of a compressed image.
+ */
+typedef const struct image *image_t;
 /**
  * @brief   Type for the screen orientation.
  */
@@ -604,8 +641,12 @@ extern "C" {
 
 	/* Text Rendering Functions */
 	#if GDISP_NEED_TEXT
-	extern void GDISP_LLD_VMT(drawchar)(coord_t x, coord_t y, char c, font_t font, color_t color);
-	extern void GDISP_LLD_VMT(fillchar)(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+	extern void GDISP_LLD_VMT(drawchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color);
+	extern void GDISP_LLD_VMT(fillchar)(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor);
+	#endif
+
+	#if GDISP_NEED_TEXT && GDISP_NEED_GLYPHCACHE
+	extern void GDISP_LLD_VMT(glyphcachestats)(uint32_t *hits, uint32_t *misses);
 	#endif
 
 	/* Pixel readback */
@@ -153,14 +153,14 @@ typedef union gdisp_lld_msg {
 	struct gdisp_lld_msg_drawchar {
 		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_DRAWCHAR
 		coord_t				x, y;
-		char				c;
+		fontchar_t			c;
 		font_t				font;
 		color_t				color;
 	} drawchar;
 	struct gdisp_lld_msg_fillchar {
 		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_FILLCHAR
 		coord_t				x, y;
-		char				c;
+		fontchar_t			c;
 		font_t				font;
 		color_t				color;
 		color_t				bgcolor;
@@ -131,6 +131,105 @@
 	}
 #endif
 
+#if GDISP_NEED_TEXT
+	/**
+	 * @brief   Decode the next UTF-8 character of a string.
+	 * @return  The character. Invalid sequences and characters outside the
+	 *			basic multilingual plane return U+FFFD.
+	 *
+	 * @param[in,out] pstr	The string position, moved past the character
+	 *
+	 * @notapi
+	 */
+	static fontchar_t _decodeUTF8(const char **pstr) {
+		const uint8_t	*s;
+		uint32_t		c;
+		unsigned		n;
+
+		s = (const uint8_t *)*pstr;
+		c = *s++;
+		if (c < 0x80)				n = 0;
+		else if ((c & 0xE0) == 0xC0) {	c &= 0x1F; n = 1; }
+		else if ((c & 0xF0) == 0xE0) {	c &= 0x0F; n = 2; }
+		else if ((c & 0xF8) == 0xF0) {	c &= 0x07; n = 3; }
+		else {
+			*pstr = (const char *)s;
+			return 0xFFFD;
+		}
+		while(n--) {
+			/* A truncated sequence - leave the next byte for the next character */
+			if ((*s & 0xC0) != 0x80) {
+				c = 0xFFFD;
+				break;
+			}
+			c = (c << 6) | (*s++ & 0x3F);
+		}
+		*pstr = (const char *)s;
+		return c > 0xFFFF ? 0xFFFD : (fontchar_t)c;
+	}
+
+	/**
+	 * @brief   Get the next character of a string and the font to draw it with.
+	 * @return  The width of the character in pixels, 0 if no font in the
+	 *			fallback chain has it.
+	 *
+	 * @param[in,out] pstr	The string position, moved past the character
+	 * @param[in] font		The font to use
+	 * @param[out] pc		The character
+	 * @param[out] pf		The font in the fallback chain that has the character
+	 *
+	 * @notapi
+	 */
+	static coord_t _getNextChar(const char **pstr, font_t font, fontchar_t *pc, font_t *pf) {
+		*pc = _decodeUTF8(pstr);
+		if (!(*pf = _getCharFont(font, *pc)))
+			return 0;
+		return _getCharWidth(*pf, *pc) * (*pf)->xscale;
+	}
+
+	/* The offset that puts a fallback font character on the base line of the string font */
+	#define _baseLineOffset(font, f)	((coord_t)(((font)->height - (font)->descenderHeight) * (font)->yscale \
+											- ((f)->height - (f)->descenderHeight) * (f)->yscale))
+
+	/**
+	 * @brief   Draw a character of a string.
+	 * @details	A character from a fallback font is aligned on the base line of
+	 *			the string font. When filling, any part of the string font
+	 *			height the fallback font does not cover is filled as well.
+	 *
+	 * @param[in] x,y		The position for the text
+	 * @param[in] c			The character to draw
+	 * @param[in] font		The font of the string
+	 * @param[in] f			The font that has the character
+	 * @param[in] w			The width of the character
+	 * @param[in] color		The color to use
+	 * @param[in] fill		Fill the background
+	 * @param[in] bgcolor	The background color to use
+	 *
+	 * @notapi
+	 */
+	static void _putChar(coord_t x, coord_t y, fontchar_t c, font_t font, font_t f, coord_t w, color_t color, bool_t fill, color_t bgcolor) {
+		coord_t		dy, h, fh;
+
+		dy = 0;
+		if (f != font) {
+			dy = _baseLineOffset(font, f);
+			if (fill) {
+				h = font->height * font->yscale;
+				fh = f->height * f->yscale;
+				if (dy > 0)
+					gdispFillArea(x, y, w, dy, bgcolor);
+				if (dy + fh < h)
+					gdispFillArea(x, y + dy + fh, w, h - dy - fh, bgcolor);
+			}
+		}
+		if (fill)
+			gdispFillChar(x, y + dy, c, f, color, bgcolor);
+		else
+			gdispDrawChar(x, y + dy, c, f, color);
+	}
+#endif
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -603,13 +702,13 @@ void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t r
 	 *
 	 * @api
 	 */
-	void gdispDrawChar(coord_t x, coord_t y, char c, font_t font, color_t color) {
+	void gdispDrawChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color) {
 		chMtxLock(&gdispMutex);
 		GDISP_LLD(drawchar)(x, y, c, font, color);
 		chMtxUnlock();
 	}
 #elif GDISP_NEED_TEXT && GDISP_NEED_ASYNC
-	void gdispDrawChar(coord_t x, coord_t y, char c, font_t font, color_t color) {
+	void gdispDrawChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color) {
 		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_DRAWCHAR);
 		p->drawchar.x = x;
 		p->drawchar.y = y;
@@ -632,13 +731,13 @@ void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t r
 	 *
 	 * @api
 	 */
-	void gdispFillChar(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor) {
+	void gdispFillChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor) {
 		chMtxLock(&gdispMutex);
 		GDISP_LLD(fillchar)(x, y, c, font, color, bgcolor);
 		chMtxUnlock();
 	}
 #elif GDISP_NEED_TEXT && GDISP_NEED_ASYNC
-	void gdispFillChar(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor) {
+	void gdispFillChar(coord_t x, coord_t y, fontchar_t c, font_t font, color_t color, color_t bgcolor) {
 		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_FILLCHAR);
 		p->fillchar.x = x;
 		p->fillchar.y = y;
@@ -795,6 +894,8 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 #if GDISP_NEED_TEXT || defined(__DOXYGEN__)
 	/**
 	 * @brief   Draw a text string.
+	 * @note	All string functions take UTF-8 strings. Characters missing
+	 *			from @p font are taken from its fallback fonts.
 	 *
 	 * @param[in] x,y		The position for the text
 	 * @param[in] font		The font to use
@@ -806,7 +907,8 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	void gdispDrawString(coord_t x, coord_t y, const char *str, font_t font, color_t color) {
 		/* No mutex required as we only call high level functions which have their own mutex */
 		coord_t		w, p;
-		char		c;
+		fontchar_t	c;
+		font_t		f;
 		int			first;
 		
 		if (!str) return;
@@ -815,8 +917,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		p = font->charPadding * font->xscale;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
-			w = _getCharWidth(font, c) * font->xscale;
+			w = _getNextChar(&str, font, &c, &f);
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
@@ -828,7 +929,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			}
 			
 			/* Print the character */
-			gdispDrawChar(x, y, c, font, color);
+			_putChar(x, y, c, font, f, w, color, FALSE, 0);
 			x += w;
 		}
 	}
@@ -849,7 +950,8 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	void gdispFillString(coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor) {
 		/* No mutex required as we only call high level functions which have their own mutex */
 		coord_t		w, h, p;
-		char		c;
+		fontchar_t	c;
+		font_t		f;
 		int			first;
 		
 		if (!str) return;
@@ -859,8 +961,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		p = font->charPadding * font->xscale;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
-			w = _getCharWidth(font, c) * font->xscale;
+			w = _getNextChar(&str, font, &c, &f);
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
@@ -873,7 +974,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			}
 
 			/* Print the character */
-			gdispFillChar(x, y, c, font, color, bgcolor);
+			_putChar(x, y, c, font, f, w, color, TRUE, bgcolor);
 			x += w;
 		}
 	}
@@ -895,9 +996,10 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	void gdispDrawStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, justify_t justify) {
 		/* No mutex required as we only call high level functions which have their own mutex */
 		coord_t		w, h, p, ypos, xpos;
-		char		c;
+		fontchar_t	c;
+		font_t		f;
 		int			first;
-		const char *rstr;
+		const char *rstr, *s;
 		
 		if (!str) str = "";
 
@@ -933,8 +1035,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				first = 1;
 				while(*str) {
 					/* Get the next printable character */
-					c = *str++;
-					w = _getCharWidth(font, c) * font->xscale;
+					w = _getNextChar(&str, font, &c, &f);
 					if (!w) continue;
 					
 					/* Handle inter-character padding */
@@ -960,8 +1061,9 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			first = 1;
 			for(str--; str >= rstr; str--) {
 				/* Get the next printable character */
-				c = *str;
-				w = _getCharWidth(font, c) * font->xscale;
+				if (((uint8_t)*str & 0xC0) == 0x80) continue;
+				s = str;
+				w = _getNextChar(&s, font, &c, &f);
 				if (!w) continue;
 				
 				/* Handle inter-character padding */
@@ -977,7 +1079,11 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				if (xpos - w < x) break;
 				xpos -= w;
 			}
-			str++;
+			/* Step past the character that did not fit */
+			if (str < rstr)
+				str = rstr;
+			else
+				_decodeUTF8(&str);
 			break;
 		case justifyLeft:
 			/* Fall through */
@@ -990,8 +1096,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		first = 1;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
-			w = _getCharWidth(font, c) * font->xscale;
+			w = _getNextChar(&str, font, &c, &f);
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
@@ -1005,7 +1110,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 
 			/* Print the character */
 			if (xpos + w > x+cx) break;
-			gdispDrawChar(xpos, y, c, font, color);
+			_putChar(xpos, y, c, font, f, w, color, FALSE, 0);
 			xpos += w;
 		}
 	}
@@ -1029,9 +1134,10 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	void gdispFillStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, color_t bgcolor, justify_t justify) {
 		/* No mutex required as we only call high level functions which have their own mutex */
 		coord_t		w, h, p, ypos, xpos;
-		char		c;
+		fontchar_t	c;
+		font_t		f;
 		int			first;
-		const char *rstr;
+		const char *rstr, *s;
 		
 		if (!str) str = "";
 
@@ -1070,8 +1176,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				first = 1;
 				while(*str) {
 					/* Get the next printable character */
-					c = *str++;
-					w = _getCharWidth(font, c) * font->xscale;
+					w = _getNextChar(&str, font, &c, &f);
 					if (!w) continue;
 					
 					/* Handle inter-character padding */
@@ -1097,8 +1202,9 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			first = 1;
 			for(str--; str >= rstr; str--) {
 				/* Get the next printable character */
-				c = *str;
-				w = _getCharWidth(font, c) * font->xscale;
+				if (((uint8_t)*str & 0xC0) == 0x80) continue;
+				s = str;
+				w = _getNextChar(&s, font, &c, &f);
 				if (!w) continue;
 				
 				/* Handle inter-character padding */
@@ -1114,7 +1220,11 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				if (xpos - w < x) break;
 				xpos -= w;
 			}
-			str++;
+			/* Step past the character that did not fit */
+			if (str < rstr)
+				str = rstr;
+			else
+				_decodeUTF8(&str);
 			break;
 		case justifyLeft:
 			/* Fall through */
@@ -1131,8 +1241,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		first = 1;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
-			w = _getCharWidth(font, c) * font->xscale;
+			w = _getNextChar(&str, font, &c, &f);
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
@@ -1147,7 +1256,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 
 			/* Print the character */
 			if (xpos + w > x+cx) break;
-			gdispFillChar(xpos, y, c, font, color, bgcolor);
+			_putChar(xpos, y, c, font, f, w, color, TRUE, bgcolor);
 			xpos += w;
 		}
 		
@@ -1191,9 +1300,13 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	 *
 	 * @api
 	 */
-	coord_t gdispGetCharWidth(char c, font_t font) {
+	coord_t gdispGetCharWidth(fontchar_t c, font_t font) {
 		/* No mutex required as we only read static data */
-		return _getCharWidth(font, c) * font->xscale;
+		font_t	f;
+
+		if (!(f = _getCharFont(font, c)))
+			return 0;
+		return _getCharWidth(f, c) * f->xscale;
 	}
 #endif
 	
@@ -1210,7 +1323,8 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	coord_t gdispGetStringWidth(const char* str, font_t font) {
 		/* No mutex required as we only read static data */
 		coord_t		w, p, x;
-		char		c;
+		fontchar_t	c;
+		font_t		f;
 		int			first;
 		
 		first = 1;
@@ -1218,8 +1332,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		p = font->charPadding * font->xscale;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
-			w = _getCharWidth(font, c)  * font->xscale;
+			w = _getNextChar(&str, font, &c, &f);
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
@@ -1237,6 +1350,243 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	}
 #endif
 
+#if (GDISP_NEED_TEXT && GDISP_NEED_TEXTRUN) || defined(__DOXYGEN__)
+	/**
+	 * @brief   Lay out a text run.
+	 * @details	The string is measured once, broken into lines and each line
+	 *			is justified. The result can then be drawn any number of times
+	 *			without measuring the text again. A newline always starts a
+	 *			new line. Lines that do not fit into @p cy are dropped.
+	 * @note	If @p wrap is FALSE each line is kept whole even if it is wider
+	 *			than @p cx so that it can be scrolled through the box.
+	 *
+	 * @param[out] run		The text run to fill in
+	 * @param[in] str		The UTF-8 string. It must stay unchanged while the run is used.
+	 * @param[in] font		The font to use
+	 * @param[in] cx,cy		The size of the box the text is drawn in
+	 * @param[in] justify	Justify each line left, center or right within the box
+	 * @param[in] wrap		Break lines that are too wide at spaces (or anywhere if a word is too wide)
+	 *
+	 * @api
+	 */
+	void gdispTextRunLayout(textrun_t *run, const char *str, font_t font, coord_t cx, coord_t cy, justify_t justify, bool_t wrap) {
+		/* No mutex required as we only read static data */
+		const char		*s, *cs, *start, *end, *brk, *brknext;
+		struct textline	*l;
+		coord_t			w, lw, brkw, p, h, ls, maxlines;
+		fontchar_t		c;
+		font_t			f;
+		int				first;
+
+		run->str = str;
+		run->font = font;
+		run->cx = cx;
+		run->cy = cy;
+		run->width = 0;
+		run->lineCount = 0;
+
+		if (!str) str = run->str = "";
+
+		h = font->height * font->yscale;
+		ls = font->lineSpacing * font->yscale;
+		p = font->charPadding * font->xscale;
+
+		/* Oops - font too large for the area */
+		if (h > cy) return;
+		maxlines = 1 + (ls ? (cy - h) / ls : 0);
+		if (maxlines > GDISP_TEXTRUN_MAX_LINES)
+			maxlines = GDISP_TEXTRUN_MAX_LINES;
+
+		s = str;
+		while(*s && run->lineCount < maxlines) {
+			start = s;
+			brk = 0;
+			brknext = 0;
+			brkw = 0;
+			lw = 0;
+			first = 1;
+			while(1) {
+				if (!*s) {
+					end = s;
+					break;
+				}
+				if (*s == '\n') {
+					end = s++;
+					break;
+				}
+
+				/* Get the next printable character */
+				cs = s;
+				w = _getNextChar(&s, font, &c, &f);
+				if (c == ' ') {
+					brk = cs;
+					brknext = s;
+					brkw = lw;
+				}
+				if (!w) continue;
+
+				/* Break the line if this character does not fit */
+				if (wrap && !first && lw + p + w > cx) {
+					if (brk) {
+						end = brk;
+						lw = brkw;
+						s = brknext;
+					} else
+						end = s = cs;
+
+					/* The next line does not start with the spaces we broke at */
+					while(*s == ' ')
+						s++;
+					break;
+				}
+
+				if (!first)
+					lw += p;
+				lw += w;
+				first = 0;
+			}
+
+			/* Save the line */
+			l = &run->lines[run->lineCount++];
+			l->start = start - str;
+			l->length = end - start;
+			l->width = lw;
+			switch(justify) {
+			case justifyCenter:	l->x = (cx - lw)/2;		break;
+			case justifyRight:	l->x = cx - lw;			break;
+			case justifyLeft:
+			default:			l->x = 0;				break;
+			}
+			if (lw > run->width)
+				run->width = lw;
+		}
+
+		/* Center the lines vertically */
+		run->y = run->lineCount ? (cy - h - (run->lineCount - 1) * ls) / 2 : 0;
+	}
+
+	/*
+	 * A text run is drawn in a single locked pass. The driver functions are
+	 * called directly while holding the mutex as the mutex is not recursive.
+	 */
+	#if GDISP_NEED_MULTITHREAD
+		#define _runLock()						chMtxLock(&gdispMutex)
+		#define _runUnlock()					chMtxUnlock()
+		#define _runDrawChar(x, y, c, f, color)	GDISP_LLD(drawchar)(x, y, c, f, color)
+		#define _runFillArea(x, y, cx, cy, c)	GDISP_LLD(fillarea)(x, y, cx, cy, c)
+		#define _runSetClip(x, y, cx, cy)		GDISP_LLD(setclip)(x, y, cx, cy)
+		#define _runUnsetClip()					GDISP_LLD(setclip)(0, 0, (coord_t)(unsigned)GDISP_LLD(query)(GDISP_QUERY_WIDTH), \
+																(coord_t)(unsigned)GDISP_LLD(query)(GDISP_QUERY_HEIGHT))
+	#else
+		#define _runLock()
+		#define _runUnlock()
+		#define _runDrawChar(x, y, c, f, color)	gdispDrawChar(x, y, c, f, color)
+		#define _runFillArea(x, y, cx, cy, c)	gdispFillArea(x, y, cx, cy, c)
+		#define _runSetClip(x, y, cx, cy)		gdispSetClip(x, y, cx, cy)
+		#define _runUnsetClip()					gdispUnsetClip()
+	#endif
+
+	/**
+	 * @brief   Draw the characters of a text run.
+	 * @note	Must be called with the lock held.
+	 *
+	 * @notapi
+	 */
+	static void _drawTextRun(coord_t x, coord_t y, const textrun_t *run, coord_t scroll, color_t color) {
+		const struct textline	*l;
+		const char				*s, *end;
+		coord_t					w, p, ls, xpos, x1;
+		fontchar_t				c;
+		font_t					font, f;
+		int						first;
+
+		font = run->font;
+		p = font->charPadding * font->xscale;
+		ls = font->lineSpacing * font->yscale;
+		x1 = x + run->cx;
+		y += run->y;
+
+		for(l = run->lines; l < &run->lines[run->lineCount]; l++, y += ls) {
+			s = run->str + l->start;
+			end = s + l->length;
+			xpos = x + l->x - scroll;
+			first = 1;
+			while(s < end && xpos < x1) {
+				/* Get the next printable character */
+				w = _getNextChar(&s, font, &c, &f);
+				if (!w) continue;
+
+				/* Handle inter-character padding */
+				if (!first)
+					xpos += p;
+				first = 0;
+
+				/* Draw it if any of it is within the box. Without clipping it must be all within the box */
+				#if GDISP_NEED_CLIP
+					if (xpos + w > x && xpos < x1)
+				#else
+					if (xpos >= x && xpos + w <= x1)
+				#endif
+						_runDrawChar(xpos, f == font ? y : y + _baseLineOffset(font, f), c, f, color);
+				xpos += w;
+			}
+		}
+	}
+
+	/**
+	 * @brief   Draw a text run.
+	 * @details	The run is drawn at the box position @p x,y in one pass holding
+	 *			the display lock. Nothing outside the box is drawn.
+	 * @note	With GDISP_NEED_CLIP the clip area is reset to the whole
+	 *			screen afterwards.
+	 *
+	 * @param[in] x,y		The position of the box
+	 * @param[in] run		The laid out text run
+	 * @param[in] scroll	How many pixels to scroll the text to the left
+	 * @param[in] color		The color to use
+	 *
+	 * @api
+	 */
+	void gdispDrawTextRun(coord_t x, coord_t y, const textrun_t *run, coord_t scroll, color_t color) {
+		_runLock();
+		#if GDISP_NEED_CLIP
+			_runSetClip(x, y, run->cx, run->cy);
+		#endif
+		_drawTextRun(x, y, run, scroll, color);
+		#if GDISP_NEED_CLIP
+			_runUnsetClip();
+		#endif
+		_runUnlock();
+	}
+
+	/**
+	 * @brief   Draw a text run. The box background is filled with the specified background color.
+	 * @note    The entire box is filled
+	 * @note	With GDISP_NEED_CLIP the clip area is reset to the whole
+	 *			screen afterwards.
+	 *
+	 * @param[in] x,y		The position of the box
+	 * @param[in] run		The laid out text run
+	 * @param[in] scroll	How many pixels to scroll the text to the left
+	 * @param[in] color		The color to use
+	 * @param[in] bgcolor	The background color to use
+	 *
+	 * @api
+	 */
+	void gdispFillTextRun(coord_t x, coord_t y, const textrun_t *run, coord_t scroll, color_t color, color_t bgcolor) {
+		_runLock();
+		#if GDISP_NEED_CLIP
+			_runSetClip(x, y, run->cx, run->cy);
+		#endif
+		_runFillArea(x, y, run->cx, run->cy, bgcolor);
+		_drawTextRun(x, y, run, scroll, color);
+		#if GDISP_NEED_CLIP
+			_runUnsetClip();
+		#endif
+		_runUnlock();
+	}
+#endif
+
 #if (!defined(gdispPackPixels) && !defined(GDISP_PIXELFORMAT_CUSTOM)) || defined(__DOXYGEN__)
 	/**
 	 * @brief   Pack a pixel into a pixel buffer.
@@ -42,15 +42,18 @@
 	const struct font fontSmall = { 11, 0, 14, 2, 2, 12, ' ', '~', 1, 1,
 	                                fontSmall_Widths,
 	                                fontSmall_Offsets,
-	                                fontSmall_Data};
+	                                fontSmall_Data,
+	                                NULL, NULL, 0, NULL};
 	const struct font fontSmallDouble = { 11, 0, 14, 2, 2, 12, ' ', '~', 2, 2,
 	                                fontSmall_Widths,
 	                                fontSmall_Offsets,
-	                                fontSmall_Data};
+	                                fontSmall_Data,
+	                                NULL, NULL, 0, NULL};
 	const struct font fontSmallNarrow = { 11, 0, 14, 2, 2, 12, ' ', '~', 1, 2,
 	                                fontSmall_Widths,
 	                                fontSmall_Offsets,
-	                                fontSmall_Data};
+	                                fontSmall_Data,
+	                                NULL, NULL, 0, NULL};
 
 	static const uint8_t fontSmall_Widths[] = {
 		2, 3, 6, 8, 7, 9, 7, 3, 4, 4, 5, 7, 4, 4, 3, 6,
@@ -183,15 +186,18 @@
 	const struct font fontLarger = { 12, 1, 13, 2, 2, 13, ' ', '~', 1, 1,
 	                                 fontLarger_Widths,
 	                                 fontLarger_Offsets,
-	                                 fontLarger_Data};
+	                                 fontLarger_Data,
+	                                 NULL, NULL, 0, NULL};
 	const struct font fontLargerDouble = { 12, 1, 13, 2, 2, 13, ' ', '~', 2, 2,
 									 fontLarger_Widths,
 	                                 fontLarger_Offsets,
-	                                 fontLarger_Data};
+	                                 fontLarger_Data,
+	                                 NULL, NULL, 0, NULL};
 	const struct font fontLargerNarrow = { 12, 1, 13, 2, 2, 13, ' ', '~', 1, 2,
 	                                 fontLarger_Widths,
 	                                 fontLarger_Offsets,
-	                                 fontLarger_Data};
+	                                 fontLarger_Data,
+	                                 NULL, NULL, 0, NULL};
 	static const uint8_t fontLarger_Widths[] = {
 		2, 3, 5, 8, 7, 13, 8, 2, 4, 4, 7, 8, 3, 4, 3, 5,
 		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 3, 3, 9, 8, 9, 6,
@@ -324,15 +330,18 @@
 	const struct font fontUI1 = { 13, 0, 15, 2, 3, 13, ' ', '~', 1, 1,
 	                              fontUI1_Widths,
 	                              fontUI1_Offsets,
-	                              fontUI1_Data};
+	                              fontUI1_Data,
+	                              NULL, NULL, 0, NULL};
 	const struct font fontUI1Double = { 13, 0, 15, 2, 3, 13, ' ', '~', 2, 2,
 	                              fontUI1_Widths,
 	                              fontUI1_Offsets,
-	                              fontUI1_Data};
+	                              fontUI1_Data,
+	                              NULL, NULL, 0, NULL};
 	const struct font fontUI1Narrow = { 13, 0, 15, 2, 3, 13, ' ', '~', 1, 2,
 	                              fontUI1_Widths,
 	                              fontUI1_Offsets,
-	                              fontUI1_Data};
+	                              fontUI1_Data,
+	                              NULL, NULL, 0, NULL};
 
 	static const uint8_t fontUI1_Widths[] = {
 		3, 3, 6, 8, 7, 13, 9, 3, 5, 5, 6, 8, 3, 5, 3, 7,
@@ -466,15 +475,18 @@
 	const struct font fontUI2 = { 11, 1, 13, 2, 2, 12, ' ', '~', 1, 1,
 	                              fontUI2_Widths,
 	                              fontUI2_Offsets,
-	                              fontUI2_Data};
+	                              fontUI2_Data,
+	                              NULL, NULL, 0, NULL};
 	const struct font fontUI2Double = { 11, 1, 13, 2, 2, 12, ' ', '~', 2, 2,
 	                              fontUI2_Widths,
 	                              fontUI2_Offsets,
-	                              fontUI2_Data};
+	                              fontUI2_Data,
+	                              NULL, NULL, 0, NULL};
 	const struct font fontUI2Narrow = { 11, 1, 13, 2, 2, 12, ' ', '~', 1, 2,
 	                              fontUI2_Widths,
 	                              fontUI2_Offsets,
-	                              fontUI2_Data};
+	                              fontUI2_Data,
+	                              NULL, NULL, 0, NULL};
 
 	static const uint8_t fontUI2_Widths[] = {
 		2, 2, 5, 8, 6, 12, 8, 2, 4, 4, 6, 8, 2, 4, 2, 5,
@@ -611,15 +623,18 @@
 	const struct font fontLargeNumbers = { 16, 2, 21, 1, 3, 15, '%', ':', 1, 1,
 	                                       fontLargeNumbers_Widths,
 	                                       fontLargeNumbers_Offsets,
-	                                       fontLargeNumbers_Data};
+	                                       fontLargeNumbers_Data,
+	                                       NULL, NULL, 0, NULL};
 	const struct font fontLargeNumbersDouble = { 16, 2, 21, 1, 3, 15, '%', ':', 2, 2,
 	                                       fontLargeNumbers_Widths,
 	                                       fontLargeNumbers_Offsets,
-	                                       fontLargeNumbers_Data};
+	                                       fontLargeNumbers_Data,
+	                                       NULL, NULL, 0, NULL};
 	const struct font fontLargeNumbersNarrow = { 16, 2, 21, 1, 3, 15, '%', ':', 1, 2,
 	                                       fontLargeNumbers_Widths,
 	                                       fontLargeNumbers_Offsets,
-	                                       fontLargeNumbers_Data};
+	                                       fontLargeNumbers_Data,
+	                                       NULL, NULL, 0, NULL};
 
 	static const uint8_t fontLargeNumbers_Widths[] = {
 		15, 0, 0, 0, 0, 0, 11, 3, 6, 3, 0, 10, 10, 10, 10, 10,
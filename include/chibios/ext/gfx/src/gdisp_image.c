@@ -0,0 +1,97 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    src/gdisp_image.c
+ * @brief   GDISP compressed image code.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+#include "ch.h"
+#include "hal.h"
+#include "gdisp.h"
+
+#if (GFX_USE_GDISP && GDISP_NEED_IMAGE) || defined(__DOXYGEN__)
+
+#include "gdisp/image.h"
+
+#if GDISP_NEED_ASYNC
+	#error "GDISP: GDISP_NEED_IMAGE can not be used with GDISP_NEED_ASYNC as rows are blitted from a stack buffer"
+#endif
+
+#if GDISP_PIXELFORMAT != GDISP_PIXELFORMAT_RGB565
+	#error "GDISP: GDISP_NEED_IMAGE currently requires GDISP_PIXELFORMAT_RGB565"
+#endif
+
+/**
+ * @brief   Draw part of a compressed image.
+ * @details	Decoding starts at the sync block containing @p srcy so only
+ *			the rows of the requested part (plus at most one block worth
+ *			of rows above it) are decoded. Each row is blitted in chunks of
+ *			up to @p GDISP_IMAGE_BLIT_PIXELS pixels.
+ *
+ * @param[in] x,y		The screen position to draw the part at
+ * @param[in] cx,cy		The size of the part
+ * @param[in] srcx,srcy	The position of the part within the image
+ * @param[in] img		The image to draw
+ *
+ * @api
+ */
+void gdispDrawImagePart(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, image_t img) {
+	/* No mutex required as we only call high level functions which have their own mutex */
+	imagedecoder_t	d;
+	pixel_t			buf[GDISP_IMAGE_BLIT_PIXELS];
+	coord_t			row, x1, n;
+
+	if (srcx < 0) { cx += srcx; x -= srcx; srcx = 0; }
+	if (srcy < 0) { cy += srcy; y -= srcy; srcy = 0; }
+	if (srcx + cx > (coord_t)img->width)	cx = img->width - srcx;
+	if (srcy + cy > (coord_t)img->height)	cy = img->height - srcy;
+	if (cx <= 0 || cy <= 0) return;
+
+	/* Skip down to the first wanted row */
+	for(row = _imageDecodeStart(&d, img, srcy); row < srcy; row++)
+		_imageDecode(&d, 0, img->width);
+
+	for(; cy; cy--, y++) {
+		/* Pixels left of the part */
+		if (srcx)
+			_imageDecode(&d, 0, srcx);
+
+		/* The wanted pixels */
+		for(x1 = 0; x1 < cx; x1 += n) {
+			n = cx - x1 > GDISP_IMAGE_BLIT_PIXELS ? GDISP_IMAGE_BLIT_PIXELS : cx - x1;
+			_imageDecode(&d, buf, n);
+			gdispBlitAreaEx(x + x1, y, n, 1, 0, 0, n, buf);
+		}
+
+		/* Pixels right of the part */
+		if (srcx + cx < (coord_t)img->width)
+			_imageDecode(&d, 0, img->width - srcx - cx);
+
+		/* Entering a new sync block resets the decoder */
+		if (++srcy % img->syncRows == 0 && cy > 1)
+			_imageDecodeStart(&d, img, srcy);
+	}
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_IMAGE */
+/** @} */
@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "ch.h"
 #include "hal.h"
@@ -70,6 +71,20 @@ void hal_lld_init(void) {
   timeradd(&nextcnt, &tick, &nextcnt);
 }
 
+/**
+ * @brief   Returns the host monotonic clock in nanoseconds.
+ * @note    Only the lower 32 bits are returned, the counter wraps every
+ *          4.3 seconds like the cycle counter of a fast MCU.
+ *
+ * @notapi
+ */
+halrtcnt_t hal_lld_get_counter(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (halrtcnt_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
 /**
  * @brief Interrupt simulation.
  */
@@ -105,4 +120,31 @@ void ChkIntSources(void) {
   }
 }
 
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief Tickless idle simulation.
+ * @details The ticks that elapsed before the next timer deadline are
+ *          accounted without simulating a timer interrupt for each of
+ *          them, the deadline tick itself is served by @p ChkIntSources().
+ */
+void ChkIntSourcesTickless(void) {
+  struct timeval tv;
+  systime_t ticks, passed = 0;
+
+  gettimeofday(&tv, NULL);
+
+  chSysLock();
+  ticks = chVTGetIdleTicksI();
+  while ((passed < ticks) && timercmp(&tv, &nextcnt, >=)) {
+    timeradd(&nextcnt, &tick, &nextcnt);
+    passed++;
+  }
+  if (passed > 0)
+    chVTSkipTicksI(passed);
+  chSysUnlock();
+
+  ChkIntSources();
+}
+#endif /* CH_USE_TICKLESS */
+
 /** @} */
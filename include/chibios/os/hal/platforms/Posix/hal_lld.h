@@ -40,7 +40,7 @@
 /**
  * @brief   Defines the support for realtime counters in the HAL.
  */
-#define HAL_IMPLEMENTS_COUNTERS FALSE
+#define HAL_IMPLEMENTS_COUNTERS TRUE
 
 /**
  * @brief   Platform name.
@@ -62,10 +62,42 @@
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Type representing a system clock frequency.
+ */
+typedef uint32_t halclock_t;
+
+/**
+ * @brief   Type of the realtime free counter value.
+ */
+typedef uint32_t halrtcnt_t;
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the current value of the system free running counter.
+ * @note    This service is implemented by reading the host monotonic clock
+ *          in nanoseconds.
+ *
+ * @return              The value of the system free running counter of
+ *                      type halrtcnt_t.
+ *
+ * @notapi
+ */
+#define hal_lld_get_counter_value()         hal_lld_get_counter()
+
+/**
+ * @brief   Realtime counter frequency.
+ * @note    The counter counts nanoseconds.
+ *
+ * @return              The realtime counter frequency of type halclock_t.
+ *
+ * @notapi
+ */
+#define hal_lld_get_counter_frequency()     1000000000UL
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -74,6 +106,7 @@
 extern "C" {
 #endif
   void hal_lld_init(void);
+  halrtcnt_t hal_lld_get_counter(void);
   void ChkIntSources(void);
 #ifdef __cplusplus
 }
@@ -96,9 +96,10 @@ static const USBEndpointConfig ep0config = {
  */
 static void usb_pm_reset(USBDriver *usbp) {
 
-  /* The first 64 bytes are reserved for the descriptors table. The effective
-     available RAM for endpoint buffers is just 448 bytes.*/
-  usbp->pmnext = 64;
+  /* The first bytes are reserved for the descriptors table, 8 for each
+     endpoint. With all the endpoints the effective available RAM for
+     endpoint buffers is just 448 bytes.*/
+  usbp->pmnext = STM32_USB_BTABLE_ENDPOINTS * 8;
 }
 
 /**
@@ -155,24 +156,34 @@ static void usb_packet_read_to_queue(stm32_usb_descriptor_t *udp,
   size_t nhw;
   uint32_t *pmap= USB_ADDR2PTR(udp->RXADDR0);
 
-  nhw = n / 2;
-  while (nhw > 0) {
-    uint32_t w;
-
-    w = *pmap++;
-    *iqp->q_wrptr++ = (uint8_t)w;
-    if (iqp->q_wrptr >= iqp->q_top)
-      iqp->q_wrptr = iqp->q_buffer;
-    *iqp->q_wrptr++ = (uint8_t)(w >> 8);
+  /* An even sized packet that does not wrap around is copied in one run,
+     without the wrap checks. An odd one would overwrite one more byte.*/
+  if (((n & 1) == 0) && ((size_t)(iqp->q_top - iqp->q_wrptr) >= n)) {
+    usb_packet_read_to_buffer(udp, iqp->q_wrptr, n);
+    iqp->q_wrptr += n;
     if (iqp->q_wrptr >= iqp->q_top)
       iqp->q_wrptr = iqp->q_buffer;
-    nhw--;
   }
-  /* Last byte for odd numbers.*/
-  if ((n & 1) != 0) {
-    *iqp->q_wrptr++ = (uint8_t)*pmap;
-    if (iqp->q_wrptr >= iqp->q_top)
-      iqp->q_wrptr = iqp->q_buffer;
+  else {
+    nhw = n / 2;
+    while (nhw > 0) {
+      uint32_t w;
+
+      w = *pmap++;
+      *iqp->q_wrptr++ = (uint8_t)w;
+      if (iqp->q_wrptr >= iqp->q_top)
+        iqp->q_wrptr = iqp->q_buffer;
+      *iqp->q_wrptr++ = (uint8_t)(w >> 8);
+      if (iqp->q_wrptr >= iqp->q_top)
+        iqp->q_wrptr = iqp->q_buffer;
+      nhw--;
+    }
+    /* Last byte for odd numbers.*/
+    if ((n & 1) != 0) {
+      *iqp->q_wrptr++ = (uint8_t)*pmap;
+      if (iqp->q_wrptr >= iqp->q_top)
+        iqp->q_wrptr = iqp->q_buffer;
+    }
   }
 
   /* Updating queue.*/
@@ -224,26 +235,37 @@ static void usb_packet_write_from_queue(stm32_usb_descriptor_t *udp,
   size_t nhw;
   uint32_t *pmap = USB_ADDR2PTR(udp->TXADDR0);
 
-  udp->TXCOUNT0 = (uint16_t)n;
-  nhw = n / 2;
-  while (nhw > 0) {
-    uint32_t w;
-
-    w  = (uint32_t)*oqp->q_rdptr++;
-    if (oqp->q_rdptr >= oqp->q_top)
-      oqp->q_rdptr = oqp->q_buffer;
-    w |= (uint32_t)*oqp->q_rdptr++ << 8;
+  /* A packet that does not wrap around is copied in one run, without the
+     wrap checks. An odd one reads one more byte, it must be in the buffer
+     too.*/
+  if ((size_t)(oqp->q_top - oqp->q_rdptr) >= ((n + 1) & ~(size_t)1)) {
+    usb_packet_write_from_buffer(udp, oqp->q_rdptr, n);
+    oqp->q_rdptr += n;
     if (oqp->q_rdptr >= oqp->q_top)
       oqp->q_rdptr = oqp->q_buffer;
-    *pmap++ = w;
-    nhw--;
   }
+  else {
+    udp->TXCOUNT0 = (uint16_t)n;
+    nhw = n / 2;
+    while (nhw > 0) {
+      uint32_t w;
+
+      w  = (uint32_t)*oqp->q_rdptr++;
+      if (oqp->q_rdptr >= oqp->q_top)
+        oqp->q_rdptr = oqp->q_buffer;
+      w |= (uint32_t)*oqp->q_rdptr++ << 8;
+      if (oqp->q_rdptr >= oqp->q_top)
+        oqp->q_rdptr = oqp->q_buffer;
+      *pmap++ = w;
+      nhw--;
+    }
 
-  /* Last byte for odd numbers.*/
-  if ((n & 1) != 0) {
-    *pmap = (uint32_t)*oqp->q_rdptr++;
-    if (oqp->q_rdptr >= oqp->q_top)
-      oqp->q_rdptr = oqp->q_buffer;
+    /* Last byte for odd numbers.*/
+    if ((n & 1) != 0) {
+      *pmap = (uint32_t)*oqp->q_rdptr++;
+      if (oqp->q_rdptr >= oqp->q_top)
+        oqp->q_rdptr = oqp->q_buffer;
+    }
   }
 
   /* Updating queue. Note, the lock is done in this unusual way because this
@@ -260,6 +282,81 @@ static void usb_packet_write_from_queue(stm32_usb_descriptor_t *udp,
   port_unlock();
 }
 
+/**
+ * @brief   Hands the application buffer of a double buffered OUT endpoint
+ *          to the USB.
+ * @details SW_BUF is toggled and the endpoint made valid in a single write.
+ *          The CTR bits are written as one so an event arriving meanwhile
+ *          is not lost.
+ *
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+static void usb_dbl_release(usbep_t ep) {
+  uint32_t epr = STM32_USB->EPR[ep];
+
+  STM32_USB->EPR[ep] = (epr & ~EPR_TOGGLE_MASK) | EPR_CTR_RX | EPR_CTR_TX |
+                       EPR_SWBUF_RX | ((epr & EPR_STAT_RX_MASK) ^
+                                       EPR_STAT_RX_VALID);
+}
+
+/**
+ * @brief   Handles a packet received on a double buffered OUT endpoint.
+ * @details When more packets are expected the other buffer is handed to
+ *          the USB before this one is read, so the host does not wait for
+ *          the copy. A short packet ends the transfer.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[in] epr       the EPR value after the reception
+ *
+ * @notapi
+ */
+static void usb_dbl_received(USBDriver *usbp, usbep_t ep, uint32_t epr) {
+  USBOutEndpointState *osp = usbp->epc[ep]->out_state;
+  stm32_usb_descriptor_t *udp = USB_GET_DESCRIPTOR(ep);
+  uint8_t *buf = osp->mode.linear.rxbuf;
+  uint32_t *pmap;
+  size_t n, nhw;
+
+  /* DTOG has moved on already, the packet is in the other buffer.*/
+  if (epr & EPR_DTOG_RX) {
+    pmap = USB_ADDR2PTR(udp->TXADDR0);
+    n = (size_t)udp->TXCOUNT0 & RXCOUNT_COUNT_MASK;
+  }
+  else {
+    pmap = USB_ADDR2PTR(udp->RXADDR0);
+    n = (size_t)udp->RXCOUNT0 & RXCOUNT_COUNT_MASK;
+  }
+  if (n > osp->rxsize)
+    n = osp->rxsize;
+
+  if ((osp->rxpkts > 1) && (n == usbp->epc[ep]->out_maxsize))
+    usb_dbl_release(ep);
+  else
+    osp->rxpkts = 1;
+
+  nhw = (n + 1) / 2;
+  while (nhw > 0) {
+    /* Note, this line relies on the Cortex-M3/M4 ability to perform
+       unaligned word accesses.*/
+    *(uint16_t *)buf = (uint16_t)*pmap++;
+    buf += 2;
+    nhw--;
+  }
+
+  /* Transaction data updated.*/
+  osp->mode.linear.rxbuf += n;
+  osp->rxcnt             += n;
+  osp->rxsize            -= n;
+  osp->rxpkts            -= 1;
+  if (osp->rxpkts == 0) {
+    /* Transfer completed, invokes the callback.*/
+    _usb_isr_invoke_out_cb(usbp, ep);
+  }
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -385,6 +482,10 @@ CH_IRQ_HANDLER(STM32_USB1_LP_HANDLER) {
            specific callback.*/
         _usb_isr_invoke_setup_cb(usbp, ep);
       }
+      else if (epcp->ep_buffers > 1) {
+        /* Double buffered OUT endpoint.*/
+        usb_dbl_received(usbp, ep, epr);
+      }
       else {
         stm32_usb_descriptor_t *udp = USB_GET_DESCRIPTOR(ep);
         n = (size_t)udp->RXCOUNT0 & RXCOUNT_COUNT_MASK;
@@ -546,6 +647,9 @@ void usb_lld_init_endpoint(USBDriver *usbp, usbep_t ep) {
   stm32_usb_descriptor_t *dp;
   const USBEndpointConfig *epcp = usbp->epc[ep];
 
+  chDbgAssert(ep < STM32_USB_BTABLE_ENDPOINTS,
+              "usb_lld_init_endpoint(), #2", "not in the descriptors table");
+
   /* Setting the endpoint type.*/
   switch (epcp->ep_mode & USB_EP_MODE_TYPE) {
   case USB_EP_MODE_TYPE_ISOC:
@@ -561,13 +665,22 @@ void usb_lld_init_endpoint(USBDriver *usbp, usbep_t ep) {
     epr = EPR_EP_TYPE_CONTROL;
   }
 
-  /* IN endpoint initially in NAK mode.*/
-  if (epcp->in_cb != NULL)
-    epr |= EPR_STAT_TX_NAK;
-
-  /* OUT endpoint initially in NAK mode.*/
-  if (epcp->out_cb != NULL)
-    epr |= EPR_STAT_RX_NAK;
+  if (epcp->ep_buffers > 1) {
+    /* Double buffered OUT endpoint, valid from the start but blocked as
+       long as SW_BUF equals DTOG, both are cleared here.*/
+    chDbgAssert((epcp->in_cb == NULL) && (epcp->out_cb != NULL),
+                "usb_lld_init_endpoint(), #1", "OUT only");
+    epr |= EPR_EP_DBL_BUF | EPR_STAT_RX_VALID;
+  }
+  else {
+    /* IN endpoint initially in NAK mode.*/
+    if (epcp->in_cb != NULL)
+      epr |= EPR_STAT_TX_NAK;
+
+    /* OUT endpoint initially in NAK mode.*/
+    if (epcp->out_cb != NULL)
+      epr |= EPR_STAT_RX_NAK;
+  }
 
   /* EPxR register setup.*/
   EPR_SET(ep, epr | ep);
@@ -580,6 +693,14 @@ void usb_lld_init_endpoint(USBDriver *usbp, usbep_t ep) {
   else
     nblocks = ((((epcp->out_maxsize - 1) | 1) + 1) / 2) << 10;
   dp = USB_GET_DESCRIPTOR(ep);
+  if (epcp->ep_buffers > 1) {
+    /* Buffer 0 is described by the TX fields, buffer 1 by the RX fields.*/
+    dp->TXCOUNT0 = nblocks;
+    dp->RXCOUNT0 = nblocks;
+    dp->TXADDR0  = usb_pm_alloc(usbp, epcp->out_maxsize);
+    dp->RXADDR0  = usb_pm_alloc(usbp, epcp->out_maxsize);
+    return;
+  }
   dp->TXCOUNT0 = 0;
   dp->RXCOUNT0 = nblocks;
   dp->TXADDR0  = usb_pm_alloc(usbp, epcp->in_maxsize);
@@ -695,6 +816,9 @@ void usb_lld_read_setup(USBDriver *usbp, usbep_t ep, uint8_t *buf) {
 void usb_lld_prepare_receive(USBDriver *usbp, usbep_t ep) {
   USBOutEndpointState *osp = usbp->epc[ep]->out_state;
 
+  chDbgAssert((usbp->epc[ep]->ep_buffers == 1) || !osp->rxqueued,
+              "usb_lld_prepare_receive(), #1", "double buffered, not linear");
+
   /* Transfer initialization.*/
   if (osp->rxsize == 0)         /* Special case for zero sized packets.*/
     osp->rxpkts = 1;
@@ -738,11 +862,57 @@ void usb_lld_prepare_transmit(USBDriver *usbp, usbep_t ep) {
  */
 void usb_lld_start_out(USBDriver *usbp, usbep_t ep) {
 
-  (void)usbp;
+  if (usbp->epc[ep]->ep_buffers > 1) {
+    uint32_t epr = STM32_USB->EPR[ep];
+
+    /* Blocked between transfers, the application buffer is handed over.*/
+    if (((epr & EPR_DTOG_RX) == 0) == ((epr & EPR_SWBUF_RX) == 0))
+      usb_dbl_release(ep);
+    return;
+  }
 
   EPR_SET_STAT_RX(ep, EPR_STAT_RX_VALID);
 }
 
+/**
+ * @brief   Stops a receive operation on an OUT endpoint.
+ * @details The endpoint NAKs the host and the transfer takes no further
+ *          packets. A packet accepted before may still be in transit, so
+ *          on an armed endpoint the first call only returns busy and has
+ *          to be repeated after a packet time. A packet that arrived
+ *          meanwhile ends the transfer through the endpoint callback.
+ * @note    This function is specific to this driver.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @return              The operation status.
+ * @retval FALSE        Endpoint idle, ready for another transfer.
+ * @retval TRUE         Endpoint busy, call again later.
+ *
+ * @iclass
+ */
+bool_t usb_lld_stop_out(USBDriver *usbp, usbep_t ep) {
+
+  chDbgCheckClassI();
+
+  if (!usbGetReceiveStatusI(usbp, ep))
+    return FALSE;
+
+  /* A packet still arriving completes the transfer instead of making the
+     endpoint valid again.*/
+  usbp->epc[ep]->out_state->rxpkts = 1;
+
+  if ((STM32_USB->EPR[ep] & EPR_STAT_RX_MASK) == EPR_STAT_RX_VALID) {
+    EPR_SET_STAT_RX(ep, EPR_STAT_RX_NAK);
+    return TRUE;
+  }
+  if (STM32_USB->EPR[ep] & EPR_CTR_RX)
+    return TRUE;
+
+  usbp->receiving &= ~(1 << ep);
+  return FALSE;
+}
+
 /**
  * @brief   Starts a transmit operation on an IN endpoint.
  *
@@ -753,8 +923,6 @@ void usb_lld_start_out(USBDriver *usbp, usbep_t ep) {
  */
 void usb_lld_start_in(USBDriver *usbp, usbep_t ep) {
 
-  (void)usbp;
-
   EPR_SET_STAT_TX(ep, EPR_STAT_TX_VALID);
 }
 
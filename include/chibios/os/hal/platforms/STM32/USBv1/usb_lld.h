@@ -81,6 +81,16 @@
 #define STM32_USB_USB1_LP_IRQ_PRIORITY      14
 #endif
 
+/**
+ * @brief   Endpoints described by the packet memory descriptors table.
+ * @details The table takes 8 bytes of packet memory for each endpoint, the
+ *          entries above the last endpoint in use can be given to the
+ *          packet buffers instead.
+ */
+#if !defined(STM32_USB_BTABLE_ENDPOINTS) || defined(__DOXYGEN__)
+#define STM32_USB_BTABLE_ENDPOINTS          (USB_MAX_ENDPOINTS + 1)
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -103,6 +113,11 @@
 #error "Invalid IRQ priority assigned to USB LP"
 #endif
 
+#if (STM32_USB_BTABLE_ENDPOINTS < 1) ||                                  \
+    (STM32_USB_BTABLE_ENDPOINTS > USB_MAX_ENDPOINTS + 1)
+#error "Invalid number of descriptors table endpoints"
+#endif
+
 #if STM32_USBCLK != 48000000
 #error "the USB driver requires a 48MHz clock"
 #endif
@@ -237,8 +252,12 @@ typedef struct {
   USBOutEndpointState           *out_state;
   /* End of the mandatory fields.*/
   /**
-   * @brief   Reserved field, not currently used.
-   * @note    Initialize this field to 1 in order to be forward compatible.
+   * @brief   Number of packet buffers, 1 or 2.
+   * @details With 2 the endpoint is double buffered, the USB receives a
+   *          packet in one buffer while the other one is copied. Such an
+   *          endpoint is a bulk OUT endpoint with linear transfers, a
+   *          transfer also ends with a short packet.
+   * @note    Both buffers are allocated in the packet memory.
    */
   uint16_t                      ep_buffers;
   /**
@@ -416,6 +435,7 @@ extern "C" {
   void usb_lld_prepare_receive(USBDriver *usbp, usbep_t ep);
   void usb_lld_prepare_transmit(USBDriver *usbp, usbep_t ep);
   void usb_lld_start_out(USBDriver *usbp, usbep_t ep);
+  bool_t usb_lld_stop_out(USBDriver *usbp, usbep_t ep);
   void usb_lld_start_in(USBDriver *usbp, usbep_t ep);
   void usb_lld_stall_out(USBDriver *usbp, usbep_t ep);
   void usb_lld_stall_in(USBDriver *usbp, usbep_t ep);
@@ -29,6 +29,18 @@
 #ifndef _CHVT_H_
 #define _CHVT_H_
 
+/**
+ * @brief   Tickless idle.
+ * @details When enabled the idle thread lets the port skip all the system
+ *          ticks before the next virtual timer deadline instead of taking
+ *          a timer interrupt for each of them. The skipped ticks are
+ *          accounted at once when the idle thread wakes up.
+ * @note    Requires a port implementing @p port_tickless_idle().
+ */
+#if !defined(CH_USE_TICKLESS) || defined(__DOXYGEN__)
+#define CH_USE_TICKLESS                 FALSE
+#endif
+
 /**
  * @name    Time conversion utilities
  * @{
@@ -112,6 +124,10 @@ typedef struct {
                                                 list.                       */
   systime_t             vt_time;    /**< @brief Must be initialized to -1.  */
   volatile systime_t    vt_systime; /**< @brief System Time counter.        */
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+  systime_t             vt_skipped; /**< @brief Ticks accounted without a
+                                                timer interrupt.            */
+#endif
 } VTList;
 
 /**
@@ -218,6 +234,10 @@ extern "C" {
   void chVTSetI(VirtualTimer *vtp, systime_t time, vtfunc_t vtfunc, void *par);
   void chVTResetI(VirtualTimer *vtp);
   bool_t chTimeIsWithin(systime_t start, systime_t end);
+#if CH_USE_TICKLESS
+  systime_t chVTGetIdleTicksI(void);
+  void chVTSkipTicksI(systime_t ticks);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -41,6 +41,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "ch.h"
 
 #if CH_USE_QUEUES || defined(__DOXYGEN__)
@@ -69,6 +71,54 @@ static msg_t qwait(GenericQueue *qp, systime_t time) {
   return chSchGoSleepTimeoutS(THD_STATE_WTQUEUE, time);
 }
 
+/**
+ * @brief   Copies data out of a queue buffer.
+ * @details The data is copied in at most two chunks, the second one after
+ *          the buffer wraps around. The queue counter is not updated.
+ *
+ * @param[in] qp        pointer to a @p GenericQueue structure
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the amount of data to be copied, it must not exceed
+ *                      the data in the queue
+ */
+static void qread(GenericQueue *qp, uint8_t *bp, size_t n) {
+  size_t s1 = (size_t)(qp->q_top - qp->q_rdptr);
+
+  if (n < s1) {
+    memcpy(bp, qp->q_rdptr, n);
+    qp->q_rdptr += n;
+  }
+  else {
+    memcpy(bp, qp->q_rdptr, s1);
+    memcpy(bp + s1, qp->q_buffer, n - s1);
+    qp->q_rdptr = qp->q_buffer + (n - s1);
+  }
+}
+
+/**
+ * @brief   Copies data into a queue buffer.
+ * @details The data is copied in at most two chunks, the second one after
+ *          the buffer wraps around. The queue counter is not updated.
+ *
+ * @param[in] qp        pointer to a @p GenericQueue structure
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the amount of data to be copied, it must not exceed
+ *                      the free space in the queue
+ */
+static void qwrite(GenericQueue *qp, const uint8_t *bp, size_t n) {
+  size_t s1 = (size_t)(qp->q_top - qp->q_wrptr);
+
+  if (n < s1) {
+    memcpy(qp->q_wrptr, bp, n);
+    qp->q_wrptr += n;
+  }
+  else {
+    memcpy(qp->q_wrptr, bp, s1);
+    memcpy(qp->q_buffer, bp + s1, n - s1);
+    qp->q_wrptr = qp->q_buffer + (n - s1);
+  }
+}
+
 /**
  * @brief   Initializes an input queue.
  * @details A Semaphore is internally initialized and works as a counter of
@@ -200,8 +250,10 @@ msg_t chIQGetTimeout(InputQueue *iqp, systime_t time) {
  *          been reset.
  * @note    The function is not atomic, if you need atomicity it is suggested
  *          to use a semaphore or a mutex for mutual exclusion.
- * @note    The callback is invoked before reading each character from the
- *          buffer or before entering the state @p THD_STATE_WTQUEUE.
+ * @note    The data available in the queue is copied in one go, in at most
+ *          two chunks, then the system lock is released briefly.
+ * @note    The callback is invoked before reading each block of data from
+ *          the buffer or before entering the state @p THD_STATE_WTQUEUE.
  *
  * @param[in] iqp       pointer to an @p InputQueue structure
  * @param[out] bp       pointer to the data buffer
@@ -225,6 +277,8 @@ size_t chIQReadTimeout(InputQueue *iqp, uint8_t *bp,
 
   chSysLock();
   while (TRUE) {
+    size_t done;
+
     if (nfy)
       nfy(iqp);
 
@@ -235,14 +289,17 @@ size_t chIQReadTimeout(InputQueue *iqp, uint8_t *bp,
       }
     }
 
-    iqp->q_counter--;
-    *bp++ = *iqp->q_rdptr++;
-    if (iqp->q_rdptr >= iqp->q_top)
-      iqp->q_rdptr = iqp->q_buffer;
+    done = chIQGetFullI(iqp);
+    if (done > n)
+      done = n;
+    qread((GenericQueue *)iqp, bp, done);
+    iqp->q_counter -= done;
 
     chSysUnlock(); /* Gives a preemption chance in a controlled point.*/
-    r++;
-    if (--n == 0)
+    bp += done;
+    r += done;
+    n -= done;
+    if (n == 0)
       return r;
 
     chSysLock();
@@ -380,8 +437,10 @@ msg_t chOQGetI(OutputQueue *oqp) {
  *          been reset.
  * @note    The function is not atomic, if you need atomicity it is suggested
  *          to use a semaphore or a mutex for mutual exclusion.
- * @note    The callback is invoked after writing each character into the
- *          buffer.
+ * @note    As much data as the queue has space for is copied in one go, in
+ *          at most two chunks, then the system lock is released briefly.
+ * @note    The callback is invoked after writing each block of data into
+ *          the buffer.
  *
  * @param[in] oqp       pointer to an @p OutputQueue structure
  * @param[out] bp       pointer to the data buffer
@@ -405,23 +464,29 @@ size_t chOQWriteTimeout(OutputQueue *oqp, const uint8_t *bp,
 
   chSysLock();
   while (TRUE) {
+    size_t done;
+
     while (chOQIsFullI(oqp)) {
       if (qwait((GenericQueue *)oqp, time) != Q_OK) {
         chSysUnlock();
         return w;
       }
     }
-    oqp->q_counter--;
-    *oqp->q_wrptr++ = *bp++;
-    if (oqp->q_wrptr >= oqp->q_top)
-      oqp->q_wrptr = oqp->q_buffer;
+
+    done = chOQGetEmptyI(oqp);
+    if (done > n)
+      done = n;
+    qwrite((GenericQueue *)oqp, bp, done);
+    oqp->q_counter -= done;
 
     if (nfy)
       nfy(oqp);
 
     chSysUnlock(); /* Gives a preemption chance in a controlled point.*/
-    w++;
-    if (--n == 0)
+    bp += done;
+    w += done;
+    n -= done;
+    if (n == 0)
       return w;
     chSysLock();
   }
@@ -56,7 +56,11 @@ void _idle_thread(void *p) {
   (void)p;
   chRegSetThreadName("idle");
   while (TRUE) {
+#if CH_USE_TICKLESS
+    port_tickless_idle();
+#else
     port_wait_for_interrupt();
+#endif
     IDLE_LOOP_HOOK();
   }
 }
@@ -45,6 +45,9 @@ void _vt_init(void) {
   vtlist.vt_next = vtlist.vt_prev = (void *)&vtlist;
   vtlist.vt_time = (systime_t)-1;
   vtlist.vt_systime = 0;
+#if CH_USE_TICKLESS
+  vtlist.vt_skipped = 0;
+#endif
 }
 
 /**
@@ -131,4 +134,55 @@ bool_t chTimeIsWithin(systime_t start, systime_t end) {
                        (time >= start) || (time < end);
 }
 
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Number of system ticks that can be skipped.
+ * @details Returns the number of ticks before the tick on which the first
+ *          virtual timer expires. That tick must be served by a real timer
+ *          interrupt, all the ones before it can be accounted later using
+ *          @p chVTSkipTicksI().
+ *
+ * @return              The number of ticks that can be skipped, zero if the
+ *                      next tick is due, @p TIME_INFINITE if no timer is
+ *                      armed.
+ *
+ * @iclass
+ */
+systime_t chVTGetIdleTicksI(void) {
+
+  chDbgCheckClassI();
+
+  if (&vtlist == (VTList *)vtlist.vt_next)
+    return TIME_INFINITE;
+  return vtlist.vt_next->vt_time - 1;
+}
+
+/**
+ * @brief   Accounts system ticks that elapsed without a timer interrupt.
+ * @details The system time is advanced and the first virtual timer is moved
+ *          closer to its deadline by the specified number of ticks.
+ * @note    No timer can expire here, the number of ticks must not exceed the
+ *          value returned by @p chVTGetIdleTicksI().
+ *
+ * @param[in] ticks     the number of skipped ticks
+ *
+ * @iclass
+ */
+void chVTSkipTicksI(systime_t ticks) {
+
+  chDbgCheckClassI();
+  chDbgAssert(ticks <= chVTGetIdleTicksI(),
+              "chVTSkipTicksI(), #1",
+              "skipping over a timer deadline");
+
+  vtlist.vt_systime += ticks;
+  vtlist.vt_skipped += ticks;
+  if (&vtlist != (VTList *)vtlist.vt_next)
+    vtlist.vt_next->vt_time -= ticks;
+#if CH_DBG_THREADS_PROFILING
+  currp->p_time += ticks;
+#endif
+}
+#endif /* CH_USE_TICKLESS */
+
 /** @} */
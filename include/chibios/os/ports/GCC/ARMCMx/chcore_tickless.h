@@ -0,0 +1,93 @@
+/*
+    ChibiOS/RT - Copyright (C) 2006,2007,2008,2009,2010,
+                 2011,2012 Giovanni Di Sirio.
+
+    This file is part of ChibiOS/RT.
+
+    ChibiOS/RT is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/RT is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    GCC/ARMCMx/chcore_tickless.h
+ * @brief   ARMv7-M tickless idle arithmetic.
+ * @details The SysTick arithmetic of @p _port_tickless_idle(), free of
+ *          register accesses so that tools/ticksim can test it on a host.
+ *          All the quantities are core clock cycles.
+ *
+ * @addtogroup ARMCMx_V7M_CORE
+ * @{
+ */
+
+#ifndef _CHCORE_TICKLESS_H_
+#define _CHCORE_TICKLESS_H_
+
+/**
+ * @brief   Cycles counted by SysTick since it was started from zero.
+ * @details The counter loads @p reload - 1 on the first cycle and reaches
+ *          zero after @p reload cycles, setting its count flag. A sleep
+ *          ends before a second reload can pass.
+ *
+ * @param[in] reload    cycles of one turn of the counter
+ * @param[in] cvr       the stopped counter value
+ * @param[in] wrapped   the count flag was set
+ * @return              The cycles counted.
+ */
+static inline uint32_t port_tickless_slept(uint32_t reload, uint32_t cvr,
+                                           uint32_t wrapped) {
+
+  uint32_t counted = cvr == 0 ? 0 : reload - cvr;
+
+  return wrapped ? reload + counted : counted;
+}
+
+/**
+ * @brief   Tick boundaries crossed after a number of cycles.
+ *
+ * @param[in] period    cycles of a tick
+ * @param[in] first     cycles that were left of the current tick,
+ *                      1 to @p period
+ * @param[in] elapsed   cycles that passed since
+ * @param[out] left     cycles left of the tick now current, 1 to @p period
+ * @return              The tick boundaries crossed.
+ */
+static inline uint32_t port_tickless_passed(uint32_t period, uint32_t first,
+                                            uint32_t elapsed,
+                                            uint32_t *left) {
+  uint32_t passed;
+
+  if (elapsed < first) {
+    *left = first - elapsed;
+    return 0;
+  }
+  passed = 1 + (elapsed - first) / period;
+  *left = first + passed * period - elapsed;
+  return passed;
+}
+
+/**
+ * @brief   SysTick reload value that ends a tick after @p left cycles.
+ * @note    A reload value of zero disables the counter, a single cycle left
+ *          is stretched to two.
+ *
+ * @param[in] left      cycles left of the current tick
+ * @return              The reload value.
+ */
+static inline uint32_t port_tickless_reload(uint32_t left) {
+
+  return left > 1 ? left - 1 : 1;
+}
+
+#endif /* _CHCORE_TICKLESS_H_ */
+
+/** @} */
@@ -335,6 +335,10 @@ struct context {
 #define port_wait_for_interrupt()
 #endif
 
+#if CH_USE_TICKLESS
+#error "CH_USE_TICKLESS is not supported by the ARMv6-M port"
+#endif
+
 /**
  * @brief   Performs a context switch between two threads.
  * @details This is the most critical code in any port, this function
@@ -28,6 +28,10 @@
 
 #include "ch.h"
 
+#if CH_USE_TICKLESS
+#include "chcore_tickless.h"
+#endif
+
 /*===========================================================================*/
 /* Port interrupt handlers.                                                  */
 /*===========================================================================*/
@@ -257,4 +261,99 @@ void _port_thread_start(void) {
                 "bl      chThdExit");
 }
 
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+/**
+ * @brief   Tickless idle.
+ * @details The SysTick counter is reloaded once with the length of all the
+ *          ticks that can be skipped, the core sleeps with @p WFI until the
+ *          last one ends or another interrupt arrives. The ticks that passed
+ *          are then accounted with @p chVTSkipTicksI() and the counter is
+ *          put back in phase with the normal tick period.
+ * @note    Interrupts are masked through PRIMASK while sleeping, they still
+ *          wake the core but are served only after the system time has been
+ *          corrected.
+ * @note    The SysTick counter is 24 bits wide, with the core clock as its
+ *          source a single sleep is limited to 0xFFFFFF cycles (233ms at
+ *          72MHz).
+ * @note    The counter stands still while it is reprogrammed, the DWT cycle
+ *          counter enabled by the HAL measures those cycles and they are
+ *          taken off the next tick. It does not count while the core sleeps,
+ *          the sleep itself is measured by SysTick. Only the few instructions
+ *          between the last cycle counter read and restarting SysTick are
+ *          lost, see tools/ticksim for a host test of the arithmetic.
+ */
+void _port_tickless_idle(void) {
+  uint32_t period, first, reload, elapsed, passed, left, ctrl, csr, stamp, now;
+  systime_t ticks;
+
+  port_disable();
+
+  chSysLock();
+  ticks = chVTGetIdleTicksI();
+  chSysUnlock();
+
+  /* Nothing to skip, plain sleep with the counter running.*/
+  if (ticks == 0) {
+    asm volatile ("wfi" : : : "memory");
+    port_enable();
+    return;
+  }
+
+  /* Stopping the counter, the current tick ends when it reaches zero. At
+     zero the tick already ended and its interrupt is pending.*/
+  period = ST_RVR + 1;
+  ctrl = ST_CSR & ~(CSR_ENABLE_MASK | CSR_COUNTFLAG_MASK);
+  stamp = DWT_CYCCNT;
+  ST_CSR = ctrl;
+  first = ST_CVR;
+  if (first == 0)
+    first = period;
+  elapsed = 0;
+  csr = 0;
+
+  /* Sleeping unless a tick became due meanwhile, it is served first.*/
+  if (!(SCB_ICSR & ICSR_PENDSTSET)) {
+    if (ticks > (RVR_RELOAD_MASK - first) / period)
+      ticks = (RVR_RELOAD_MASK - first) / period;
+    reload = first + ticks * period;
+
+    ST_RVR = reload - 1;
+    ST_CVR = 0;
+    elapsed = DWT_CYCCNT - stamp;
+    ST_CSR = ctrl | CSR_ENABLE_MASK;
+
+    asm volatile ("wfi" : : : "memory");
+
+    /* Stopped without reading the control register, reading it clears the
+       count flag.*/
+    ST_CSR = ctrl;
+    stamp = DWT_CYCCNT;
+    csr = ST_CSR;
+    elapsed += port_tickless_slept(reload, ST_CVR, csr & CSR_COUNTFLAG_MASK);
+  }
+
+  /* Ticks that ended meanwhile and what is left of the current one, the
+     second call takes the cycles of the first off too.*/
+  now = DWT_CYCCNT;
+  passed = port_tickless_passed(period, first, elapsed + (now - stamp), &left);
+  passed += port_tickless_passed(period, left, DWT_CYCCNT - now, &left);
+
+  /* Next tick after the remainder of the current period.*/
+  ST_RVR = port_tickless_reload(left);
+  ST_CVR = 0;
+  ST_CSR = ctrl | CSR_ENABLE_MASK;
+  ST_RVR = period - 1;
+
+  /* After a full sleep the pending SysTick serves the last tick.*/
+  if (csr & CSR_COUNTFLAG_MASK)
+    passed--;
+
+  chSysLock();
+  chVTSkipTicksI(passed);
+  chSysUnlock();
+
+  port_enable();
+}
+#endif /* CH_USE_TICKLESS */
+
 /** @} */
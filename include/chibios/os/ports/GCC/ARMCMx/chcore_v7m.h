@@ -479,6 +479,15 @@ struct context {
 #define port_wait_for_interrupt()
 #endif
 
+/**
+ * @brief   Tickless idle.
+ * @details Sleeps with the SysTick period stretched up to the next virtual
+ *          timer deadline, see @p CH_USE_TICKLESS.
+ */
+#if CH_USE_TICKLESS || defined(__DOXYGEN__)
+#define port_tickless_idle() _port_tickless_idle()
+#endif
+
 /**
  * @brief   Performs a context switch between two threads.
  * @details This is the most critical code in any port, this function
@@ -510,6 +519,9 @@ extern "C" {
   void _port_exit_from_isr(void);
   void _port_switch(Thread *ntp, Thread *otp);
   void _port_thread_start(void);
+#if CH_USE_TICKLESS
+  void _port_tickless_idle(void);
+#endif
 #if !CH_OPTIMIZE_SPEED
   void _port_lock(void);
   void _port_unlock(void);
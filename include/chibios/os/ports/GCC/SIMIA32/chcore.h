@@ -226,6 +226,12 @@ struct context {
  */
 #define port_wait_for_interrupt() ChkIntSources()
 
+/**
+ * In the simulator the ticks without a due timer are accounted at once
+ * instead of being simulated as timer interrupts.
+ */
+#define port_tickless_idle() ChkIntSourcesTickless()
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -234,6 +240,7 @@ extern "C" {
   __attribute__((cdecl, noreturn)) void _port_thread_start(msg_t (*pf)(void *),
                                                            void *p);
   void ChkIntSources(void);
+  void ChkIntSourcesTickless(void);
 #ifdef __cplusplus
 }
 #endif
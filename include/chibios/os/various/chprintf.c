@@ -30,13 +30,109 @@
  */
 
 #include <stdarg.h>
+#include <limits.h>
 
 #include "ch.h"
 #include "chprintf.h"
+#include "memstreams.h"
 
 #define MAX_FILLER 11
 #define FLOAT_PRECISION 100000
 
+/**
+ * @brief   Output state of a formatting call.
+ */
+typedef struct {
+  BaseSequentialStream  *chp;
+#if CHPRINTF_BUFFER_SIZE > 0
+  uint8_t               *buf;
+  size_t                n;
+#endif
+} printout_t;
+
+#if CHPRINTF_BUFFER_SIZE > 0
+#if !CH_USE_MUTEXES
+#error "CHPRINTF_BUFFER_SIZE requires CH_USE_MUTEXES"
+#endif
+
+/*
+ * The output buffer, shared by all the threads. A call that finds it in
+ * use writes a character at a time, it does not wait.
+ */
+static uint8_t buffer[CHPRINTF_BUFFER_SIZE];
+static MUTEX_DECL(buffer_mtx);
+#endif
+
+static void flush(printout_t *op) {
+
+#if CHPRINTF_BUFFER_SIZE > 0
+  if (op->n > 0) {
+    chSequentialStreamWrite(op->chp, op->buf, op->n);
+    op->n = 0;
+  }
+#else
+  (void)op;
+#endif
+}
+
+static void put(printout_t *op, char c) {
+
+#if CHPRINTF_BUFFER_SIZE > 0
+  if (op->buf == NULL) {
+    chSequentialStreamPut(op->chp, (uint8_t)c);
+    return;
+  }
+  op->buf[op->n++] = (uint8_t)c;
+  if (op->n == CHPRINTF_BUFFER_SIZE)
+    flush(op);
+#else
+  chSequentialStreamPut(op->chp, (uint8_t)c);
+#endif
+}
+
+/**
+ * @brief   Unsigned to string conversion without divisions.
+ * @details Decimal digits divide by ten with a multiplication by its
+ *          reciprocal where @p long has 32 bits, the other radixes are
+ *          powers of two and only shift.
+ */
+static char *ulong_to_string(char *p, unsigned long num, unsigned radix) {
+  char *q = p + MAX_FILLER;
+  unsigned long d;
+  unsigned shift;
+  int i;
+
+  if (radix == 10) {
+    do {
+#if ULONG_MAX == 0xFFFFFFFFUL
+      d = (unsigned long)(((unsigned long long)num * 0xCCCCCCCDUL) >> 35);
+#else
+      d = num / 10;
+#endif
+      *--q = (char)('0' + (num - d * 10));
+      num = d;
+    } while (num != 0);
+  }
+  else {
+    shift = radix == 16 ? 4 : 3;
+    do {
+      i = (int)(num & (radix - 1)) + '0';
+      if (i > '9')
+        i += 'A' - '0' - 10;
+      *--q = (char)i;
+      num >>= shift;
+    } while (num != 0);
+  }
+
+  i = (int)(p + MAX_FILLER - q);
+  do
+    *p++ = *q++;
+  while (--i);
+
+  return p;
+}
+
+#if CHPRINTF_USE_FLOAT
 static char *long_to_string_with_divisor(char *p,
                                          long num,
                                          unsigned radix,
@@ -70,12 +166,6 @@ static char *long_to_string_with_divisor(char *p,
   return p;
 }
 
-static char *ltoa(char *p, long num, unsigned radix) {
-
-  return long_to_string_with_divisor(p, num, radix, 0);
-}
-
-#if CHPRINTF_USE_FLOAT
 static char *ftoa(char *p, double num) {
   long l;
   unsigned long precision = FLOAT_PRECISION;
@@ -105,16 +195,22 @@ static char *ftoa(char *p, double num) {
  *          - <b>c</b> character.
  *          - <b>s</b> string.
  *          .
+ * @note    The output goes to the stream in blocks of
+ *          @p CHPRINTF_BUFFER_SIZE bytes, the last one when the format
+ *          string ends. While another thread holds the buffer it goes out
+ *          a character at a time.
  *
  * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
  * @param[in] fmt       formatting string
+ * @param[in] ap        list of parameters
  */
-void chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
-  va_list ap;
+void chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
+  printout_t out;
   char *p, *s, c, filler;
   int i, precision, width;
   bool_t is_long, left_align;
   long l;
+  unsigned long ul;
 #if CHPRINTF_USE_FLOAT
   float f;
   char tmpbuf[2*MAX_FILLER + 1];
@@ -122,15 +218,23 @@ void chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
   char tmpbuf[MAX_FILLER + 1];
 #endif
 
-  va_start(ap, fmt);
+  out.chp = chp;
+#if CHPRINTF_BUFFER_SIZE > 0
+  out.buf = chMtxTryLock(&buffer_mtx) ? buffer : NULL;
+  out.n = 0;
+#endif
   while (TRUE) {
     c = *fmt++;
     if (c == 0) {
-      va_end(ap);
+      flush(&out);
+#if CHPRINTF_BUFFER_SIZE > 0
+      if (out.buf != NULL)
+        chMtxUnlock();
+#endif
       return;
     }
     if (c != '%') {
-      chSequentialStreamPut(chp, (uint8_t)c);
+      put(&out, c);
       continue;
     }
     p = tmpbuf;
@@ -202,9 +306,11 @@ void chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
         l = va_arg(ap, int);
       if (l < 0) {
         *p++ = '-';
-        l = -l;
+        ul = 0UL - (unsigned long)l;
       }
-      p = ltoa(p, l, 10);
+      else
+        ul = (unsigned long)l;
+      p = ulong_to_string(p, ul, 10);
       break;
 #if CHPRINTF_USE_FLOAT
     case 'f':
@@ -229,10 +335,10 @@ void chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
       c = 8;
 unsigned_common:
       if (is_long)
-        l = va_arg(ap, long);
+        ul = va_arg(ap, unsigned long);
       else
-        l = va_arg(ap, int);
-      p = ltoa(p, l, c);
+        ul = va_arg(ap, unsigned int);
+      p = ulong_to_string(p, ul, c);
       break;
     default:
       *p++ = c;
@@ -245,21 +351,64 @@ unsigned_common:
       width = -width;
     if (width < 0) {
       if (*s == '-' && filler == '0') {
-        chSequentialStreamPut(chp, (uint8_t)*s++);
+        put(&out, *s++);
         i--;
       }
       do
-        chSequentialStreamPut(chp, (uint8_t)filler);
+        put(&out, filler);
       while (++width != 0);
     }
     while (--i >= 0)
-      chSequentialStreamPut(chp, (uint8_t)*s++);
+      put(&out, *s++);
 
     while (width) {
-      chSequentialStreamPut(chp, (uint8_t)filler);
+      put(&out, filler);
       width--;
     }
   }
 }
 
+/**
+ * @brief   System formatted output function.
+ * @details Formats as @p chvprintf() does.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream implementing object
+ * @param[in] fmt       formatting string
+ */
+void chprintf(BaseSequentialStream *chp, const char *fmt, ...) {
+  va_list ap;
+
+  va_start(ap, fmt);
+  chvprintf(chp, fmt, ap);
+  va_end(ap);
+}
+
+/**
+ * @brief   Formatted output to a string.
+ * @details Formats as @p chvprintf() does into a memory stream, the
+ *          output is truncated to @p size - 1 characters and always
+ *          terminated.
+ *
+ * @param[out] str      the destination buffer
+ * @param[in] size      size of the destination buffer
+ * @param[in] fmt       formatting string
+ * @return              The number of characters written, without the
+ *                      terminator.
+ */
+int chsnprintf(char *str, size_t size, const char *fmt, ...) {
+  va_list ap;
+  MemoryStream ms;
+
+  if (size == 0)
+    return 0;
+
+  msObjectInit(&ms, (uint8_t *)str, size - 1, 0);
+  va_start(ap, fmt);
+  chvprintf((BaseSequentialStream *)&ms, fmt, ap);
+  va_end(ap);
+  str[ms.eos] = 0;
+
+  return (int)ms.eos;
+}
+
 /** @} */
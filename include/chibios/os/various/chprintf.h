@@ -36,10 +36,27 @@
 #define CHPRINTF_USE_FLOAT          FALSE
 #endif
 
+/**
+ * @brief   Output buffer size.
+ * @details The formatted output is collected in a static buffer of this
+ *          size and written to the stream in blocks, a single write for
+ *          short outputs. The buffer is shared by all the threads under a
+ *          mutex, a call that finds it in use writes every character with
+ *          @p chSequentialStreamPut(). Zero always does so and does not
+ *          need @p CH_USE_MUTEXES.
+ */
+#if !defined(CHPRINTF_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CHPRINTF_BUFFER_SIZE        64
+#endif
+
+#include <stdarg.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
+  void chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap);
   void chprintf(BaseSequentialStream *chp, const char *fmt, ...);
+  int chsnprintf(char *str, size_t size, const char *fmt, ...);
 #ifdef __cplusplus
 }
 #endif
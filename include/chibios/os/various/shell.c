@@ -132,6 +132,81 @@ static bool_t cmdexec(const ShellCommand *scp, BaseSequentialStream *chp,
   return TRUE;
 }
 
+/**
+ * @brief   Splits a command line into the command and its arguments.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object, the
+ *                      errors are reported there
+ * @param[in] line      the command line, modified in place
+ * @param[out] argc     the number of arguments
+ * @param[out] argv     the arguments, @p SHELL_MAX_ARGUMENTS + 1 entries
+ * @return              The command name.
+ * @retval NULL         empty line or too many arguments.
+ */
+char *shellParse(BaseSequentialStream *chp, char *line,
+                 int *argc, char *argv[]) {
+  int n = 0;
+  char *lp, *cmd, *tokp;
+
+  lp = _strtok(line, " \009", &tokp);
+  cmd = lp;
+  while ((lp = _strtok(NULL, " \009", &tokp)) != NULL) {
+    if (n >= SHELL_MAX_ARGUMENTS) {
+      chprintf(chp, "too many arguments\r\n");
+      cmd = NULL;
+      break;
+    }
+    argv[n++] = lp;
+  }
+  argv[n] = NULL;
+  *argc = n;
+  return cmd;
+}
+
+/**
+ * @brief   Executes a command.
+ * @details The built in commands are looked up first, then the ones of
+ *          the configuration. An unknown command is answered with its
+ *          name and a question mark.
+ *
+ * @param[in] scp       pointer to a @p ShellConfig object
+ * @param[in] cmd       the command name
+ * @param[in] argc      the number of arguments
+ * @param[in] argv      the arguments
+ * @return              The session status.
+ * @retval TRUE         the command was "exit", the session ends.
+ * @retval FALSE        otherwise.
+ */
+bool_t shellExec(const ShellConfig *scp, char *cmd, int argc, char *argv[]) {
+  BaseSequentialStream *chp = scp->sc_channel;
+
+  if (strcasecmp(cmd, "exit") == 0) {
+    if (argc > 0) {
+      usage(chp, "exit");
+      return FALSE;
+    }
+    return TRUE;
+  }
+  else if (strcasecmp(cmd, "help") == 0) {
+    if (argc > 0) {
+      usage(chp, "help");
+      return FALSE;
+    }
+    chprintf(chp, "Commands: help exit ");
+    list_commands(chp, local_commands);
+    if (scp->sc_commands != NULL)
+      list_commands(chp, scp->sc_commands);
+    chprintf(chp, "\r\n");
+  }
+  else if (cmdexec(local_commands, chp, cmd, argc, argv) &&
+      ((scp->sc_commands == NULL) ||
+       cmdexec(scp->sc_commands, chp, cmd, argc, argv))) {
+    chprintf(chp, "%s", cmd);
+    chprintf(chp, " ?\r\n");
+  }
+  return FALSE;
+}
+
 /**
  * @brief   Shell thread function.
  *
@@ -143,9 +218,9 @@ static bool_t cmdexec(const ShellCommand *scp, BaseSequentialStream *chp,
 static msg_t shell_thread(void *p) {
   int n;
   msg_t msg = RDY_OK;
-  BaseSequentialStream *chp = ((ShellConfig *)p)->sc_channel;
-  const ShellCommand *scp = ((ShellConfig *)p)->sc_commands;
-  char *lp, *cmd, *tokp, line[SHELL_MAX_LINE_LENGTH];
+  const ShellConfig *scp = (const ShellConfig *)p;
+  BaseSequentialStream *chp = scp->sc_channel;
+  char *cmd, line[SHELL_MAX_LINE_LENGTH];
   char *args[SHELL_MAX_ARGUMENTS + 1];
 
   chRegSetThreadName("shell");
@@ -156,43 +231,9 @@ static msg_t shell_thread(void *p) {
       chprintf(chp, "\r\nlogout");
       break;
     }
-    lp = _strtok(line, " \009", &tokp);
-    cmd = lp;
-    n = 0;
-    while ((lp = _strtok(NULL, " \009", &tokp)) != NULL) {
-      if (n >= SHELL_MAX_ARGUMENTS) {
-        chprintf(chp, "too many arguments\r\n");
-        cmd = NULL;
-        break;
-      }
-      args[n++] = lp;
-    }
-    args[n] = NULL;
-    if (cmd != NULL) {
-      if (strcasecmp(cmd, "exit") == 0) {
-        if (n > 0) {
-          usage(chp, "exit");
-          continue;
-        }
-        break;
-      }
-      else if (strcasecmp(cmd, "help") == 0) {
-        if (n > 0) {
-          usage(chp, "help");
-          continue;
-        }
-        chprintf(chp, "Commands: help exit ");
-        list_commands(chp, local_commands);
-        if (scp != NULL)
-          list_commands(chp, scp);
-        chprintf(chp, "\r\n");
-      }
-      else if (cmdexec(local_commands, chp, cmd, n, args) &&
-          ((scp == NULL) || cmdexec(scp, chp, cmd, n, args))) {
-        chprintf(chp, "%s", cmd);
-        chprintf(chp, " ?\r\n");
-      }
-    }
+    cmd = shellParse(chp, line, &n, args);
+    if ((cmd != NULL) && shellExec(scp, cmd, n, args))
+      break;
   }
   /* Atomically broadcasting the event source and terminating the thread,
      there is not a chSysUnlock() because the thread terminates upon return.*/
@@ -78,6 +78,9 @@ extern "C" {
   Thread *shellCreateStatic(const ShellConfig *scp, void *wsp,
                             size_t size, tprio_t prio);
   bool_t shellGetLine(BaseSequentialStream *chp, char *line, unsigned size);
+  char *shellParse(BaseSequentialStream *chp, char *line,
+                   int *argc, char *argv[]);
+  bool_t shellExec(const ShellConfig *scp, char *cmd, int argc, char *argv[]);
 #ifdef __cplusplus
 }
 #endif
@@ -53,6 +53,7 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -689,6 +690,80 @@ ROMCONST struct testcase testbmk13 = {
   bmk13_execute
 };
 
+#if CH_USE_QUEUES || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_014 I/O Queues block throughput
+ *
+ * <h2>Description</h2>
+ * A block of data is written into an @p OutputQueue, moved by the lower
+ * side into an @p InputQueue and read back, into a continuous loop. The
+ * same is done a byte at a time and with the block functions of the upper
+ * side, the lower side moves a byte at a time as the drivers do.<br>
+ * The performance is calculated by measuring the number of bytes moved after
+ * a second of continuous operations.
+ */
+
+static void bmk14_execute(void) {
+  static uint8_t ib[256], ob[256], buf[48];
+  static InputQueue iq;
+  static OutputQueue oq;
+  uint32_t n;
+  unsigned i;
+
+  /* The block size does not divide the queue size, the copies also wrap
+     around.*/
+  chIQInit(&iq, ib, sizeof(ib), NULL, NULL);
+  chOQInit(&oq, ob, sizeof(ob), NULL, NULL);
+
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    for (i = 0; i < sizeof(buf); i++)
+      (void)chOQPut(&oq, buf[i]);
+    chSysLock();
+    for (i = 0; i < sizeof(buf); i++)
+      (void)chIQPutI(&iq, (uint8_t)chOQGetI(&oq));
+    chSysUnlock();
+    for (i = 0; i < sizeof(buf); i++)
+      buf[i] = (uint8_t)chIQGet(&iq);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Bytes : ");
+  test_printn(n * sizeof(buf));
+  test_println(" bytes/S");
+
+  n = 0;
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    (void)chOQWriteTimeout(&oq, buf, sizeof(buf), TIME_INFINITE);
+    chSysLock();
+    for (i = 0; i < sizeof(buf); i++)
+      (void)chIQPutI(&iq, (uint8_t)chOQGetI(&oq));
+    chSysUnlock();
+    (void)chIQReadTimeout(&iq, buf, sizeof(buf), TIME_INFINITE);
+    n++;
+#if defined(SIMULATOR)
+    ChkIntSources();
+#endif
+  } while (!test_timer_done);
+  test_print("--- Blocks: ");
+  test_printn(n * sizeof(buf));
+  test_println(" bytes/S");
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, I/O Queues block throughput",
+  NULL,
+  NULL,
+  bmk14_execute
+};
+#endif
+
 /**
  * @brief   Test sequence for benchmarks.
  */
@@ -709,6 +784,9 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
   &testbmk12,
 #endif
   &testbmk13,
+#if CH_USE_QUEUES || defined(__DOXYGEN__)
+  &testbmk14,
+#endif
 #endif
   NULL
 };
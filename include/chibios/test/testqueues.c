@@ -47,6 +47,7 @@
  * <h2>Test Cases</h2>
  * - @subpage test_queues_001
  * - @subpage test_queues_002
+ * - @subpage test_queues_003
  * .
  * @file testqueues.c
  * @brief I/O Queues test source file
@@ -234,6 +235,83 @@ ROMCONST struct testcase testqueues2 = {
   NULL,
   queues2_execute
 };
+
+/**
+ * @page test_queues_003 Block transfers
+ *
+ * <h2>Description</h2>
+ * Blocks of data are moved through an @p InputQueue and an @p OutputQueue
+ * with the block functions, so that the copies wrap around the end of the
+ * queue buffers. The data must come out in order.
+ */
+
+static void queues3_setup(void) {
+
+  chIQInit(&iq, wa[0], TEST_QUEUES_SIZE, notify, NULL);
+  chOQInit(&oq, (uint8_t *)wa[0] + TEST_QUEUES_SIZE, TEST_QUEUES_SIZE,
+           notify, NULL);
+}
+
+static void queues3_execute(void) {
+  uint8_t *bp = wa[1];
+  size_t i, n;
+  msg_t msg;
+
+  /* Input queue, the second read wraps around.*/
+  chSysLock();
+  for (i = 0; i < 3; i++)
+    (void)chIQPutI(&iq, (uint8_t)('A' + i));
+  chSysUnlock();
+  test_assert_lock(1, chIQGetFullI(&iq) == 3, "wrong written size");
+  n = chIQReadTimeout(&iq, bp, 2, TIME_IMMEDIATE);
+  test_assert(2, n == 2, "wrong returned size");
+  for (i = 0; i < n; i++)
+    test_emit_token(bp[i]);
+  chSysLock();
+  for (i = 0; i < 3; i++)
+    (void)chIQPutI(&iq, (uint8_t)('D' + i));
+  msg = chIQPutI(&iq, 'G');
+  chSysUnlock();
+  test_assert(3, msg == Q_FULL, "not full");
+  test_assert_lock(4, chIQIsFullI(&iq), "not full");
+  n = chIQReadTimeout(&iq, bp, TEST_QUEUES_SIZE * 2, TIME_IMMEDIATE);
+  test_assert(5, n == TEST_QUEUES_SIZE, "wrong returned size");
+  for (i = 0; i < n; i++)
+    test_emit_token(bp[i]);
+  test_assert_sequence(6, "ABCDEF");
+
+  /* Output queue, the second write wraps around and is cut to the space
+     left.*/
+  n = chOQWriteTimeout(&oq, (const uint8_t *)"ABC", 3, TIME_IMMEDIATE);
+  test_assert(7, n == 3, "wrong written size");
+  chSysLock();
+  for (i = 0; i < 2; i++)
+    bp[i] = (uint8_t)chOQGetI(&oq);
+  chSysUnlock();
+  for (i = 0; i < 2; i++)
+    test_emit_token(bp[i]);
+  test_assert_lock(8, chOQGetFullI(&oq) == 1, "wrong remaining size");
+  n = chOQWriteTimeout(&oq, (const uint8_t *)"DEFG", 4, TIME_IMMEDIATE);
+  test_assert(9, n == 3, "wrong written size");
+  test_assert_lock(10, chOQIsFullI(&oq), "not full");
+  chSysLock();
+  for (i = 0; i < TEST_QUEUES_SIZE; i++)
+    bp[i] = (uint8_t)chOQGetI(&oq);
+  msg = chOQGetI(&oq);
+  chSysUnlock();
+  test_assert(11, msg == Q_EMPTY, "still full");
+  for (i = 0; i < TEST_QUEUES_SIZE; i++)
+    test_emit_token(bp[i]);
+  test_assert_sequence(12, "ABCDEF");
+  test_assert_lock(13, chOQIsEmptyI(&oq), "not empty");
+}
+
+ROMCONST struct testcase testqueues3 = {
+  "Queues, block transfers",
+  queues3_setup,
+  NULL,
+  queues3_execute
+};
 #endif /* CH_USE_QUEUES */
 
 /**
@@ -243,6 +321,7 @@ ROMCONST struct testcase * ROMCONST patternqueues[] = {
 #if CH_USE_QUEUES || defined(__DOXYGEN__)
   &testqueues1,
   &testqueues2,
+  &testqueues3,
 #endif
   NULL
 };
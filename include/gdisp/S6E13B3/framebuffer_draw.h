@@ -1,2 +1,15 @@
 extern uint8_t framebuffer_active;
 void framebuffer_draw(void);
+// for writers that bypass gdisp, the next framebuffer_draw() sends the frame
+void framebuffer_invalidate(void);
+
+// counters for olv_perf, written by the drawing thread alone
+extern uint32_t framebuffer_pixels;
+extern uint32_t framebuffer_spi_bytes;
+extern uint32_t framebuffer_spi_us;
+
+// the second half of the internal memory, in the panel orientation.
+// rows of FRAMEBUFFER_WIDTH pixels, rgb565 with the high byte first.
+#define FRAMEBUFFER_ADDRESS 0x20008000
+#define FRAMEBUFFER_WIDTH 128
+#define FRAMEBUFFER_HEIGHT 128
@@ -117,6 +117,8 @@ void GDISP_LLD(drawpixel)(coord_t x, coord_t y, color_t color) {
     if (x < GDISP.clipx0 || y < GDISP.clipy0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
   #endif
 
+  framebuffer_pixels++;
+
   if (framebuffer_changed == 0) {
     if (((((unsigned char *) framebuffer)[((y * GDISP.Height) + x) * 2] << 8 & 0xFF00) | ((unsigned char *) framebuffer)[((y * GDISP.Height) + x) * 2 + 1]) != color) {
       framebuffer_changed = 1;
@@ -130,6 +132,67 @@ void GDISP_LLD(drawpixel)(coord_t x, coord_t y, color_t color) {
   //((color_t*)framebuffer)[(y * GDISP.Height) + x] = color;
 };
 
+// the framebuffer holds the pixels high byte first, the cpu is little endian.
+#define FRAMEBUFFER_SWAP(c) ((uint16_t)((c) << 8 | (c) >> 8))
+
+void GDISP_LLD(fillarea)(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+  uint16_t *line;
+  uint16_t px = FRAMEBUFFER_SWAP(color);
+  uint16_t changed = 0;
+  coord_t i;
+
+  #if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+    if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; x = GDISP.clipx0; }
+    if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; y = GDISP.clipy0; }
+    if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+    if (x + cx > GDISP.clipx1) cx = GDISP.clipx1 - x;
+    if (y + cy > GDISP.clipy1) cy = GDISP.clipy1 - y;
+  #endif
+
+  framebuffer_pixels += (uint32_t)cx * cy;
+  line = (uint16_t *) framebuffer + y * GDISP.Height + x;
+
+  for (; cy; cy--, line += GDISP.Height) {
+    for (i = 0; i < cx; i++) {
+      changed |= line[i] ^ px;
+      line[i] = px;
+    }
+  }
+
+  // keep the "nothing changed, nothing to flush" behaviour of drawpixel
+  if (changed) framebuffer_changed = 1;
+};
+
+void GDISP_LLD(blitareaex)(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer) {
+  uint16_t *line;
+  uint16_t px;
+  uint16_t changed = 0;
+  coord_t i;
+
+  #if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+    if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; srcx += GDISP.clipx0 - x; x = GDISP.clipx0; }
+    if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; srcy += GDISP.clipy0 - y; y = GDISP.clipy0; }
+    if (srcx + cx > srccx) cx = srccx - srcx;
+    if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+    if (x + cx > GDISP.clipx1) cx = GDISP.clipx1 - x;
+    if (y + cy > GDISP.clipy1) cy = GDISP.clipy1 - y;
+  #endif
+
+  framebuffer_pixels += (uint32_t)cx * cy;
+  line = (uint16_t *) framebuffer + y * GDISP.Height + x;
+  buffer += srcy * srccx + srcx;
+
+  for (; cy; cy--, line += GDISP.Height, buffer += srccx) {
+    for (i = 0; i < cx; i++) {
+      px = FRAMEBUFFER_SWAP(buffer[i]);
+      changed |= line[i] ^ px;
+      line[i] = px;
+    }
+  }
+
+  if (changed) framebuffer_changed = 1;
+};
+
 void GDISP_LLD(control)(unsigned what, void *value) {
   unsigned char display_enable_cmd = 0x02;
   unsigned char display_enable_data;
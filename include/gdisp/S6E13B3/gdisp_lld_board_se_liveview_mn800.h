@@ -5,11 +5,15 @@
 
 uint8_t framebuffer_active = 0;
 
+uint32_t framebuffer_pixels = 0;
+uint32_t framebuffer_spi_bytes = 0;
+uint32_t framebuffer_spi_us = 0;
+
 static uint8_t framebuffer_changed = 1;
 
 // the internal memory has been split into two regions.
 // the framebuffer points to the second region which it is defined for.
-static void *framebuffer = (void *) 0x20008000;
+static void *framebuffer = (void *) FRAMEBUFFER_ADDRESS;
 
 //static Thread *framebuffer_update_thread;
 //static WORKING_AREA(wa_framebuffer_update_thread, 128);
@@ -45,12 +49,21 @@ static __inline void release_bus(void) {
   spiReleaseBus(&SPID1);
 };
 
+static __inline void send(unsigned char *buffer, size_t length) {
+  halrtcnt_t start = halGetCounterValue();
+
+  spiSend(&SPID1, length, buffer);
+
+  framebuffer_spi_bytes += length;
+  framebuffer_spi_us += RTT2US(halGetCounterValue() - start);
+};
+
 static __inline void write_cmd(unsigned char *cmd, size_t length) {
   acquire_bus();
 
   palClearPad(GPIOC, GPIOC_SPI1_CD);
 
-  spiSend(&SPID1, length, cmd);
+  send(cmd, length);
 
   palSetPad(GPIOC, GPIOC_SPI1_CD);
 
@@ -60,7 +73,7 @@ static __inline void write_cmd(unsigned char *cmd, size_t length) {
 static __inline void write_data(unsigned char *data, size_t length) {
   acquire_bus();
 
-  spiSend(&SPID1, length, data);
+  send(data, length);
 
   release_bus();
 };
@@ -130,6 +143,10 @@ static __inline void framebuffer_update_stop(void) {
   // chThdTerminate(framebuffer_update_thread);
 };*/
 
+void framebuffer_invalidate (void) {
+  framebuffer_changed = 1;
+};
+
 void framebuffer_draw (void) {
 	if (!framebuffer_active || !framebuffer_changed) return;
   framebuffer_changed = 0;
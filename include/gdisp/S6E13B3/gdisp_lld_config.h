@@ -6,10 +6,10 @@
 #define GDISP_DRIVER_NAME				"S6E13B3"
 #define GDISP_LLD(x)					gdisp_lld_##x##_S6E13B3
 
-#define GDISP_HARDWARE_FILLS		FALSE
-#define GDISP_HARDWARE_BITFILLS		FALSE
+#define GDISP_HARDWARE_FILLS		TRUE
+#define GDISP_HARDWARE_BITFILLS		TRUE
 #define GDISP_HARDWARE_SCROLL		FALSE
-#define GDISP_HARDWARE_READPIXEL	TRUE
+#define GDISP_HARDWARE_PIXELREAD	TRUE
 
 #define GDISP_HARDWARE_CONTROL		TRUE
 
@@ -70,6 +70,7 @@
 #define GPIOC_CHARGE_DISABLED	1
 #define GPIOC_USB_DETECT	6
 #define GPIOC_SPI1_CD		10
+#define GPIOC_EXTGPIO_INT	13
 
 #define GPIOD_OLED_ENABLE	2
 
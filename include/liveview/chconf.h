@@ -19,6 +19,10 @@
 #define CH_NO_IDLE_THREAD               FALSE
 #endif
 
+#if !defined(CH_USE_TICKLESS)
+#define CH_USE_TICKLESS                 TRUE
+#endif
+
 #if !defined(CH_OPTIMIZE_SPEED)
 #define CH_OPTIMIZE_SPEED               TRUE
 #endif
@@ -120,11 +124,11 @@
 #endif
 
 #if !defined(CH_DBG_FILL_THREADS)
-#define CH_DBG_FILL_THREADS             FALSE
+#define CH_DBG_FILL_THREADS             TRUE
 #endif
 
 #if !defined(CH_DBG_THREADS_PROFILING)
-#define CH_DBG_THREADS_PROFILING        FALSE
+#define CH_DBG_THREADS_PROFILING        TRUE
 #endif
 
 #if !defined(THREAD_EXT_FIELDS)
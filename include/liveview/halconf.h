@@ -148,11 +148,18 @@
 #define GFX_USE_GWIN                TRUE 
 #define GFX_USE_GRAPH               TRUE
 #define GFX_USE_CONSOLE             TRUE
+#define GFX_USE_GEVENT              TRUE
 
 #define GDISP_USE_S6E13B3           TRUE
 
 #define GDISP_NEED_CLIP             TRUE
+#define GDISP_NEED_PIXELREAD        TRUE
+#define GDISP_NEED_IMAGE            TRUE
+#define GDISP_NEED_GLYPHCACHE       TRUE
+#define GDISP_NEED_TEXTRUN          TRUE
 #define GWIN_NEED_CONSOLE       TRUE
 
+#define MAX_SOURCE_LISTENERS        8
+
 #endif
 
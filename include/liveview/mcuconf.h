@@ -127,4 +127,6 @@
 #define STM32_USB_LOW_POWER_ON_SUSPEND      FALSE
 #define STM32_USB_USB1_HP_IRQ_PRIORITY      13
 #define STM32_USB_USB1_LP_IRQ_PRIORITY      14
+/* endpoints 0 to 4, the rest of the table holds packet buffers */
+#define STM32_USB_BTABLE_ENDPOINTS          5
 
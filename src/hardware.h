@@ -68,7 +68,7 @@ static void ext_irq_handler(EXTDriver *extp, expchannel_t channel) {
   (void)extp;
   (void)channel;
 
-  //chprintf((BaseSequentialStream *)&SDU1, "irq %u\r\n", channel);
+  OLV_LOG("ext irq %u", channel);
 };
 
 static const EXTConfig ext_cfg = {
@@ -92,8 +92,8 @@ static const EXTConfig ext_cfg = {
     {EXT_CH_MODE_DISABLED, NULL},
 
     {EXT_CH_MODE_DISABLED, NULL},
-/* i2c ext gpio. i2c ext gpio controller need reset after event but unknown how */
-    {EXT_CH_MODE_RISING_EDGE  | EXT_CH_MODE_AUTOSTART | EXT_MODE_GPIOC, ext_irq_handler},
+/* i2c ext gpio. the controller releases the line when its inputs are read (olv_input) */
+    {EXT_CH_MODE_RISING_EDGE  | EXT_CH_MODE_AUTOSTART | EXT_MODE_GPIOC, olv_input_irq},
     {EXT_CH_MODE_DISABLED, NULL},
     {EXT_CH_MODE_DISABLED, NULL},
   }
@@ -17,258 +17,320 @@
 #include "aclock/aclock.h"
 #include "framebuffer_draw.h"
 
-#include "hardware.h"
+#include "olv_events/ev.h"
+#include "olv_events/pt.h"
+#include "olv_i2c/i2cq.h"
+#include "olv_input/input.h"
+#include "olv_input/gesture.h"
+#include "olv_time/time.h"
+#include "olv_render/render.h"
+#include "olv_power/power.h"
+#include "olv_asset/asset.h"
+#include "olv_log/log.h"
+#include "olv_perf/perf.h"
 
-#include "project.h"
-unsigned long time_offset = 0;
+#include "hardware.h"
 
 #include "usb_hw.h"
 #include "usb_shell.h"
 
-#define SHELL_WA_SIZE   THD_WA_SIZE(4096)
-#define TEST_WA_SIZE    THD_WA_SIZE(512)
-
 // =======================================
 
-typedef unsigned long (*olv_event_func)(void);
-
-typedef struct {
-  unsigned char enabled;
-  unsigned long ttn;
-  olv_event_func func;
-} olv_event_pool;
-
 //used by aclock:
 static unsigned int beep = 0;
-
-// used by button:
-static uint8_t olv_buttonbits = 0;
-static unsigned long olv_buttons[6] = {0};
-static uint8_t olv_buttonflags[6] = {0,0,0,0,0,2};
-static uint8_t olv_buttonticks[6] = {0};
-static unsigned long olv_disp_timeout = 0;
-#define OLV_DISP_TIMEOUT 20000
+static uint32_t olv_aclock_sec;
+
+// the face shows a second hand while the display is on, without it the
+// rtc alarm wakes it once a minute
+#define OLV_ACLOCK_SECONDS 1
+
+// used by debug info:
+static color_t olv_debug_colors[6];
+
+// used by display, see olv_power/power.h
+static const olv_power_config olv_power_cfg = {
+  10000,  // dim
+  20000,  // sleep
+  60000,  // off
+  2000,   // fast frames after an input
+  33,     // at most 30 frames per second while buttons are used
+  100     // and 10 otherwise
+};
 
 // used by menu:
-static uint8_t olv_menu_state = 0;
+static olv_pt olv_menu_pt;
+static olv_gesture_box olv_menu_box;
+static GEventGesture olv_menu_gesture;
+// setting the time ends after this long without a button
+#define OLV_MENU_TIMEOUT 10000
+
+#define OLV_BUTTON_POWER 5
+#define OLV_BUTTON_MENU 4
+
+// the gestures of every button, buttons 0-3 repeat faster the longer they are held
+static const olv_gesture_config olv_button_config[OLV_INPUT_COUNT] = {
+  {0, 240, 40, 20},
+  {0, 240, 40, 20},
+  {0, 240, 40, 20},
+  {0, 240, 40, 20},
+  {0, 0, 0, 0},
+  {0, 0, 0, 0}
+};
+
+// menu held together with another button
+static const uint8_t olv_button_chords[] = {
+  1 << OLV_BUTTON_MENU | 1 << 0,
+  1 << OLV_BUTTON_MENU | 1 << 1,
+  1 << OLV_BUTTON_MENU | 1 << 2,
+  1 << OLV_BUTTON_MENU | 1 << 3
+};
+
+static GListener olv_display_listener;
+static GListener olv_debug_listener;
 
-// do not forget to add prototypes here.
-// if you forget it, the olv_event array will fail epicly.
-static unsigned long olv_button (void);
-static unsigned long olv_menu (void);
-static unsigned long olv_set_time (void);
 static unsigned long olv_aclock (void);
 static unsigned long olv_debug_info (void);
+static unsigned long olv_menu (void);
 
-// do not forget to change the defines above the olv_ methods.
-#define OLV_EVENT_COUNT 5
-
+// the indices into olv_event[]
 #define OLV_EVENT_BUTTON 0
-#define OLV_EVENT_MENU 1
-#define OLV_EVENT_SET_TIME 2
-#define OLV_EVENT_ACLOCK 3
-#define OLV_EVENT_DEBUG_INFO 4
-
-// ALWAYS keep them as index.
-// theese defines help avoiding to go through the event_pool for searching.
-// efficiency will come when i have time to clean this up.
-
-// first: unsigned char "enabled". this is to detect if the loop should or should not ignore it.
-// second: unsigned long "ttn". this shows a timestamp pointing to the next execution time.
-// third: "func". this is a pointer to the actual method.
+#define OLV_EVENT_ACLOCK 1
+#define OLV_EVENT_DEBUG_INFO 2
+#define OLV_EVENT_MENU 3
+
+// an event only runs while it is scheduled (see olv_events/ev.h), the
+// priority decides the order of events that are due at the same time.
+// the gesture engine runs first, its listeners below are called from it.
+// the events only update state and invalidate layers, the render event
+// (olv_render/render.h) draws after them.
 static olv_event_pool olv_event[] = {
-  {1, 0, olv_button},
-  {1, 0, olv_menu},
-  {0, 0, olv_set_time},
-  {1, 0, olv_aclock},
-  {1, 0, olv_debug_info}
+  OLV_EVENT(olv_gesture_run, OLV_EV_PRIO_INPUT),
+  OLV_EVENT(olv_aclock, OLV_EV_PRIO_LOGIC),
+  OLV_EVENT(olv_debug_info, OLV_EV_PRIO_LOGIC),
+  OLV_EVENT(olv_menu, OLV_EV_PRIO_LOGIC)
 };
 
-static unsigned long olv_event_time; // current tick's time
+static void olv_aclock_draw (void);
+static void olv_debug_draw (void);
 
+#define OLV_LAYER_ACLOCK 0
+#define OLV_LAYER_DEBUG_INFO 1
 
-static unsigned long olv_button (void) {
+// the screen layers bottom up. the dial of the clock face is mirrored
+// around the centre and reaches y = 122, so the face takes the whole
+// screen and a face redraw redraws the debug row above it as well.
+static const olv_layer olv_layers[] = {
+  OLV_LAYER(olv_aclock_draw, 0, 0, 128, 128),
+  OLV_LAYER(olv_debug_draw, 0, 120, 128, 8)
+};
 
-  static uint8_t i2c_buffer[2];
-  static uint8_t i;
-  uint8_t draw = framebuffer_active;
 
-  i2cAcquireBus(&I2CD1);
+// the power policy changed the display state, the frame rate or the face
+static void olv_display_power (const olv_power_state* from, const olv_power_state* to) {
+
+  // schedule / remove the drawing events depending on sleep state.
+  if (to->display >= OLV_POWER_DIM) {
+    if (from->display < OLV_POWER_DIM) {
+      // when device is awakened, schedule all events to fire within this tick
+      OLV_PT_INIT(&olv_menu_pt);
+      olv_gesture_box_clear(&olv_menu_box);
+      gdispControl(GDISP_CONTROL_POWER, powerOn);
+      olv_ev_at(&olv_event[OLV_EVENT_DEBUG_INFO], olv_event_time);
+      olv_render_invalidate(OLV_RENDER_ALL);
+    }
+    // the face changes between seconds and minutes
+    olv_ev_at(&olv_event[OLV_EVENT_ACLOCK], olv_event_time);
+  }
+  else {
+    olv_time_alarm(NULL, 0);
+    olv_ev_remove(&olv_event[OLV_EVENT_ACLOCK]);
+    olv_ev_remove(&olv_event[OLV_EVENT_DEBUG_INFO]);
+    gdispControl(GDISP_CONTROL_POWER, to->display == OLV_POWER_SLEEP ? powerSleep : powerOff);
+  }
+
+  olv_render_set_period(to->frame);
+};
 
-  olv_buttonbits = \
-    i2cMasterReceiveTimeout(&I2CD1, I2C1_EXTGPIO_ADDRESS, i2c_buffer, 2, 10) \
-    == RDY_OK ? i2c_buffer[1] : 0;
 
-  i2cReleaseBus(&I2CD1);
+// every gesture keeps the display on, releasing the power button toggles it
+static void olv_display_gesture (void *param, GEvent *pe) {
 
-  // set button states into olv_buttons and olv_buttonflags
-  // in future, olv_buttonflags will be used for certain states
-  for (i = 0; i < 6; i++) {
-    // pressed button detected
-    if ((olv_buttonbits >> i) & 1) {
-      if (olv_buttons[i] == 0) {
-        olv_buttons[i] = olv_event_time;
-        olv_buttonticks[i] = 0;
-      }
-      // auto repeat button press if hold for a certain time
-      else if (olv_buttonflags[i]== 1 && olv_buttons[i] +(240 -(olv_buttonticks[i] > 60 ? 60 : olv_buttonticks[i]++)*4) < olv_event_time) {
-        olv_buttons[i] = olv_event_time;
-        olv_buttonflags[i] = 0;
-      }
-      // turn screen off after a timeout
-      olv_disp_timeout = olv_event_time + OLV_DISP_TIMEOUT;
-    // check if button has been released
-    } else if (olv_buttons[i] != 0) {
-      olv_buttonflags[i] = olv_buttonflags[i] == 2 ? 1 : 0;
-      olv_buttonticks[i] = 0;
-      olv_buttons[i] = 0;
-    }
+  GEventGesture* g = (GEventGesture*)pe;
+  (void)param;
+
+  if (g->instance == OLV_BUTTON_POWER && g->gesture == OLV_GESTURE_RELEASE) {
+    if (olv_power.display >= OLV_POWER_DIM) olv_power_off();
+    else olv_power_wake();
   }
+  else olv_power_input();
+};
+
 
-  // check if power button has been pressed or the display has a timeout because no buttons have been pressed in a while
-  if ((!olv_buttons[5] && !olv_buttonflags[5]) || (draw == 1 && olv_disp_timeout < olv_event_time)) {
-    draw = draw ? 0 : 1;
-    olv_buttonflags[5] = 1;
-
-    // enable / disable following events depending on sleep state.
-    olv_event[OLV_EVENT_MENU].enabled = draw; // not cleanly implemented yet
-    //olv_event[OLV_EVENT_SET_TIME].enabled = draw; // this shall be a menu item in future.
-    olv_event[OLV_EVENT_ACLOCK].enabled = draw;
-    olv_event[OLV_EVENT_DEBUG_INFO].enabled = draw;
-    
-    if (draw) {
-      // when device is awakened, change all events to fire within this tick
-      olv_event[OLV_EVENT_MENU].ttn = 0;
-      // olv_event[OLV_EVENT_SET_TIME].ttn = 0; the menu shall decide to enable this.
-      olv_event[OLV_EVENT_ACLOCK].ttn = 0;
-      olv_event[OLV_EVENT_DEBUG_INFO].ttn = 0;
+static void olv_set_time (GEventGesture* g) {
+
+  if (g->gesture == OLV_GESTURE_CHORD) {
+    switch (g->instance) {
+    // turn vibration on
+    case 2:
+      palSetPad(GPIOC, GPIOC_VIBRATOR_ENABLE);
+      pwmEnableChannel(&PWMD1, 1, 10000);
+      return;
+    // turn vibration off
+    case 1:
+      palClearPad(GPIOC, GPIOC_VIBRATOR_ENABLE);
+      pwmDisableChannel(&PWMD1, 1);
+      return;
+    // start the next second now
+    case 3:
+      olv_time_set(olv_time_sec() +1);
+      break;
+    // set second -1
+    case 0:
+      olv_time_adjust(-1);
+      break;
+    default:
+      return;
     }
-    else {
-      // when device goes to bed (disable set_time in order to turn menu on)
-      olv_event[OLV_EVENT_SET_TIME].enabled = 0; // not cleanly implemented yet
+  } else {
+    switch (g->instance) {
+    // set minute +1
+    case 3:
+      olv_time_adjust(60);
+      break;
+    // set minute -1
+    case 0:
+      olv_time_adjust(-60);
+      break;
+    // set hour +1
+    case 2:
+      olv_time_adjust(60 *60);
+      break;
+    // set hour -1
+    case 1:
+      olv_time_adjust(-60 *60);
+      break;
+    default:
+      return;
     }
-
-    gdispControl(GDISP_CONTROL_POWER, draw ? powerOn : powerOff);
   }
 
-  // disables screen timeout when the clock is charging
-  if (draw && SDU1.config->usbp->state == USB_ACTIVE) {
-    olv_disp_timeout = olv_event_time + OLV_DISP_TIMEOUT;
-  }
+  olv_ev_at(&olv_event[OLV_EVENT_ACLOCK], olv_event_time);
+};
+
+
+// takes the next gesture for the menu into olv_menu_gesture.
+// buttons only control the menu while the display is on.
+static bool_t olv_menu_next (void) {
 
-  // powersaving - the stupid way :/
-  return draw ? 20 : 250;
+  while (olv_gesture_box_get(&olv_menu_box, &olv_menu_gesture))
+    if (framebuffer_active) return TRUE;
+
+  return FALSE;
 };
 
+#define OLV_MENU_PRESSED() \
+  (olv_menu_gesture.instance == OLV_BUTTON_MENU && olv_menu_gesture.gesture == OLV_GESTURE_PRESS)
 
-static unsigned long olv_menu (void) {
+// skips the gestures up to a press of the menu button
+static bool_t olv_menu_pressed (void) {
 
-  (void)olv_menu_state;
-  if (olv_buttons[4] && !olv_buttonflags[4]) {
-    olv_buttonflags[4] = 1;
-    olv_event[OLV_EVENT_MENU].enabled = 0;
-    olv_event[OLV_EVENT_SET_TIME].enabled = 1;
-    olv_event[OLV_EVENT_SET_TIME].ttn = 0;
-  }
+  while (olv_menu_next())
+    if (OLV_MENU_PRESSED()) return TRUE;
 
-  return olv_event[OLV_EVENT_BUTTON].ttn -olv_event_time;
+  return FALSE;
 };
 
+// the menu is a coroutine (olv_events/pt.h) woken up by its gesture box
+static unsigned long olv_menu (void) {
 
-static unsigned long olv_set_time (void) {
- 
-  // turn vibration on
-  if (olv_buttons[4] && olv_buttons[2] && !olv_buttonflags[2]) {
-    palSetPad(GPIOC, GPIOC_VIBRATOR_ENABLE);
-		pwmEnableChannel(&PWMD1, 1, 10000);
-    olv_buttonflags[2] = 1;
-  }
-  // turn vibration off
-  if (olv_buttons[4] && olv_buttons[1] && !olv_buttonflags[1]) {
-    palClearPad(GPIOC, GPIOC_VIBRATOR_ENABLE);
-		pwmDisableChannel(&PWMD1, 1);
-    olv_buttonflags[1] = 1;
-  }
+  OLV_PT_BEGIN(&olv_menu_pt);
 
-  // set second to now and plus 1
-  if (olv_buttons[4] && olv_buttons[3] && !olv_buttonflags[3]) {
-    time_offset = (time_offset & ~7) +1000 -(olv_event_time %1000);
-    olv_buttonflags[3] = 1;
-    olv_event[OLV_EVENT_ACLOCK].ttn = 0;
-  }
-  // set second -1
-  if (olv_buttons[4] && olv_buttons[0] && !olv_buttonflags[0]) {
-    //time_offset = (time_offset & ~7) -(olv_event_time %1000);
-    time_offset -= 1000;
-    olv_buttonflags[0] = 1;
-    olv_event[OLV_EVENT_ACLOCK].ttn = 0;
-  }
-  // set minute +1
-  if (olv_buttons[3] && !olv_buttonflags[3]) {
-    time_offset += 60 *1000;
-    olv_buttonflags[3] = 1;
-    olv_event[OLV_EVENT_ACLOCK].ttn = 0;
-  }
-  // set minute -1
-  if (olv_buttons[0] && !olv_buttonflags[0]) {
-    time_offset -= 60 *1000;
-    olv_buttonflags[0] = 1;
-    olv_event[OLV_EVENT_ACLOCK].ttn = 0;
-  }
-  // set hour +1
-  if (olv_buttons[2] && !olv_buttonflags[2]) {
-    time_offset += 60 *60 *1000;
-    olv_buttonflags[2] = 1;
-    olv_event[OLV_EVENT_ACLOCK].ttn = 0;
-  }
-  // set hour -1
-  if (olv_buttons[1] && !olv_buttonflags[1]) {
-    time_offset -= 60 *60 *1000;
-    olv_buttonflags[1] = 1;
-    olv_event[OLV_EVENT_ACLOCK].ttn = 0;
+  for (;;) {
+    // main screen, the menu button starts setting the time
+    OLV_PT_WAIT_UNTIL(&olv_menu_pt, olv_menu_pressed());
+
+    // not cleanly implemented yet: the menu button or a while without buttons goes back
+    for (;;) {
+      OLV_PT_WAIT_TIMEOUT(&olv_menu_pt, olv_menu_next(), OLV_MENU_TIMEOUT);
+      if (OLV_PT_TIMED_OUT(&olv_menu_pt) || OLV_MENU_PRESSED()) break;
+      olv_set_time(&olv_menu_gesture);
+    }
   }
 
-  return olv_event[OLV_EVENT_BUTTON].ttn -olv_event_time;
+  OLV_PT_END(&olv_menu_pt);
 };
 
 
 static unsigned long olv_aclock (void) {
 
-	//unsigned long now = (unsigned long)chTimeNow() +time_offset;
-	unsigned long now = olv_event_time +time_offset;
+  olv_aclock_sec = olv_time_sec();
+  olv_render_invalidate(1 << OLV_LAYER_ACLOCK);
 
-  // walking dot
+  // the rtc alarm fires the next draw
+  if (olv_power.seconds) olv_time_alarm(&olv_event[OLV_EVENT_ACLOCK], olv_aclock_sec +1);
+  else olv_time_alarm(&olv_event[OLV_EVENT_ACLOCK], olv_aclock_sec +60 -olv_time_calendar(olv_aclock_sec)->sec);
+
+  return OLV_EV_STOP;
+};
+
+
+static void olv_aclock_draw (void) {
+
+  const olv_calendar* now = olv_time_calendar(olv_aclock_sec);
+
+  // walking dot, hidden while dimmed
   gdispDrawPixel(5 +beep /2 %2 *3, 6 -(beep +1) /2 %2 *3, Black);
-  beep++;
-  gdispDrawPixel(5 +beep /2 %2 *3, 6 -(beep +1) /2 %2 *3, White);
+  if (olv_power.seconds) {
+    beep++;
+    gdispDrawPixel(5 +beep /2 %2 *3, 6 -(beep +1) /2 %2 *3, White);
+  }
 
   // background
   aclock_print(2, 0);
 
   // hour
-  aclock_print(0, now /1000 /60 /60 %12 *5 +now /1000 /60 %60 /12);
+  aclock_print(0, now->hour %12 *5 +now->min /12);
 
   // minute
-  aclock_print(1, now /1000 /60 %60);
+  aclock_print(1, now->min);
 
   // second (for testing)
-  aclock_print(1, now /1000 %60);
+  if (olv_power.seconds) aclock_print(1, now->sec);
+};
+
 
-  // timeout in ms to fire the next draw
-  return 1000 -(now %1000);
+// presses and releases redraw the button states
+static void olv_debug_gesture (void *param, GEvent *pe) {
+  (void)param;
+  (void)pe;
+
+  if (framebuffer_active) olv_ev_at(&olv_event[OLV_EVENT_DEBUG_INFO], olv_event_time);
 };
 
 
 static unsigned long olv_debug_info (void) {
 
   static uint8_t i;
-  //if (olv_buttons[4] != 0 && olv_buttons[4] +3000 < evt) framebuffer_active = 0; else framebuffer_active = 1;
+  uint8_t held = olv_gesture_held();
+  unsigned long fresh = 0, age;
 
   for (i = 0; i < 6; i++) {
-    gdispDrawPixel(5 +i *3, 126, ((olv_buttonbits >> i) &1) ? (olv_buttons[i] +10 < olv_event_time ? White : Red) : Blue);
+    age = olv_event_time -olv_gesture_down(i);
+    olv_debug_colors[i] = ((held >> i) &1) ? (age >= 10 ? White : Red) : Blue;
+    if (((held >> i) &1) && age < 10 && 10 -age > fresh) fresh = 10 -age;
   }
+  olv_render_invalidate(1 << OLV_LAYER_DEBUG_INFO);
 
-  return olv_event[OLV_EVENT_BUTTON].ttn -olv_event_time;
+  // fresh presses turn white after 10 ms, otherwise the gestures call again
+  return fresh ? fresh : OLV_EV_STOP;
+};
+
+
+static void olv_debug_draw (void) {
+
+  uint8_t i;
+
+  for (i = 0; i < 6; i++) gdispDrawPixel(5 +i *3, 126, olv_debug_colors[i]);
 };
 
 // =======================================
@@ -278,52 +340,41 @@ static WORKING_AREA(olvThreadWorkplace, 1024);
 static msg_t olvThread (void *arg) {
   (void)arg;
 
-  unsigned long smallest;
-  static uint8_t i;
-  olv_event_pool* ev;
-
-  for (;;) {
-    olv_event_time = (unsigned long)chTimeNow();
-    smallest = 120000 + olv_event_time;
+  olv_event_time = (unsigned long)chTimeNow();
 
-    for (i = 0; i < OLV_EVENT_COUNT; i++) {
+  olv_gesture_init(olv_button_config, olv_button_chords, sizeof(olv_button_chords));
+  olv_render_init(olv_layers, sizeof(olv_layers) /sizeof(olv_layers[0]), olv_power_cfg.frame_slow);
+  olv_power_init(&olv_power_cfg, olv_display_power, OLV_ACLOCK_SECONDS);
 
-      ev = &olv_event[i];
+  // the handlers are called from the gesture engine within this thread
+  geventListenerInit(&olv_display_listener);
+  geventAttachSource(&olv_display_listener, olv_gesture_source(), GLISTEN_GESTURE_ALL);
+  geventRegisterCallback(&olv_display_listener, olv_display_gesture, NULL);
 
-      if (ev->enabled) { 
+  olv_gesture_box_init(&olv_menu_box, GLISTEN_GESTURE_PRESS | GLISTEN_GESTURE_REPEAT | GLISTEN_GESTURE_CHORD, &olv_event[OLV_EVENT_MENU]);
 
-        if (ev->ttn <= olv_event_time) {
-          ev->ttn = ((olv_event_func)ev->func)() +olv_event_time;
-        }
+  geventListenerInit(&olv_debug_listener);
+  geventAttachSource(&olv_debug_listener, olv_gesture_source(), GLISTEN_GESTURE_PRESS | GLISTEN_GESTURE_RELEASE | GLISTEN_GESTURE_CHORD);
+  geventRegisterCallback(&olv_debug_listener, olv_debug_gesture, NULL);
 
-        if (ev->ttn < smallest) smallest = ev->ttn;
+  // the watch starts with the display off, releasing the power button wakes it
+  gdispControl(GDISP_CONTROL_POWER, powerOff);
+  olv_ev_at(&olv_event[OLV_EVENT_BUTTON], olv_event_time);
 
-      }
+  // runs due events and sleeps until the next deadline, the render event flushes the framebuffer
+  olv_ev_run(NULL);
 
-    }
-
-    framebuffer_draw();
-
-    smallest = smallest -olv_event_time;
-    
-    /*if (smallest > 200 && SDU1.config->usbp->state != USB_ACTIVE) {
-      chSysSuspend();
-      chThdSleep(smallest);
-      chSysEnable();
-    } else {*/
-    chThdSleep(smallest < 10 ? 10 : smallest);
-    //}
-  }
   return 1;
 };
 
 // =======================================
 
 int main(void) {
-	Thread *shelltp = NULL;
 
 	halInit();
 	chSysInit();
+  // main is a thread now, its stack is not behind it
+  olv_perf_init();
 
 	/* partial remap tim3 */
 	AFIO->MAPR |= AFIO_MAPR_TIM3_REMAP_1;
@@ -332,8 +383,22 @@ int main(void) {
 	pwmStart(&PWMD3, &pwm3_cfg);
 	pwmStart(&PWMD5, &pwm5_cfg);
 
+  // the records of the isrs are kept until "log" drains them
+  olv_log_start();
+
 	sduObjectInit(&SDU1);
 	sduStart(&SDU1, &serusbcfg);
+  // waits for the usb configured event
+  usb_shell_start();
+  // the assets in flash, before the mass storage view of them shows up
+  olv_asset_start();
+  // the vendor bulk or the mass storage interface, configured along with
+  // the serial port
+#if OLV_USE_MSC
+  olv_msc_start();
+#else
+  olv_bulk_start();
+#endif
 
 	usbDisconnectBus(serusbcfg.usbp);
 
@@ -345,9 +410,14 @@ int main(void) {
 
 	i2cStart(&I2CD1, &i2c1_cfg);
 
-	extStart(&EXTD1, &ext_cfg);
+  // the rtc kept counting through the reset
+  olv_time_start();
+
+  olv_i2c_start();
+  // the expander interrupt is enabled by extStart
+  olv_input_start(&olv_event[OLV_EVENT_BUTTON]);
 
-	shellInit();
+	extStart(&EXTD1, &ext_cfg);
 
 	gdispInit();
 	gdispSetOrientation(GDISP_ROTATE_90);
@@ -357,15 +427,8 @@ int main(void) {
 
   (void)chThdCreateStatic(olvThreadWorkplace, sizeof(olvThreadWorkplace), HIGHPRIO, olvThread, NULL);
 
-	while (TRUE) {
-		if (!shelltp && (SDU1.config->usbp->state == USB_ACTIVE))
-			shelltp = shellCreate(&shell_cfg1, SHELL_WA_SIZE, NORMALPRIO);
-		else if (chThdTerminated(shelltp)) {
-			chThdRelease(shelltp);
-			shelltp = NULL;
-		};
-
-		chThdSleepMilliseconds(1000);
-	};
+  // the shell comes and goes with the usb events
+	while (TRUE)
+		chThdSleep(TIME_INFINITE);
 };
 
@@ -0,0 +1,202 @@
+
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+
+#include "olv_rpc/frame.h"
+#include "asset.h"
+
+#define OLV_ASSET_KEY1 0x45670123
+#define OLV_ASSET_KEY2 0xCDEF89AB
+
+// the region of the linker script
+extern uint8_t __assets_start__[], __assets_end__[];
+
+olv_asset_stats olv_asset = {0};
+
+static uint8_t olv_asset_valid;
+
+// the upload
+static uint32_t olv_asset_size, olv_asset_done;
+static uint8_t olv_asset_magic[4];
+static systime_t olv_asset_started;
+
+size_t olv_asset_capacity (void) {
+  return (size_t)(__assets_end__ -__assets_start__);
+};
+
+// all but the magic, which an upload writes after this
+static bool_t olv_asset_check (void) {
+
+  const olv_asset_header* h = (const olv_asset_header*)__assets_start__;
+  const olv_asset_entry* e = (const olv_asset_entry*)(h +1);
+  uint16_t i;
+
+  if (h->version != OLV_ASSET_VERSION || h->size > olv_asset_capacity() ||
+      sizeof(*h) +(uint32_t)h->count *sizeof(*e) > h->size) return FALSE;
+
+  for (i = 0; i < h->count; i++)
+    if ((e[i].offset & 3) || e[i].offset > h->size || e[i].size > h->size -e[i].offset) return FALSE;
+
+  return olv_frame_crc(0xFFFF, __assets_start__ +sizeof(*h), h->size -sizeof(*h)) == h->crc;
+};
+
+void olv_asset_start (void) {
+  olv_asset_valid = !memcmp(__assets_start__, "OLVA", 4) && olv_asset_check();
+};
+
+const olv_asset_header* olv_asset_pack (void) {
+  return olv_asset_valid ? (const olv_asset_header*)__assets_start__ : NULL;
+};
+
+const uint8_t* olv_asset_find (const char* name, uint8_t type, size_t* size) {
+
+  const olv_asset_header* h = olv_asset_pack();
+  const olv_asset_entry* e;
+  uint16_t i;
+
+  if (!h) return NULL;
+
+  e = (const olv_asset_entry*)(h +1);
+  for (i = 0; i < h->count; i++, e++) {
+    if (e->type != type || strncmp(e->name, name, OLV_ASSET_NAME)) continue;
+    if (size) *size = e->size;
+    return (const uint8_t*)h +e->offset;
+  }
+
+  return NULL;
+};
+
+bool_t olv_asset_image (const char* name, struct image* img) {
+
+  size_t n;
+  const uint8_t* p = olv_asset_find(name, OLV_ASSET_IMAGE, &n);
+  const uint16_t* w = (const uint16_t*)p;
+
+  if (!p || n < 8 || !w[2] || 8 +(size_t)w[3] *4 > n) return FALSE;
+
+  img->width = w[0];
+  img->height = w[1];
+  img->syncRows = w[2];
+  img->syncCount = w[3];
+  img->syncTable = (const uint32_t*)(p +8);
+  img->data = p +8 +(size_t)w[3] *4;
+
+  return TRUE;
+};
+
+// ---- flash ----
+
+// FALSE on an error of the operation
+static bool_t olv_asset_wait (void) {
+
+  uint32_t sr;
+
+  while (FLASH->SR & FLASH_SR_BSY);
+  sr = FLASH->SR;
+  FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+
+  return !(sr & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR));
+};
+
+// the core stalls on its next fetch from flash until the page is erased,
+// about 20 ms, interrupts included: vectors and handlers are in flash.
+// the usb peripheral answers the host on its own meanwhile, it naks every
+// endpoint that is not armed and the host polls again, well within the
+// seconds of its bulk and control timeouts. no endpoint is isochronous.
+// the systick interrupt pends once, the other ticks of the stall are lost
+// and chTimeNow() falls behind by about 19 ms per page, 32 pages for a
+// whole pack. the wall clock is the rtc and keeps counting.
+static bool_t olv_asset_erase (uint8_t* page) {
+
+  bool_t ok;
+
+  FLASH->CR |= FLASH_CR_PER;
+  FLASH->AR = (uint32_t)page;
+  FLASH->CR |= FLASH_CR_STRT;
+  ok = olv_asset_wait();
+  FLASH->CR &= ~FLASH_CR_PER;
+
+  olv_asset.pages++;
+  return ok;
+};
+
+// by halfwords, the erased ones are skipped
+static bool_t olv_asset_program (uint8_t* dst, const uint8_t* src, size_t n) {
+
+  volatile uint16_t* d = (volatile uint16_t*)dst;
+  bool_t ok = TRUE;
+  uint16_t v;
+
+  FLASH->CR |= FLASH_CR_PG;
+  for (; n >= 2 && ok; n -= 2, src += 2, d++) {
+    v = (uint16_t)(src[0] | src[1] << 8);
+    if (v == 0xFFFF) continue;
+    *d = v;
+    ok = olv_asset_wait() && *d == v;
+  }
+  FLASH->CR &= ~FLASH_CR_PG;
+
+  return ok;
+};
+
+static int olv_asset_fail (void) {
+
+  FLASH->CR |= FLASH_CR_LOCK;
+  olv_asset.loading = 0;
+  olv_asset.errors++;
+
+  return -1;
+};
+
+// the block at olv_asset_done, from byte from on
+static int olv_asset_block (const uint8_t* block, size_t from) {
+
+  uint8_t* dst = __assets_start__ +olv_asset_done;
+
+  if (olv_asset_done % OLV_ASSET_PAGE == 0 && !olv_asset_erase(dst)) return olv_asset_fail();
+  if (!olv_asset_program(dst +from, block +from, OLV_ASSET_BLOCK -from)) return olv_asset_fail();
+
+  olv_asset_done += OLV_ASSET_BLOCK;
+  if (olv_asset_done < olv_asset_size) return 1;
+
+  // the whole pack is in flash, it counts once the magic is
+  if (!olv_asset_check() || !olv_asset_program(__assets_start__, olv_asset_magic, 4)) return olv_asset_fail();
+  FLASH->CR |= FLASH_CR_LOCK;
+
+  olv_asset.loading = 0;
+  olv_asset.uploads++;
+  olv_asset.generation++;
+  olv_asset.upload_ms = (unsigned long)(chTimeNow() -olv_asset_started) *1000 /CH_FREQUENCY;
+  olv_asset_valid = 1;
+
+  return 0;
+};
+
+int olv_asset_begin (const uint8_t* block) {
+
+  olv_asset_header h;
+
+  // the block may not be aligned
+  memcpy(&h, block, sizeof(h));
+  if (memcmp(h.magic, "OLVA", 4) || h.version != OLV_ASSET_VERSION || h.size < sizeof(h) ||
+      h.size > olv_asset_capacity()) return -1;
+
+  olv_asset_valid = 0;
+  olv_asset.loading = 1;
+  olv_asset_size = h.size;
+  olv_asset_done = 0;
+  olv_asset_started = chTimeNow();
+  memcpy(olv_asset_magic, block, 4);
+
+  if (FLASH->CR & FLASH_CR_LOCK) {
+    FLASH->KEYR = OLV_ASSET_KEY1;
+    FLASH->KEYR = OLV_ASSET_KEY2;
+  }
+
+  return olv_asset_block(block, 4);
+};
+
+int olv_asset_write (const uint8_t* block) {
+  return olv_asset.loading ? olv_asset_block(block, 0) : -1;
+};
@@ -0,0 +1,88 @@
+
+#ifndef OLV_ASSET
+#define OLV_ASSET
+
+// assets in a flash region of their own, replaced at run time.
+//
+// the linker script keeps 64 kB below the hardware info free of code,
+// __assets_start__ to __assets_end__. it holds one pack, built on the host
+// with tools/assetpack:
+//   header   "OLVA" version:u16 count:u16 size:u32 crc:u16 0:u16
+//   entries  count times name:12 chars, zero padded, type:u8 0 0 0
+//            offset:u32 size:u32
+//   payloads each at a multiple of 4 from the start of the pack
+// numbers little endian. size is the whole pack, crc the olv_frame_crc()
+// of the bytes after the header. an image payload is
+//   width:u16 height:u16 syncRows:u16 syncCount:u16 syncTable:syncCount u32
+//   data
+// written by "qimg bin", so that olv_asset_image() points a struct image
+// into the flash and gdispDrawImage() draws it from there.
+//
+// olv_asset_begin() and olv_asset_write() replace the pack while the watch
+// runs, OLV_ASSET_BLOCK bytes at a time, erasing a page as the first block
+// of it arrives. the magic is written last, after the crc was checked, so
+// a pack cut short by a reset or a broken one is never taken. olv_msc is
+// the usual writer. meanwhile olv_asset_find() returns NULL, afterwards the
+// new assets are there at once: pointers taken before are stale once
+// generation changed.
+
+#include "ch.h"
+#include "hal.h"
+#include "gdisp/image.h"
+
+#define OLV_ASSET_VERSION 1
+#define OLV_ASSET_NAME 12
+
+#define OLV_ASSET_RAW 0
+#define OLV_ASSET_IMAGE 1
+
+// the flash page of the stm32f103 high density parts
+#define OLV_ASSET_PAGE 2048
+#define OLV_ASSET_BLOCK 512
+
+typedef struct {
+  char magic[4];
+  uint16_t version;
+  uint16_t count;
+  uint32_t size;
+  uint16_t crc;
+  uint16_t reserved;
+} olv_asset_header;
+
+typedef struct {
+  char name[OLV_ASSET_NAME];
+  uint8_t type;
+  uint8_t reserved[3];
+  uint32_t offset;
+  uint32_t size;
+} olv_asset_entry;
+
+typedef struct {
+  unsigned long generation; // packs taken since the start
+  unsigned long uploads;
+  unsigned long errors;     // broken packs, flash errors
+  unsigned long pages;      // erased
+  unsigned long upload_ms;  // the last upload
+  uint8_t loading;
+} olv_asset_stats;
+
+extern olv_asset_stats olv_asset;
+
+// checks the pack in flash, before anything looks up an asset
+void olv_asset_start (void);
+
+// the pack when it is valid, else NULL
+const olv_asset_header* olv_asset_pack (void);
+size_t olv_asset_capacity (void);
+
+const uint8_t* olv_asset_find (const char* name, uint8_t type, size_t* size);
+bool_t olv_asset_image (const char* name, struct image* img);
+
+// the upload, from one thread. begin takes the first block, write the
+// following ones in order. both return 1 while more blocks are expected,
+// 0 once the pack is in place and -1 when the upload failed, begin also
+// when the block is no pack header.
+int olv_asset_begin (const uint8_t* block);
+int olv_asset_write (const uint8_t* block);
+
+#endif
@@ -0,0 +1,280 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "bulk.h"
+
+// a test gives up when the host is quiet for so long
+#define OLV_BULK_STALL MS2ST(1000)
+
+olv_bulk_stats olv_bulk = {0};
+
+static void olv_bulk_in (USBDriver* usbp, usbep_t ep);
+static void olv_bulk_out (USBDriver* usbp, usbep_t ep);
+
+static USBInEndpointState olv_bulk_in_state;
+static USBOutEndpointState olv_bulk_out_state;
+
+static const USBEndpointConfig olv_bulk_in_cfg = {
+  USB_EP_MODE_TYPE_BULK,
+  NULL,
+  olv_bulk_in,
+  NULL,
+  OLV_BULK_PACKET,
+  0x0000,
+  &olv_bulk_in_state,
+  NULL,
+  1,
+  NULL
+};
+
+static const USBEndpointConfig olv_bulk_out_cfg = {
+  USB_EP_MODE_TYPE_BULK,
+  NULL,
+  NULL,
+  olv_bulk_out,
+  0x0000,
+  OLV_BULK_PACKET,
+  NULL,
+  &olv_bulk_out_state,
+  2,
+  NULL
+};
+
+static USBDriver* olv_bulk_usbp = NULL;
+
+// both directions are rings of two buffers, used in turn
+static uint8_t olv_bulk_tx[2][OLV_BULK_BUFFER];
+static size_t olv_bulk_tx_len[2];
+static uint8_t olv_bulk_tx_get, olv_bulk_tx_usb, olv_bulk_tx_queued;
+static Semaphore olv_bulk_tx_free;
+
+static uint8_t olv_bulk_rx[2][OLV_BULK_BUFFER];
+static size_t olv_bulk_rx_len[2];
+static uint8_t olv_bulk_rx_get, olv_bulk_rx_usb, olv_bulk_rx_held;
+static Semaphore olv_bulk_rx_filled;
+
+static WORKING_AREA(olvBulkWorkplace, 256);
+
+// locked
+static void olv_bulk_tx_startI (void) {
+
+  if (!olv_bulk_tx_queued || !olv_bulk_usbp || usbGetDriverStateI(olv_bulk_usbp) != USB_ACTIVE ||
+      usbGetTransmitStatusI(olv_bulk_usbp, OLV_BULK_IN_EP)) return;
+
+  usbPrepareTransmit(olv_bulk_usbp, OLV_BULK_IN_EP, olv_bulk_tx[olv_bulk_tx_usb], olv_bulk_tx_len[olv_bulk_tx_usb]);
+  usbStartTransmitI(olv_bulk_usbp, OLV_BULK_IN_EP);
+};
+
+// locked, a buffer receives while the thread holds fewer than two
+static void olv_bulk_rx_startI (void) {
+
+  if (olv_bulk_rx_held >= 2 || !olv_bulk_usbp || usbGetDriverStateI(olv_bulk_usbp) != USB_ACTIVE ||
+      usbGetReceiveStatusI(olv_bulk_usbp, OLV_BULK_OUT_EP)) return;
+
+  usbPrepareReceive(olv_bulk_usbp, OLV_BULK_OUT_EP, olv_bulk_rx[olv_bulk_rx_usb], OLV_BULK_BUFFER);
+  usbStartReceiveI(olv_bulk_usbp, OLV_BULK_OUT_EP);
+};
+
+static void olv_bulk_in (USBDriver* usbp, usbep_t ep) {
+  (void)ep;
+
+  olv_bulk.sent += usbp->epc[OLV_BULK_IN_EP]->in_state->txcnt;
+
+  chSysLockFromIsr();
+  olv_bulk_tx_usb ^= 1;
+  olv_bulk_tx_queued--;
+  chSemSignalI(&olv_bulk_tx_free);
+  olv_bulk_tx_startI();
+  chSysUnlockFromIsr();
+};
+
+static void olv_bulk_out (USBDriver* usbp, usbep_t ep) {
+  (void)ep;
+
+  olv_bulk_rx_len[olv_bulk_rx_usb] = usbp->epc[OLV_BULK_OUT_EP]->out_state->rxcnt;
+  olv_bulk.received += olv_bulk_rx_len[olv_bulk_rx_usb];
+
+  chSysLockFromIsr();
+  olv_bulk_rx_usb ^= 1;
+  olv_bulk_rx_held++;
+  chSemSignalI(&olv_bulk_rx_filled);
+  olv_bulk_rx_startI();
+  chSysUnlockFromIsr();
+};
+
+void olv_bulk_configureI (USBDriver* usbp) {
+
+  olv_bulk_usbp = usbp;
+  usbInitEndpointI(usbp, OLV_BULK_IN_EP, &olv_bulk_in_cfg);
+  usbInitEndpointI(usbp, OLV_BULK_OUT_EP, &olv_bulk_out_cfg);
+
+  // whatever was queued before is gone with the reset
+  olv_bulk_tx_get = olv_bulk_tx_usb = olv_bulk_tx_queued = 0;
+  chSemResetI(&olv_bulk_tx_free, 2);
+
+  olv_bulk_rx_get = olv_bulk_rx_usb = olv_bulk_rx_held = 0;
+  chSemResetI(&olv_bulk_rx_filled, 0);
+  olv_bulk_rx_startI();
+};
+
+uint8_t* olv_bulk_get (systime_t timeout) {
+
+  uint8_t* buf;
+
+  chSysLock();
+  if (chSemWaitTimeoutS(&olv_bulk_tx_free, timeout) != RDY_OK) {
+    chSysUnlock();
+    return NULL;
+  }
+  buf = olv_bulk_tx[olv_bulk_tx_get];
+  olv_bulk_tx_get ^= 1;
+  chSysUnlock();
+
+  return buf;
+};
+
+void olv_bulk_send (uint8_t* buf, size_t n) {
+
+  chSysLock();
+  olv_bulk_tx_len[buf == olv_bulk_tx[1]] = n;
+  olv_bulk_tx_queued++;
+  olv_bulk_tx_startI();
+  chSysUnlock();
+};
+
+bool_t olv_bulk_flush (systime_t timeout) {
+
+  uint8_t k = 0;
+
+  // both buffers free means nothing is queued
+  while (k < 2 && chSemWaitTimeout(&olv_bulk_tx_free, timeout) == RDY_OK) k++;
+  while (k--) chSemSignal(&olv_bulk_tx_free);
+
+  return olv_bulk_tx_queued == 0;
+};
+
+uint8_t* olv_bulk_receive (size_t* n, systime_t timeout) {
+
+  uint8_t* buf;
+
+  chSysLock();
+  if (chSemWaitTimeoutS(&olv_bulk_rx_filled, timeout) != RDY_OK) {
+    chSysUnlock();
+    return NULL;
+  }
+  buf = olv_bulk_rx[olv_bulk_rx_get];
+  *n = olv_bulk_rx_len[olv_bulk_rx_get];
+  olv_bulk_rx_get ^= 1;
+  chSysUnlock();
+
+  return buf;
+};
+
+void olv_bulk_release (uint8_t* buf) {
+  (void)buf;
+
+  chSysLock();
+  if (olv_bulk_rx_held) olv_bulk_rx_held--;
+  olv_bulk_rx_startI();
+  chSysUnlock();
+};
+
+// ---- the throughput test ----
+
+static unsigned long olv_bulk_u32 (const uint8_t* p) {
+  return (unsigned long)p[0] | (unsigned long)p[1] << 8 | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+};
+
+static void olv_bulk_put_u32 (uint8_t* p, unsigned long v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+};
+
+// the buffers are sent as they are, the host only counts
+static unsigned long olv_bulk_test_in (unsigned long n) {
+
+  unsigned long done = 0;
+  uint8_t* buf;
+  size_t k;
+
+  while (done < n && (buf = olv_bulk_get(OLV_BULK_STALL)) != NULL) {
+    k = n -done > OLV_BULK_BUFFER ? OLV_BULK_BUFFER : n -done;
+    olv_bulk_send(buf, k);
+    done += k;
+  }
+
+  return olv_bulk_flush(OLV_BULK_STALL) ? done : 0;
+};
+
+static unsigned long olv_bulk_test_out (unsigned long n) {
+
+  unsigned long done = 0;
+  uint8_t* buf;
+  size_t k;
+
+  while (done < n && (buf = olv_bulk_receive(&k, OLV_BULK_STALL)) != NULL) {
+    olv_bulk_release(buf);
+    done += k;
+  }
+
+  return done;
+};
+
+static msg_t olvBulkThread (void *arg) {
+  (void)arg;
+
+  uint8_t* buf;
+  size_t n;
+  char cmd;
+  unsigned long len, done;
+  systime_t start;
+
+  chRegSetThreadName("bulk");
+
+  while (TRUE) {
+    if ((buf = olv_bulk_receive(&n, TIME_INFINITE)) == NULL) continue;
+
+    cmd = n >= 7 && buf[0] == 'O' && buf[1] == 'B' ? (char)buf[2] : 0;
+    len = n >= 7 ? olv_bulk_u32(buf +3) : 0;
+    olv_bulk_release(buf);
+
+    start = chTimeNow();
+    if (cmd == 'I') done = olv_bulk_test_in(len);
+    else if (cmd == 'O') done = olv_bulk_test_out(len);
+    else {
+      olv_bulk.errors++;
+      continue;
+    }
+    if (done != len) olv_bulk.errors++;
+
+    olv_bulk.test = cmd;
+    olv_bulk.test_bytes = done;
+    olv_bulk.test_ms = (unsigned long)(chTimeNow() -start) *1000 /CH_FREQUENCY;
+
+    if ((buf = olv_bulk_get(OLV_BULK_STALL)) == NULL) continue;
+    buf[0] = 'O';
+    buf[1] = 'B';
+    buf[2] = (uint8_t)cmd;
+    olv_bulk_put_u32(buf +3, olv_bulk.test_ms);
+    olv_bulk_put_u32(buf +7, done);
+    olv_bulk_send(buf, 11);
+  }
+
+  return 0;
+};
+
+void olv_bulk_init (void) {
+
+  chSemInit(&olv_bulk_tx_free, 2);
+  chSemInit(&olv_bulk_rx_filled, 0);
+};
+
+void olv_bulk_start (void) {
+
+  olv_bulk_init();
+
+  (void)chThdCreateStatic(olvBulkWorkplace, sizeof(olvBulkWorkplace), NORMALPRIO, olvBulkThread, NULL);
+};
@@ -0,0 +1,74 @@
+
+#ifndef OLV_BULK
+#define OLV_BULK
+
+// vendor specific bulk interface next to the serial port of the shell.
+//
+// interface 2 of the composite device has a bulk in and a bulk out
+// endpoint of 64 byte packets. the out endpoint is double buffered in the
+// packet memory, so the host is not held up while the interrupt copies a
+// packet. the in endpoint has a single buffer, the room for a second one
+// keeps the serial port at 64 byte packets for stream and push. data
+// goes by buffers of OLV_BULK_BUFFER bytes, each one transfer straight
+// from or into the buffer, without the queues of the serial driver:
+//
+//   in:  olv_bulk_get() hands out a free buffer, olv_bulk_send() queues it.
+//        the buffers go out in the order they were handed out, the next
+//        transfer starts from the interrupt of the last one. a sent
+//        buffer is free again.
+//   out: the buffers receive in turn while they are free, a transfer ends
+//        with a short packet or a full buffer. olv_bulk_receive() returns
+//        the next one received, olv_bulk_release() gives it back.
+//
+// a usb reset drops what is queued, calls waiting meanwhile return NULL.
+//
+// the bulk thread answers a throughput test, tools/bulkbench is the host
+// side. a command is a short transfer of one packet:
+//   'O' 'B' 'I' n:u32   the watch sends n bytes
+//   'O' 'B' 'O' n:u32   the host sends n bytes, the watch drops them
+// numbers are little endian. after the data the watch answers with
+//   'O' 'B' cmd ms:u32 bytes:u32
+// the time it took and the bytes it sent or received.
+//
+// with OLV_USE_MSC the interface is olv_msc/msc.h instead, on the same
+// endpoints and buffers.
+
+#include "ch.h"
+#include "hal.h"
+
+#define OLV_BULK_INTERFACE 2
+#define OLV_BULK_IN_EP 3
+#define OLV_BULK_OUT_EP 4
+#define OLV_BULK_PACKET 64
+
+#define OLV_BULK_BUFFER 512
+
+typedef struct {
+  unsigned long sent;       // bytes
+  unsigned long received;   // bytes
+  unsigned long errors;     // unknown commands, stalled tests
+  unsigned long test_bytes; // the last test
+  unsigned long test_ms;
+  char test;                // 'I', 'O' or 0
+} olv_bulk_stats;
+
+extern olv_bulk_stats olv_bulk;
+
+// before usbStart()
+void olv_bulk_start (void);
+// the same without the test thread, for another protocol on the buffers
+void olv_bulk_init (void);
+
+// from usb_event() on USB_EVENT_CONFIGURED, locked
+void olv_bulk_configureI (USBDriver* usbp);
+
+uint8_t* olv_bulk_get (systime_t timeout);
+// n from 1 to OLV_BULK_BUFFER
+void olv_bulk_send (uint8_t* buf, size_t n);
+// until every queued buffer is sent
+bool_t olv_bulk_flush (systime_t timeout);
+
+uint8_t* olv_bulk_receive (size_t* n, systime_t timeout);
+void olv_bulk_release (uint8_t* buf);
+
+#endif
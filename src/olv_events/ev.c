@@ -0,0 +1,245 @@
+
+// tools/evsim builds this file on the host with its own ChibiOS stand-ins
+#ifndef OLV_EV_HOST
+#include "ch.h"
+#include "hal.h"
+
+// the profiles are measured with the hal realtime counter (dwt cycle counter on the m3)
+#define olv_ev_cycles() halGetCounterValue()
+#define olv_ev_us(cycles) RTT2US(cycles)
+#endif
+
+#include "ev.h"
+
+unsigned long olv_event_time;
+unsigned long olv_ev_wakeups = 0;
+unsigned long olv_ev_runs = 0;
+olv_event_pool* olv_ev_list = NULL;
+
+static olv_event_pool* olv_ev_heap[OLV_EV_MAX];
+static uint8_t olv_ev_count = 0;
+static Thread* olv_ev_thread = NULL;
+static olv_event_pool* olv_ev_last = NULL;
+
+#define OLV_EV_WAKE EVENT_MASK(0)
+
+// deadlines are compared by their difference so the tick counter may wrap
+static int olv_ev_before (olv_event_pool* a, olv_event_pool* b) {
+  long d = (long)(a->ttn -b->ttn);
+  return d < 0 || (d == 0 && a->prio < b->prio);
+};
+
+static void olv_ev_place (olv_event_pool* ev, uint8_t i) {
+  olv_ev_heap[i] = ev;
+  ev->slot = i;
+};
+
+static void olv_ev_up (uint8_t i) {
+  olv_event_pool* ev = olv_ev_heap[i];
+  uint8_t parent;
+
+  while (i > 0) {
+    parent = (i -1) /2;
+    if (!olv_ev_before(ev, olv_ev_heap[parent])) break;
+    olv_ev_place(olv_ev_heap[parent], i);
+    i = parent;
+  }
+  olv_ev_place(ev, i);
+};
+
+static void olv_ev_down (uint8_t i) {
+  olv_event_pool* ev = olv_ev_heap[i];
+  uint8_t child;
+
+  while ((child = i *2 +1) < olv_ev_count) {
+    if (child +1 < olv_ev_count && olv_ev_before(olv_ev_heap[child +1], olv_ev_heap[child])) child++;
+    if (!olv_ev_before(olv_ev_heap[child], ev)) break;
+    olv_ev_place(olv_ev_heap[child], i);
+    i = child;
+  }
+  olv_ev_place(ev, i);
+};
+
+// takes an event out of the heap, must be called locked
+static void olv_ev_unlink (olv_event_pool* ev) {
+  uint8_t i = ev->slot;
+
+  ev->slot = OLV_EV_SLOT_NONE;
+  if (--olv_ev_count == i) return;
+
+  // move the last event into the hole and restore the heap order
+  olv_ev_place(olv_ev_heap[olv_ev_count], i);
+  olv_ev_up(i);
+  olv_ev_down(olv_ev_heap[i]->slot);
+};
+
+// the latest wake-up within the slack of every event, the heap must not
+// be empty. locked. an event due after it can not pull it in, with at most
+// OLV_EV_MAX events a pass over all of them is cheaper than a second heap.
+static unsigned long olv_ev_wake (void) {
+  unsigned long wake = olv_ev_heap[0]->ttn +olv_ev_heap[0]->slack;
+  uint8_t i;
+
+  for (i = 1; i < olv_ev_count; i++)
+    if ((long)(olv_ev_heap[i]->ttn +olv_ev_heap[i]->slack -wake) < 0)
+      wake = olv_ev_heap[i]->ttn +olv_ev_heap[i]->slack;
+
+  return wake;
+};
+
+// puts an event into the heap, returns TRUE if the scheduler has to wake up
+// earlier for it. locked.
+static bool_t olv_ev_insert (olv_event_pool* ev, unsigned long ttn) {
+
+  bool_t earlier;
+
+  if (ev->slot < OLV_EV_MAX) olv_ev_unlink(ev);
+
+  // profiled events are listed in the order they were first scheduled
+  if (!ev->next && ev != olv_ev_last) {
+    if (olv_ev_last) olv_ev_last->next = ev;
+    else olv_ev_list = ev;
+    olv_ev_last = ev;
+  }
+
+  chDbgAssert(olv_ev_count < OLV_EV_MAX, "olv_ev_insert(), #1", "too many events");
+  if (olv_ev_count == OLV_EV_MAX) return FALSE;
+
+  earlier = !olv_ev_count || (long)(ttn +ev->slack -olv_ev_wake()) < 0;
+
+  ev->ttn = ttn;
+  olv_ev_place(ev, olv_ev_count++);
+  olv_ev_up(ev->slot);
+
+  return earlier;
+};
+
+// schedules an event at an absolute time, moving it if it is already scheduled
+void olv_ev_at (olv_event_pool* ev, unsigned long ttn) {
+
+  chSysLock();
+
+  // the sleeping scheduler has to recalculate its timeout if it wakes up too late for this event
+  if (olv_ev_insert(ev, ttn) && olv_ev_thread && chThdSelf() != olv_ev_thread) {
+    chEvtSignalI(olv_ev_thread, OLV_EV_WAKE);
+    chSchRescheduleS();
+  }
+
+  chSysUnlock();
+};
+
+// the same from an isr or locked code. an isr may have interrupted the
+// scheduler between reading its timeout and going to sleep, so it is
+// always woken up.
+void olv_ev_atI (olv_event_pool* ev, unsigned long ttn) {
+
+  if (olv_ev_insert(ev, ttn) && olv_ev_thread)
+    chEvtSignalI(olv_ev_thread, OLV_EV_WAKE);
+};
+
+// schedules an event to run after delay ms
+void olv_ev_add (olv_event_pool* ev, unsigned long delay) {
+  olv_ev_at(ev, (unsigned long)chTimeNow() +delay);
+};
+
+void olv_ev_remove (olv_event_pool* ev) {
+
+  chSysLock();
+
+  if (ev->slot < OLV_EV_MAX) olv_ev_unlink(ev);
+  // a running event is not in the heap, just forget its return value
+  else ev->slot = OLV_EV_SLOT_NONE;
+
+  chSysUnlock();
+};
+
+// wakes the scheduler so it runs everything that is due right away
+void olv_ev_signal (void) {
+  if (olv_ev_thread) chEvtSignal(olv_ev_thread, OLV_EV_WAKE);
+};
+
+void olv_ev_signalI (void) {
+  if (olv_ev_thread) chEvtSignalI(olv_ev_thread, OLV_EV_WAKE);
+};
+
+static void olv_ev_account (olv_ev_stats* s, unsigned long us, long late) {
+
+  if (late < 0) late = 0;
+
+  if (!s->runs || us < s->cost_min) s->cost_min = us;
+  if (us > s->cost_max) s->cost_max = us;
+  s->cost_sum += us;
+  if ((unsigned long)late > s->late_max) s->late_max = late;
+  s->late_sum += late;
+  s->runs++;
+};
+
+void olv_ev_reset (void) {
+
+  olv_event_pool* ev;
+
+  chSysLock();
+  for (ev = olv_ev_list; ev; ev = ev->next) {
+    ev->stats.runs = 0;
+    ev->stats.cost_min = ev->stats.cost_max = ev->stats.cost_sum = 0;
+    ev->stats.late_max = ev->stats.late_sum = 0;
+  }
+  chSysUnlock();
+};
+
+// runs the events forever. idle is called after every run of due events.
+void olv_ev_run (void (*idle)(void)) {
+
+  olv_event_pool* ev;
+  unsigned long next;
+  long wait, late;
+  uint32_t start;
+  uint8_t empty;
+
+  olv_ev_thread = chThdSelf();
+
+  for (;;) {
+    olv_event_time = (unsigned long)chTimeNow();
+    olv_ev_wakeups++;
+
+    chSysLock();
+    while (olv_ev_count && (long)(olv_ev_heap[0]->ttn -olv_event_time) <= 0) {
+      ev = olv_ev_heap[0];
+      olv_ev_unlink(ev);
+      ev->slot = OLV_EV_SLOT_RUNNING;
+      // the callback may reschedule itself, take the deadline before
+      late = (long)((unsigned long)chTimeNow() -ev->ttn);
+      chSysUnlock();
+
+      start = olv_ev_cycles();
+      next = ev->func();
+      olv_ev_account(&ev->stats, olv_ev_us(olv_ev_cycles() -start), late);
+      olv_ev_runs++;
+
+      chSysLock();
+      // the callback may have removed or rescheduled itself
+      if (ev->slot == OLV_EV_SLOT_RUNNING) {
+        ev->slot = OLV_EV_SLOT_NONE;
+        if (next != OLV_EV_STOP) {
+          chSysUnlock();
+          // a zero delay runs on the next pass instead of spinning in this one
+          olv_ev_at(ev, olv_event_time +(next ? next : 1));
+          chSysLock();
+        }
+      }
+    }
+    chSysUnlock();
+
+    if (idle) idle();
+
+    // sleep until the latest wake-up the slack allows or a signal
+    chSysLock();
+    empty = olv_ev_count == 0;
+    wait = empty ? 0 : (long)(olv_ev_wake() -(unsigned long)chTimeNow());
+    chSysUnlock();
+
+    if (empty) chEvtWaitAny(OLV_EV_WAKE);
+    else if (wait > 0) chEvtWaitAnyTimeout(OLV_EV_WAKE, (systime_t)wait);
+    else chEvtGetAndClearEvents(OLV_EV_WAKE);
+  }
+};
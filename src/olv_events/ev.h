@@ -2,14 +2,87 @@
 #ifndef OLV_EVENTS
 #define OLV_EVENTS
 
-typedef void (*olv_event_func)(olv_event_pool* evp);
+// deadline ordered event scheduler.
+//
+// events are kept in a binary min-heap ordered by their next deadline
+// (ties are broken by priority, lower runs first). the scheduler thread
+// runs everything that is due and then sleeps until the next deadline or
+// until olv_ev_signal() wakes it up.
+//
+// an event may allow to run up to its slack in ms late. the scheduler
+// then puts the wake-up off as far as the slack of every waiting event
+// allows, so one wake-up serves the deadlines that fall into it. events
+// without slack run at their deadline.
+//
+// a callback returns the delay in ms until it wants to run again, or
+// OLV_EV_STOP to be removed. events may add or remove any event
+// (including themselves) from within a callback.
 
+// maximum number of scheduled events
+#define OLV_EV_MAX 16
+
+// callback return value to not run again
+#define OLV_EV_STOP 0xFFFFFFFFUL
+
+// the event priorities, lower numbers run first on equal deadlines
+#define OLV_EV_PRIO_INPUT 0
+#define OLV_EV_PRIO_LOGIC 1
+#define OLV_EV_PRIO_DRAW 2
+
+typedef unsigned long (*olv_event_func)(void);
+
+// run time profile of an event, costs in us and lateness behind the deadline in ms
 typedef struct {
-  unsigned char id;
-  unsigned char enabled;
+  unsigned long runs;
+  unsigned long cost_min;
+  unsigned long cost_max;
+  unsigned long cost_sum;
+  unsigned long late_max;
+  unsigned long late_sum;
+} olv_ev_stats;
+
+typedef struct olv_event_pool olv_event_pool;
+
+struct olv_event_pool {
   olv_event_func func;
-  unsigned long ttn;
-} olv_event_pool;
+  unsigned long ttn;   // absolute time of the next run
+  uint8_t prio;
+  uint8_t slot;        // heap position, or one of the OLV_EV_SLOT_ states
+  uint16_t slack;      // ms it may run late
+  const char* name;
+  olv_event_pool* next;  // list of every event that was ever scheduled
+  olv_ev_stats stats;
+};
 
-#endif
+#define OLV_EV_SLOT_NONE 0xFF
+#define OLV_EV_SLOT_RUNNING 0xFE
+
+// static initializer of an unscheduled event, the profile is named after func
+#define OLV_EVENT(func, prio) OLV_EVENT_SLACK(func, prio, 0)
+#define OLV_EVENT_SLACK(func, prio, slack) {func, 0, prio, OLV_EV_SLOT_NONE, slack, #func, NULL, {0, 0, 0, 0, 0, 0}}
 
+// time of the current scheduler run, callbacks should use this instead of chTimeNow()
+extern unsigned long olv_event_time;
+
+// scheduler statistics
+extern unsigned long olv_ev_wakeups;
+extern unsigned long olv_ev_runs;
+
+// the first of the events that were ever scheduled, see next
+extern olv_event_pool* olv_ev_list;
+
+// clears the profiles of all events
+void olv_ev_reset (void);
+
+void olv_ev_add (olv_event_pool* ev, unsigned long delay);
+void olv_ev_at (olv_event_pool* ev, unsigned long ttn);
+void olv_ev_atI (olv_event_pool* ev, unsigned long ttn);
+void olv_ev_remove (olv_event_pool* ev);
+#define olv_ev_scheduled(ev) ((ev)->slot != OLV_EV_SLOT_NONE)
+
+void olv_ev_signal (void);
+void olv_ev_signalI (void);
+
+void olv_ev_run (void (*idle)(void));
+
+#endif
@@ -0,0 +1,77 @@
+
+#ifndef OLV_PT
+#define OLV_PT
+
+// stackless coroutines on the event scheduler.
+//
+// a coroutine is an ordinary scheduler event whose callback is written
+// between OLV_PT_BEGIN and OLV_PT_END. the waits below return from the
+// callback with the time to run again and the next run continues right
+// after the wait, so sequential app logic needs a few bytes of olv_pt
+// state instead of a thread and its stack:
+//
+//   static olv_pt blink_pt;
+//
+//   static unsigned long blink (void) {
+//     OLV_PT_BEGIN(&blink_pt);
+//     for (;;) {
+//       OLV_PT_WAIT_UNTIL(&blink_pt, olv_gesture_box_get(&box, &g));
+//       led_on();
+//       OLV_PT_SLEEP(&blink_pt, 100);
+//       led_off();
+//     }
+//     OLV_PT_END(&blink_pt);
+//   }
+//
+// the resume points are case labels of a switch (like protothreads), so:
+// - locals do not survive a wait, keep state in statics or a struct.
+// - a coroutine must not use switch itself, use if / else instead.
+// - a coroutine must not wait twice on the same source line.
+//
+// a waiting coroutine runs again when its deadline is due or when it is
+// scheduled with olv_ev_at() (eg. by an olv_gesture_box), a condition is
+// only looked at then. the callback takes no argument, so every coroutine
+// function has exactly one olv_pt.
+
+#include "olv_events/ev.h"
+
+typedef struct {
+  uint16_t lc;          // line to resume at, 0 is the start
+  uint8_t timeout;      // the last timed wait ended without its condition
+  unsigned long until;  // deadline of a timed wait
+} olv_pt;
+
+// restarts the coroutine from OLV_PT_BEGIN on its next run
+#define OLV_PT_INIT(pt) do { (pt)->lc = 0; (pt)->timeout = 0; } while (0)
+
+#define OLV_PT_BEGIN(pt) switch ((pt)->lc) { case 0:
+
+// the coroutine ended and is not run again, the next run starts it over
+#define OLV_PT_END(pt) } OLV_PT_INIT(pt); return OLV_EV_STOP
+
+// ends the coroutine from anywhere within it
+#define OLV_PT_EXIT(pt) do { OLV_PT_INIT(pt); return OLV_EV_STOP; } while (0)
+
+// runs again on the next pass of the scheduler
+#define OLV_PT_YIELD(pt) do { (pt)->lc = __LINE__; return 1; case __LINE__:; } while (0)
+
+// waits until cond is true, it is checked whenever the event is scheduled
+#define OLV_PT_WAIT_UNTIL(pt, cond) do { \
+    (pt)->lc = __LINE__; case __LINE__: \
+    if (!(cond)) return OLV_EV_STOP; \
+  } while (0)
+
+// waits until cond is true or for at most ms, OLV_PT_TIMED_OUT() tells which
+#define OLV_PT_WAIT_TIMEOUT(pt, cond, ms) do { \
+    (pt)->until = olv_event_time +(ms); \
+    (pt)->lc = __LINE__; case __LINE__: \
+    if (((pt)->timeout = !(cond)) && (long)((pt)->until -olv_event_time) > 0) \
+      return (pt)->until -olv_event_time; \
+  } while (0)
+
+#define OLV_PT_TIMED_OUT(pt) ((pt)->timeout)
+
+// sleeps for ms, also if the event is scheduled earlier
+#define OLV_PT_SLEEP(pt, ms) OLV_PT_WAIT_TIMEOUT(pt, 0, ms)
+
+#endif
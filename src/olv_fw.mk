@@ -1,2 +1,2 @@
-OLVSRC = ${SRC}/usb_hw.c ${SRC}/usb_shell.c ${SRC}/aclock/aclock.c ${SRC}/main.c
+OLVSRC = ${SRC}/usb_hw.c ${SRC}/usb_shell.c ${SRC}/aclock/aclock.c ${SRC}/olv_events/ev.c ${SRC}/olv_i2c/i2cq.c ${SRC}/olv_input/input.c ${SRC}/olv_input/gesture.c ${SRC}/olv_time/time.c ${SRC}/olv_render/render.c ${SRC}/olv_power/power.c ${SRC}/olv_stream/stream.c ${SRC}/olv_push/push.c ${SRC}/olv_bulk/bulk.c ${SRC}/olv_rpc/frame.c ${SRC}/olv_rpc/rpc.c ${SRC}/olv_perf/perf.c ${SRC}/olv_asset/asset.c ${SRC}/olv_msc/msc.c ${SRC}/olv_shell/session.c ${SRC}/olv_log/log.c ${SRC}/main.c
 OLVINC = ${SRC}/aclock ${SRC}
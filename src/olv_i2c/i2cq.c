@@ -0,0 +1,148 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "i2cq.h"
+
+olv_i2c_bus olv_i2c1;
+
+static WORKING_AREA(olvI2c1Workplace, OLV_I2C_STACK);
+
+// adds t to the queue, must be called locked
+bool_t olv_i2c_submitI (olv_i2c_bus* bus, olv_i2c_txn* t) {
+
+  // a transaction can only be queued once at a time
+  if (t->state == OLV_I2C_QUEUED || t->state == OLV_I2C_RUNNING) return FALSE;
+
+  t->next = NULL;
+  t->state = OLV_I2C_QUEUED;
+  t->queued = halGetCounterValue();
+
+  if (bus->tail) bus->tail->next = t;
+  else bus->head = t;
+  bus->tail = t;
+
+  chSemSignalI(&bus->sem);
+  return TRUE;
+};
+
+bool_t olv_i2c_submit (olv_i2c_bus* bus, olv_i2c_txn* t) {
+
+  bool_t queued;
+
+  chSysLock();
+  queued = olv_i2c_submitI(bus, t);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return queued;
+};
+
+static void olv_i2c_wake (olv_i2c_txn* t) {
+  chBSemSignal((BinarySemaphore*)t->arg);
+};
+
+msg_t olv_i2c_transfer (olv_i2c_bus* bus, olv_i2c_txn* t) {
+
+  BinarySemaphore done;
+
+  chDbgAssert(chThdSelf() != bus->thread, "olv_i2c_transfer(), #1", "called from the driver thread");
+  chDbgAssert(t->cb == NULL, "olv_i2c_transfer(), #2", "the transaction has a callback");
+
+  chBSemInit(&done, TRUE);
+
+  chSysLock();
+  // a transaction on its way is left alone
+  if (t->state == OLV_I2C_QUEUED || t->state == OLV_I2C_RUNNING) {
+    chSysUnlock();
+    return RDY_RESET;
+  }
+  t->cb = olv_i2c_wake;
+  t->arg = &done;
+  (void)olv_i2c_submitI(bus, t);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  chBSemWait(&done);
+
+  // done is gone on return
+  t->cb = NULL;
+  t->arg = NULL;
+
+  return t->result;
+};
+
+static void olv_i2c_run (olv_i2c_bus* bus, olv_i2c_txn* t) {
+
+  const I2CConfig* config;
+  uint32_t start;
+  unsigned long us;
+
+  start = halGetCounterValue();
+  us = RTT2US(start -t->queued);
+  if (us > bus->wait_max) bus->wait_max = us;
+
+  if (t->txbytes)
+    t->result = i2cMasterTransmitTimeout(bus->i2cp, t->addr, t->txbuf, t->txbytes, t->rxbuf, t->rxbytes, t->timeout);
+  else
+    t->result = i2cMasterReceiveTimeout(bus->i2cp, t->addr, t->rxbuf, t->rxbytes, t->timeout);
+
+  us = RTT2US(halGetCounterValue() -start);
+  if (us > bus->busy_max) bus->busy_max = us;
+  bus->busy_sum += us;
+  bus->done++;
+
+  t->errors = t->result == RDY_OK ? I2CD_NO_ERROR : i2cGetErrors(bus->i2cp);
+  if (t->result == RDY_RESET) bus->errors++;
+
+  // the driver is locked after a timeout and has to be restarted
+  if (t->result == RDY_TIMEOUT) {
+    bus->timeouts++;
+    config = bus->i2cp->config;
+    i2cStop(bus->i2cp);
+    i2cStart(bus->i2cp, config);
+  }
+};
+
+static msg_t olvI2cThread (void *arg) {
+
+  olv_i2c_bus* bus = arg;
+  olv_i2c_txn* t;
+
+  chRegSetThreadName("i2c");
+
+  for (;;) {
+    chSemWait(&bus->sem);
+
+    // keep the bus for everything that is queued
+    i2cAcquireBus(bus->i2cp);
+    bus->batches++;
+
+    do {
+      chSysLock();
+      t = bus->head;
+      bus->head = t->next;
+      if (!bus->head) bus->tail = NULL;
+      t->state = OLV_I2C_RUNNING;
+      chSysUnlock();
+
+      olv_i2c_run(bus, t);
+
+      t->state = OLV_I2C_DONE;
+      if (t->cb) t->cb(t);
+    } while (chSemWaitTimeout(&bus->sem, TIME_IMMEDIATE) == RDY_OK);
+
+    i2cReleaseBus(bus->i2cp);
+  }
+
+  return 0;
+};
+
+void olv_i2c_start (void) {
+
+  olv_i2c1.i2cp = &I2CD1;
+  olv_i2c1.head = olv_i2c1.tail = NULL;
+  chSemInit(&olv_i2c1.sem, 0);
+
+  olv_i2c1.thread = chThdCreateStatic(olvI2c1Workplace, sizeof(olvI2c1Workplace), HIGHPRIO, olvI2cThread, &olv_i2c1);
+};
@@ -0,0 +1,86 @@
+
+#ifndef OLV_I2CQ
+#define OLV_I2CQ
+
+// queued i2c transactions.
+//
+// callers fill a transaction descriptor and submit it to the queue of a
+// bus, from a thread or (olv_i2c_submitI) from an isr or timer callback.
+// a driver thread per bus runs the queue back to back on the dma driven
+// i2c driver while holding the bus once for the whole batch, then calls
+// the callback of every transaction from that thread. nobody but the
+// driver thread blocks on the bus.
+//
+// a transaction may be submitted again once its callback was called,
+// also from within the callback. code which does not go through the
+// queue may still use i2cAcquireBus() as before.
+
+// working area of a bus thread. the deepest path is a callback logging
+// with OLV_LOG while the thread sits on a dma transfer timing out, about
+// 300 bytes with the context switch and an exception frame, which did
+// not fit 256 once stack fill and the timeout path were in. "perf" shows
+// what is left after the input has been read a while.
+#define OLV_I2C_STACK 512
+
+#define OLV_I2C_IDLE 0
+#define OLV_I2C_QUEUED 1
+#define OLV_I2C_RUNNING 2
+#define OLV_I2C_DONE 3
+
+typedef struct olv_i2c_txn olv_i2c_txn;
+
+// called from the driver thread when the transaction ended, see result and errors
+typedef void (*olv_i2c_cb)(olv_i2c_txn* t);
+
+struct olv_i2c_txn {
+  olv_i2c_txn* next;
+  i2caddr_t addr;
+  const uint8_t* txbuf;  // txbytes == 0 receives only
+  size_t txbytes;
+  uint8_t* rxbuf;        // rxbytes == 0 transmits only
+  size_t rxbytes;
+  systime_t timeout;
+  olv_i2c_cb cb;
+  void* arg;
+  msg_t result;          // RDY_OK, RDY_RESET (see errors) or RDY_TIMEOUT
+  i2cflags_t errors;
+  uint32_t queued;       // cycle counter at submission
+  volatile uint8_t state;
+};
+
+// static initializer of an idle transaction with a 10 ms timeout
+#define OLV_I2C_TXN(addr, txbuf, txbytes, rxbuf, rxbytes, cb, arg) \
+  {NULL, addr, txbuf, txbytes, rxbuf, rxbytes, MS2ST(10), cb, arg, RDY_OK, I2CD_NO_ERROR, 0, OLV_I2C_IDLE}
+
+typedef struct {
+  I2CDriver* i2cp;
+  olv_i2c_txn* head;
+  olv_i2c_txn* tail;
+  Semaphore sem;         // one count per queued transaction
+  Thread* thread;
+
+  // statistics, times in us
+  unsigned long done;
+  unsigned long errors;
+  unsigned long timeouts;
+  unsigned long batches;     // bus acquisitions
+  unsigned long wait_max;    // submission to start
+  unsigned long busy_max;    // transfer time
+  unsigned long busy_sum;
+} olv_i2c_bus;
+
+// the bus manager of I2CD1
+extern olv_i2c_bus olv_i2c1;
+
+// starts the driver thread of I2CD1, i2cStart() must have been called
+void olv_i2c_start (void);
+
+bool_t olv_i2c_submit (olv_i2c_bus* bus, olv_i2c_txn* t);
+bool_t olv_i2c_submitI (olv_i2c_bus* bus, olv_i2c_txn* t);
+
+// submits t and waits for it, for code that can block. not from the driver
+// thread. t must not have a callback, the wait takes cb and arg and clears
+// them again.
+msg_t olv_i2c_transfer (olv_i2c_bus* bus, olv_i2c_txn* t);
+
+#endif
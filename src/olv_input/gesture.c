@@ -0,0 +1,234 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "gesture.h"
+
+// button states
+#define OLV_GESTURE_F_IGNORE 0x01     // held at start, no gestures until released
+#define OLV_GESTURE_F_LONG 0x02       // the long press was sent
+#define OLV_GESTURE_F_CHORD 0x04      // the press completed a chord
+#define OLV_GESTURE_F_MODIFIER 0x08   // held as part of a chord completed by another button
+
+typedef struct {
+  unsigned long down;    // isr time of the press
+  unsigned long next;    // deadline of the next repeat
+  uint16_t interval;     // current repeat interval
+  uint16_t count;
+  uint8_t flags;
+  uint8_t chord;
+} olv_gesture_button;
+
+unsigned long olv_gesture_events = 0;
+
+static const olv_gesture_config* olv_gesture_cfg;
+static const uint8_t* olv_gesture_chords;
+static uint8_t olv_gesture_chord_count = 0;
+
+static olv_gesture_button olv_gesture_btn[OLV_INPUT_COUNT];
+static uint8_t olv_gesture_bits = 0;
+
+#define OLV_GESTURE_DUE(t, until) ((long)((t) -(until)) <= 0)
+
+// sends a gesture of button i to every listener that asked for it
+static void olv_gesture_emit (uint8_t gesture, uint8_t i, unsigned long time) {
+
+  olv_gesture_button* b = &olv_gesture_btn[i];
+  GSourceListener* psl = NULL;
+  GEventGesture* pe;
+
+  olv_gesture_events++;
+
+  while ((psl = geventGetSourceListener(olv_gesture_source(), psl))) {
+    if (!(psl->listenflags & (1 << gesture))) continue;
+    // a listener without a callback that is not waiting misses it
+    if (!(pe = (GEventGesture*)geventGetEventBuffer(psl))) continue;
+
+    pe->type = GEVENT_GESTURE;
+    pe->instance = i;
+    pe->gesture = gesture;
+    pe->buttons = gesture == OLV_GESTURE_CHORD ? b->chord : olv_gesture_bits;
+    pe->count = b->count;
+    pe->time = time;
+    pe->held = time -b->down;
+    geventSendEvent(psl);
+  }
+};
+
+// sends the long presses and repeats due until the given time
+static void olv_gesture_timers (unsigned long until) {
+
+  const olv_gesture_config* cfg;
+  olv_gesture_button* b;
+  uint8_t i;
+
+  for (i = 0; i < OLV_INPUT_COUNT; i++) {
+    b = &olv_gesture_btn[i];
+    cfg = &olv_gesture_cfg[i];
+    if (!(olv_gesture_bits >> i & 1) || (b->flags & (OLV_GESTURE_F_IGNORE | OLV_GESTURE_F_MODIFIER))) continue;
+
+    if (cfg->long_ms && !(b->flags & OLV_GESTURE_F_LONG) && OLV_GESTURE_DUE(b->down +cfg->long_ms, until)) {
+      b->flags |= OLV_GESTURE_F_LONG;
+      olv_gesture_emit(OLV_GESTURE_LONG, i, b->down +cfg->long_ms);
+    }
+
+    if (cfg->repeat_ms && OLV_GESTURE_DUE(b->next, until)) {
+      b->count++;
+      olv_gesture_emit(b->flags & OLV_GESTURE_F_CHORD ? OLV_GESTURE_CHORD : OLV_GESTURE_REPEAT, i, b->next);
+
+      if (b->interval > cfg->repeat_min +cfg->repeat_step) b->interval -= cfg->repeat_step;
+      else b->interval = cfg->repeat_min;
+
+      // when running late, repeat from now on instead of catching up in a burst
+      b->next += b->interval;
+      if (OLV_GESTURE_DUE(b->next, until)) b->next = until +b->interval;
+    }
+  }
+};
+
+static void olv_gesture_press (uint8_t i, unsigned long time) {
+
+  olv_gesture_button* b = &olv_gesture_btn[i];
+  uint8_t c, m, j;
+
+  olv_gesture_bits |= 1 << i;
+
+  b->down = time;
+  b->interval = olv_gesture_cfg[i].repeat_ms;
+  b->next = time +b->interval;
+  b->count = 0;
+  b->flags = 0;
+  b->chord = 0;
+
+  for (c = 0; c < olv_gesture_chord_count; c++) {
+    m = olv_gesture_chords[c];
+    if ((m >> i & 1) && (olv_gesture_bits & m) == m) {
+      b->flags |= OLV_GESTURE_F_CHORD;
+      b->chord = m;
+      for (j = 0; j < OLV_INPUT_COUNT; j++)
+        if (j != i && (m >> j & 1)) olv_gesture_btn[j].flags |= OLV_GESTURE_F_MODIFIER;
+      break;
+    }
+  }
+
+  olv_gesture_emit(b->chord ? OLV_GESTURE_CHORD : OLV_GESTURE_PRESS, i, time);
+};
+
+static void olv_gesture_release (uint8_t i, unsigned long time) {
+
+  olv_gesture_button* b = &olv_gesture_btn[i];
+  uint8_t j;
+
+  olv_gesture_bits &= ~(1 << i);
+
+  // a chord falls apart when one of its buttons is released, the rest repeats as plain presses
+  for (j = 0; j < OLV_INPUT_COUNT; j++) {
+    if (olv_gesture_btn[j].chord >> i & 1) {
+      olv_gesture_btn[j].flags &= ~OLV_GESTURE_F_CHORD;
+      olv_gesture_btn[j].chord = 0;
+    }
+  }
+
+  if (!(b->flags & OLV_GESTURE_F_IGNORE)) olv_gesture_emit(OLV_GESTURE_RELEASE, i, time);
+  b->flags = 0;
+};
+
+unsigned long olv_gesture_run (void) {
+
+  unsigned long time, next = 0;
+  const olv_gesture_config* cfg;
+  olv_gesture_button* b;
+  uint8_t bits, changed, i, found = 0;
+
+  while (olv_input_get(&time, &bits)) {
+    olv_gesture_timers(time);
+
+    // releases first, so a press only completes a chord with buttons still held
+    changed = bits ^ olv_gesture_bits;
+    for (i = 0; i < OLV_INPUT_COUNT; i++)
+      if (changed & ~bits & (1 << i)) olv_gesture_release(i, time);
+    for (i = 0; i < OLV_INPUT_COUNT; i++)
+      if (changed & bits & (1 << i)) olv_gesture_press(i, time);
+  }
+
+  olv_gesture_timers(olv_event_time);
+
+  // sleep until the first long press or repeat
+  for (i = 0; i < OLV_INPUT_COUNT; i++) {
+    b = &olv_gesture_btn[i];
+    cfg = &olv_gesture_cfg[i];
+    if (!(olv_gesture_bits >> i & 1) || (b->flags & (OLV_GESTURE_F_IGNORE | OLV_GESTURE_F_MODIFIER))) continue;
+
+    if (cfg->long_ms && !(b->flags & OLV_GESTURE_F_LONG) && (!found || OLV_GESTURE_DUE(b->down +cfg->long_ms, next))) {
+      next = b->down +cfg->long_ms;
+      found = 1;
+    }
+    if (cfg->repeat_ms && (!found || OLV_GESTURE_DUE(b->next, next))) {
+      next = b->next;
+      found = 1;
+    }
+  }
+
+  if (!found) return OLV_EV_STOP;
+  return (long)(next -olv_event_time) > 0 ? next -olv_event_time : 1;
+};
+
+void olv_gesture_init (const olv_gesture_config* config, const uint8_t* chords, uint8_t chord_count) {
+
+  uint8_t i;
+
+  olv_gesture_cfg = config;
+  olv_gesture_chords = chords;
+  olv_gesture_chord_count = chord_count;
+
+  olv_gesture_bits = olv_input_bits;
+  for (i = 0; i < OLV_INPUT_COUNT; i++)
+    olv_gesture_btn[i].flags = (olv_gesture_bits >> i & 1) ? OLV_GESTURE_F_IGNORE : 0;
+};
+
+GSourceHandle olv_gesture_source (void) {
+  return (GSourceHandle)olv_gesture_btn;
+};
+
+// runs within the gesture engine in the scheduler thread
+static void olv_gesture_box_put (void *param, GEvent *pe) {
+
+  olv_gesture_box* box = (olv_gesture_box*)param;
+
+  if (box->count == OLV_GESTURE_BOX) {
+    box->dropped++;
+    return;
+  }
+  box->queue[(box->head +box->count++) %OLV_GESTURE_BOX] = *(GEventGesture*)pe;
+  olv_ev_at(box->ev, olv_event_time);
+};
+
+void olv_gesture_box_init (olv_gesture_box* box, unsigned flags, olv_event_pool* ev) {
+
+  box->ev = ev;
+  box->head = 0;
+  box->count = 0;
+  box->dropped = 0;
+
+  geventListenerInit(&box->gl);
+  geventAttachSource(&box->gl, olv_gesture_source(), flags);
+  geventRegisterCallback(&box->gl, olv_gesture_box_put, box);
+};
+
+bool_t olv_gesture_box_get (olv_gesture_box* box, GEventGesture* g) {
+
+  if (!box->count) return FALSE;
+
+  *g = box->queue[box->head];
+  box->head = (box->head +1) %OLV_GESTURE_BOX;
+  box->count--;
+  return TRUE;
+};
+
+uint8_t olv_gesture_held (void) {
+  return olv_gesture_bits;
+};
+
+unsigned long olv_gesture_down (uint8_t button) {
+  return olv_gesture_btn[button].down;
+};
@@ -0,0 +1,99 @@
+
+#ifndef OLV_GESTURE
+#define OLV_GESTURE
+
+// table driven button gestures.
+//
+// the gesture engine takes the timestamped button changes of olv_input and
+// turns them into press, release, long press, repeat and chord gestures
+// which are published as gevent source. handlers attach a listener with
+// the GLISTEN_GESTURE_ flags they want and get a GEventGesture for every
+// match, either by waiting or, within the scheduler thread, by callback.
+//
+// the engine is an event of the olv_events scheduler: olv_input schedules
+// it on every change and it schedules itself exactly at the next long
+// press or repeat deadline, so gesture timing does not depend on a poll
+// interval and nothing runs while no button is held.
+//
+// a press completing a chord (all buttons of a chord mask held) is sent
+// as OLV_GESTURE_CHORD instead of a press, its repeats are chords as well.
+// the other buttons of the chord act as modifiers and stop repeating.
+// buttons held when the engine starts are ignored until released.
+
+#include "gevent.h"
+#include "olv_events/ev.h"
+#include "olv_input/input.h"
+
+#define GEVENT_GESTURE (GEVENT_USER_FIRST +0)
+
+#define OLV_GESTURE_PRESS 0
+#define OLV_GESTURE_RELEASE 1
+#define OLV_GESTURE_LONG 2
+#define OLV_GESTURE_REPEAT 3
+#define OLV_GESTURE_CHORD 4
+
+// listen flags - passed to geventAttachSource()
+#define GLISTEN_GESTURE_PRESS (1 << OLV_GESTURE_PRESS)
+#define GLISTEN_GESTURE_RELEASE (1 << OLV_GESTURE_RELEASE)
+#define GLISTEN_GESTURE_LONG (1 << OLV_GESTURE_LONG)
+#define GLISTEN_GESTURE_REPEAT (1 << OLV_GESTURE_REPEAT)
+#define GLISTEN_GESTURE_CHORD (1 << OLV_GESTURE_CHORD)
+#define GLISTEN_GESTURE_ALL 0x1F
+
+typedef struct {
+  GEventType type;      // GEVENT_GESTURE
+  uint16_t instance;    // the button, for chords the one completing it
+  uint8_t gesture;      // one of OLV_GESTURE_
+  uint8_t buttons;      // buttons held, for chords the chord mask
+  uint16_t count;       // repeats of this press so far
+  unsigned long time;   // isr time of the change, or the deadline of a timed gesture
+  unsigned long held;   // ms since the press
+} GEventGesture;
+
+// per button configuration, times in ms, 0 disables long press or repeat
+typedef struct {
+  uint16_t long_ms;     // hold time of a long press
+  uint16_t repeat_ms;   // delay of the first repeat
+  uint16_t repeat_min;  // shortest repeat interval
+  uint16_t repeat_step; // every repeat comes this much sooner
+} olv_gesture_config;
+
+// a listener that queues gestures for a coroutine (olv_events/pt.h) and
+// schedules its event on every gesture. a full queue drops the newest.
+#define OLV_GESTURE_BOX 4
+
+typedef struct {
+  GListener gl;
+  olv_event_pool* ev;
+  GEventGesture queue[OLV_GESTURE_BOX];
+  uint8_t head;
+  uint8_t count;
+  unsigned long dropped;
+} olv_gesture_box;
+
+// gestures sent so far
+extern unsigned long olv_gesture_events;
+
+// takes the button configuration (OLV_INPUT_COUNT entries) and the chord masks.
+// must be called after olv_input_start().
+void olv_gesture_init (const olv_gesture_config* config, const uint8_t* chords, uint8_t chord_count);
+
+GSourceHandle olv_gesture_source (void);
+
+// the scheduler event of the engine, to be given to olv_input_start()
+unsigned long olv_gesture_run (void);
+
+// attaches box for the GLISTEN_GESTURE_ flags, ev is scheduled on every gesture
+void olv_gesture_box_init (olv_gesture_box* box, unsigned flags, olv_event_pool* ev);
+
+// takes the oldest queued gesture, returns FALSE if there is none
+bool_t olv_gesture_box_get (olv_gesture_box* box, GEventGesture* g);
+
+// drops all queued gestures
+#define olv_gesture_box_clear(box) ((box)->count = 0)
+
+// buttons held as seen by the engine and the time a button went down
+uint8_t olv_gesture_held (void);
+unsigned long olv_gesture_down (uint8_t button);
+
+#endif
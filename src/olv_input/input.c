@@ -0,0 +1,176 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "olv_i2c/i2cq.h"
+#include "olv_log/log.h"
+#include "input.h"
+
+uint8_t olv_input_bits = 0;
+unsigned long olv_input_changed[OLV_INPUT_COUNT] = {0};
+unsigned long olv_input_irqs = 0;
+unsigned long olv_input_reads = 0;
+unsigned long olv_input_latency = 0;
+
+static volatile uint8_t olv_input_pending = 0;
+static volatile unsigned long olv_input_irq_time;
+static olv_event_pool* olv_input_ev = NULL;
+
+static void olv_input_done (olv_i2c_txn* t);
+
+static uint8_t olv_input_buffer[2];
+static olv_i2c_txn olv_input_txn = OLV_I2C_TXN(I2C1_EXTGPIO_ADDRESS, NULL, 0, olv_input_buffer, 2, olv_input_done, NULL);
+static uint8_t olv_input_again = 0;
+static VirtualTimer olv_input_vt;
+
+static struct {
+  unsigned long time;
+  uint8_t bits;
+} olv_input_queue[OLV_INPUT_QUEUE];
+static uint8_t olv_input_head = 0;
+static uint8_t olv_input_count = 0;
+
+// queues a read of the expander, or a second one if a read is already on its way. locked.
+static void olv_input_sampleI (void) {
+  if (!olv_i2c_submitI(&olv_i2c1, &olv_input_txn)) olv_input_again = 1;
+};
+
+// virtual timer callbacks run unlocked
+static void olv_input_recheck (void *arg) {
+  (void)arg;
+  chSysLockFromIsr();
+  olv_input_sampleI();
+  chSysUnlockFromIsr();
+};
+
+void olv_input_irq (EXTDriver *extp, expchannel_t channel) {
+  (void)extp;
+  (void)channel;
+
+  chSysLockFromIsr();
+  // keep the first edge if the last one was not read yet
+  if (!olv_input_pending) {
+    olv_input_irq_time = (unsigned long)chTimeNow();
+    olv_input_pending = 1;
+  }
+  olv_input_irqs++;
+  olv_input_sampleI();
+  chSysUnlockFromIsr();
+
+  OLV_LOG("input irq %U", olv_input_irqs);
+};
+
+// takes the sampled states, returns the time to read again or 0 if the states are settled
+static unsigned long olv_input_debounce (uint8_t bits, unsigned long ts, uint8_t* changed) {
+
+  unsigned long recheck = 0, until;
+  uint8_t i;
+
+  *changed = 0;
+  for (i = 0; i < OLV_INPUT_COUNT; i++) {
+    if (((bits ^ olv_input_bits) >> i & 1) == 0) continue;
+
+    until = olv_input_changed[i] +OLV_INPUT_DEBOUNCE;
+    if ((long)(ts -until) >= 0) {
+      olv_input_bits ^= 1 << i;
+      olv_input_changed[i] = ts;
+      *changed = 1;
+    }
+    // still bouncing, look again when the lockout ends
+    else if (!recheck || (long)(until -recheck) < 0) {
+      recheck = until;
+    }
+  }
+
+  return recheck;
+};
+
+// queues the debounced states, must be called locked
+static void olv_input_putI (unsigned long ts) {
+
+  uint8_t i;
+
+  if (olv_input_count == OLV_INPUT_QUEUE) {
+    i = (olv_input_head +olv_input_count -1) %OLV_INPUT_QUEUE;
+  } else {
+    i = (olv_input_head +olv_input_count++) %OLV_INPUT_QUEUE;
+    olv_input_queue[i].time = ts;
+  }
+  olv_input_queue[i].bits = olv_input_bits;
+};
+
+bool_t olv_input_get (unsigned long* time, uint8_t* bits) {
+
+  bool_t got = FALSE;
+
+  chSysLock();
+  if (olv_input_count) {
+    *time = olv_input_queue[olv_input_head].time;
+    *bits = olv_input_queue[olv_input_head].bits;
+    olv_input_head = (olv_input_head +1) %OLV_INPUT_QUEUE;
+    olv_input_count--;
+    got = TRUE;
+  }
+  chSysUnlock();
+
+  return got;
+};
+
+// runs on the i2c driver thread after every read, which also releases the interrupt line
+static void olv_input_done (olv_i2c_txn* t) {
+
+  unsigned long ts, now, recheck;
+  uint8_t changed = 0;
+
+  olv_input_reads++;
+
+  chSysLock();
+  now = (unsigned long)chTimeNow();
+  ts = olv_input_pending ? olv_input_irq_time : now;
+  olv_input_pending = 0;
+  chSysUnlock();
+
+  // a failed read is retried after the lockout
+  if (t->result != RDY_OK) {
+    OLV_LOG("input read failed %d", t->result);
+    recheck = now +OLV_INPUT_DEBOUNCE;
+  } else {
+    recheck = olv_input_debounce(olv_input_buffer[1], ts, &changed);
+  }
+
+  // the line is edge triggered, if it is still raised another change came in during the read
+  if (!recheck && palReadPad(GPIOC, GPIOC_EXTGPIO_INT)) recheck = now +1;
+
+  chSysLock();
+  if (changed) olv_input_putI(ts);
+  if (olv_input_again) {
+    olv_input_again = 0;
+    olv_input_sampleI();
+  } else if (recheck) {
+    if (chVTIsArmedI(&olv_input_vt)) chVTResetI(&olv_input_vt);
+    chVTSetI(&olv_input_vt, (long)(recheck -now) > 0 ? (systime_t)(recheck -now) : 1, olv_input_recheck, NULL);
+  }
+  chSysUnlock();
+
+  if (changed) {
+    olv_input_latency = now -ts;
+    OLV_LOG("input %02x, %U ms after the irq", olv_input_bits, olv_input_latency);
+    if (olv_input_ev) olv_ev_at(olv_input_ev, now);
+  }
+};
+
+void olv_input_start (olv_event_pool* ev) {
+
+  unsigned long now = (unsigned long)chTimeNow();
+  uint8_t i;
+
+  // the lockout must not hold back the first change
+  for (i = 0; i < OLV_INPUT_COUNT; i++) olv_input_changed[i] = now -OLV_INPUT_DEBOUNCE;
+
+  // the first read is waited for, the callback takes the later ones
+  olv_input_txn.cb = NULL;
+  if (olv_i2c_transfer(&olv_i2c1, &olv_input_txn) == RDY_OK) olv_input_bits = olv_input_buffer[1];
+  olv_input_txn.cb = olv_input_done;
+
+  olv_input_ev = ev;
+};
@@ -0,0 +1,50 @@
+
+#ifndef OLV_INPUT
+#define OLV_INPUT
+
+// interrupt driven button input.
+//
+// the i2c gpio expander raises its interrupt line (PC13, ext channel 13)
+// whenever a button changes. the isr only timestamps the edge and queues
+// one read of the expander (olv_i2c), whose callback feeds the states
+// through a debouncer. nothing is polled while no button changes, so the
+// cpu stays asleep between presses and a press is seen within a few ms.
+//
+// debouncing takes a change at once and ignores further changes of that
+// button for OLV_INPUT_DEBOUNCE ms, after which the expander is read again
+// to pick up a release or press hidden by the bouncing.
+
+#include "olv_events/ev.h"
+
+#define OLV_INPUT_COUNT 6
+
+// lockout after an accepted change in ms
+#define OLV_INPUT_DEBOUNCE 10
+
+// debounced button states, bit n is button n
+extern uint8_t olv_input_bits;
+
+// isr time of the last accepted change of every button
+extern unsigned long olv_input_changed[OLV_INPUT_COUNT];
+
+// debounced changes are queued with their isr time until olv_input_get()
+// takes them, a full queue merges the newest changes into its last entry
+#define OLV_INPUT_QUEUE 8
+
+// statistics: expander interrupts, expander reads, last irq to state latency in ms
+extern unsigned long olv_input_irqs;
+extern unsigned long olv_input_reads;
+extern unsigned long olv_input_latency;
+
+// reads the initial states, ev is scheduled to run at once after every
+// debounced change. must be called after olv_i2c_start() and before
+// extStart().
+void olv_input_start (olv_event_pool* ev);
+
+// takes the oldest queued change, returns FALSE if there is none
+bool_t olv_input_get (unsigned long* time, uint8_t* bits);
+
+// ext channel callback of the expander interrupt line
+void olv_input_irq (EXTDriver *extp, expchannel_t channel);
+
+#endif
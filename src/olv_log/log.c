@@ -0,0 +1,180 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+#include "log.h"
+
+olv_log_stats olv_log = {0};
+
+// of the linker script
+extern const char __olv_log_start__[], __olv_log_end__[];
+
+typedef struct {
+  volatile uint32_t head;     // reserved by the writers
+  volatile uint32_t tail;     // taken by the drain
+  uint32_t mask;
+  volatile uint32_t* words;
+  volatile unsigned long dropped;
+  unsigned long reported;
+  uint32_t flags;             // of its headers
+} olv_log_ring;
+
+// zeroed, a zero word is never a header
+static volatile uint32_t olv_log_thread_words[OLV_LOG_THREAD_WORDS];
+static volatile uint32_t olv_log_isr_words[OLV_LOG_ISR_WORDS];
+
+static olv_log_ring olv_log_rings[2] = {
+  {0, 0, OLV_LOG_THREAD_WORDS -1, olv_log_thread_words, 0, 0, 0},
+  {0, 0, OLV_LOG_ISR_WORDS -1, olv_log_isr_words, 0, 0, OLV_LOG_ISR}
+};
+
+static Mutex olv_log_lock;
+static Semaphore olv_log_wake;
+static BaseSequentialStream* olv_log_sink = NULL;
+static bool_t olv_log_binary;
+
+static WORKING_AREA(olvLogWorkplace, OLV_LOG_STACK);
+
+void olv_log_put (const char* fmt, uint32_t count, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+
+  // the exception number, 0 in thread mode
+  olv_log_ring* r = &olv_log_rings[__get_IPSR() ? 1 : 0];
+  volatile uint32_t* w = r->words;
+  uint32_t m = r->mask, size = 2 +count, head;
+
+  // an exception between the two clears the reservation, it is tried again
+  do {
+    head = __LDREXW(&r->head);
+    if (head +size -r->tail > m +1) {
+      __CLREX();
+      // may miss one racing another writer
+      r->dropped++;
+      return;
+    }
+  } while (__STREXW(head +size, &r->head));
+
+  // volatile, the header is stored last
+  w[(head +1) & m] = (uint32_t)chTimeNow();
+  if (count > 0) w[(head +2) & m] = a;
+  if (count > 1) w[(head +3) & m] = b;
+  if (count > 2) w[(head +4) & m] = c;
+  if (count > 3) w[(head +5) & m] = d;
+  w[head & m] = (uint32_t)(fmt -__olv_log_start__) << 16 | OLV_LOG_VALID | r->flags | count;
+};
+
+// copies the oldest record of a ring, returns its words or 0 if there is none yet
+static uint32_t olv_log_peek (olv_log_ring* r, uint32_t* rec) {
+
+  uint32_t t = r->tail, i, n;
+
+  if (t == r->head) return 0;
+
+  // reserved, still being written
+  rec[0] = r->words[t & r->mask];
+  if (!(rec[0] & OLV_LOG_VALID)) return 0;
+
+  n = 2 +(rec[0] & OLV_LOG_COUNT);
+  for (i = 1; i < n; i++) rec[i] = r->words[(t +i) & r->mask];
+
+  return n;
+};
+
+// frees the oldest record, zeroed so no word of it passes for a header later
+static void olv_log_pop (olv_log_ring* r, uint32_t n) {
+
+  uint32_t t = r->tail, i;
+
+  for (i = 0; i < n; i++) r->words[(t +i) & r->mask] = 0;
+  r->tail = t +n;
+};
+
+static void olv_log_emit (BaseSequentialStream* chp, bool_t binary, const uint32_t* rec, uint32_t n) {
+
+  uint32_t id = rec[0] >> 16;
+
+  // little endian as tools/logdump reads it
+  if (binary) {
+    chSequentialStreamWrite(chp, (const uint8_t*)rec, n *4);
+    return;
+  }
+
+  chprintf(chp, "%5U.%03U %c ", (unsigned long)rec[1] /1000, (unsigned long)rec[1] %1000, rec[0] & OLV_LOG_ISR ? 'i' : 't');
+  if (id == OLV_LOG_DROPPED) chprintf(chp, "%U records dropped", (unsigned long)rec[2]);
+  else chprintf(chp, __olv_log_start__ +id, rec[2], rec[3], rec[4], rec[5]);
+  chprintf(chp, "\r\n");
+};
+
+static void olv_log_drain (BaseSequentialStream* chp, bool_t binary) {
+
+  uint32_t rec[2][2 +OLV_LOG_ARGS] = {{0}};
+  uint32_t n[2], drop;
+  olv_log_ring* r;
+  int k;
+
+  olv_log.passes++;
+
+  for (;;) {
+    n[0] = olv_log_peek(&olv_log_rings[0], rec[0]);
+    n[1] = olv_log_peek(&olv_log_rings[1], rec[1]);
+    if (!n[0] && !n[1]) break;
+
+    // the older first, the isr one on a tie
+    k = !n[0] || (n[1] && (long)(rec[1][1] -rec[0][1]) <= 0);
+    olv_log_emit(chp, binary, rec[k], n[k]);
+    olv_log_pop(&olv_log_rings[k], n[k]);
+    olv_log.records++;
+  }
+
+  // the records dropped came after those kept
+  for (k = 0; k < 2; k++) {
+    r = &olv_log_rings[k];
+    if ((drop = r->dropped -r->reported) == 0) continue;
+    r->reported += drop;
+    olv_log.dropped += drop;
+
+    rec[0][0] = (uint32_t)OLV_LOG_DROPPED << 16 | OLV_LOG_VALID | r->flags | 1;
+    rec[0][1] = (uint32_t)chTimeNow();
+    rec[0][2] = drop;
+    olv_log_emit(chp, binary, rec[0], 3);
+  }
+};
+
+static msg_t olvLogThread (void *arg) {
+  (void)arg;
+
+  chRegSetThreadName("log");
+
+  while (TRUE) {
+    // asleep while nothing is attached
+    (void)chSemWaitTimeout(&olv_log_wake, olv_log_sink ? MS2ST(OLV_LOG_DRAIN_MS) : TIME_INFINITE);
+
+    chMtxLock(&olv_log_lock);
+    if (olv_log_sink) olv_log_drain(olv_log_sink, olv_log_binary);
+    chMtxUnlock();
+  }
+
+  return 0;
+};
+
+void olv_log_start (void) {
+
+  chMtxInit(&olv_log_lock);
+  chSemInit(&olv_log_wake, 0);
+
+  (void)chThdCreateStatic(olvLogWorkplace, sizeof(olvLogWorkplace), LOWPRIO, olvLogThread, NULL);
+};
+
+void olv_log_attach (BaseSequentialStream* chp, bool_t binary) {
+
+  chMtxLock(&olv_log_lock);
+  olv_log_sink = chp;
+  olv_log_binary = binary;
+  chMtxUnlock();
+
+  if (chp) chSemSignal(&olv_log_wake);
+};
+
+size_t olv_log_strings (void) {
+  return (size_t)(__olv_log_end__ -__olv_log_start__);
+};
@@ -0,0 +1,99 @@
+
+#ifndef HEADER_OLV_LOG
+#define HEADER_OLV_LOG
+
+// binary log with deferred formatting, cheap enough for isrs and the
+// input path.
+//
+// a call site stores a record and formats nothing:
+//   OLV_LOG("irq %u", channel);
+// the format string is a constant in the .olv_log section of the linker
+// script and the record holds its offset from the start of the section,
+// the system time and up to OLV_LOG_ARGS arguments as raw u32:
+//   header   id:16 0:8 valid:1 isr:1 0:2 count:4   (high bits first)
+//   time     chTimeNow(), ms. the tickless idle corrects it before an
+//            isr runs, so it is right in isrs too
+//   args     count words
+// %s only takes string constants, a pointer into ram is stale by the
+// time it is printed. floats do not fit.
+//
+// threads and isrs write rings of their own, each with several writers
+// and one reader and without a lock: a writer reserves its words with
+// ldrex/strex on the head, fills them and writes the header last. an isr
+// preempting a reservation retries it, a thread preempted after it holds
+// back the reader of its ring only, not the isrs. a full ring drops the
+// new records and counts them. no interrupt is masked, so logging does
+// not move the timing of what it logs.
+//
+// records are formatted later, on the drain thread at LOWPRIO: "log" on
+// the shell prints them as text until a key is pressed, "log bin" sends
+// them as they are to tools/logdump, which formats them on the host with
+// the strings of the elf. the rings are merged by time.
+//
+// with OLV_USE_LOG FALSE the call sites compile to nothing, their
+// arguments are not evaluated.
+
+#include "ch.h"
+#include "hal.h"
+
+#ifndef OLV_USE_LOG
+#define OLV_USE_LOG TRUE
+#endif
+
+#define OLV_LOG_ARGS 4
+
+// ring sizes in words, powers of two. a record is 2 to 6 words.
+#define OLV_LOG_THREAD_WORDS 256
+#define OLV_LOG_ISR_WORDS 128
+
+#define OLV_LOG_DRAIN_MS 50
+#define OLV_LOG_STACK 512
+
+#define OLV_LOG_VALID 0x80
+#define OLV_LOG_ISR 0x40
+#define OLV_LOG_COUNT 0x0F
+
+// the id of the records the drain makes up for dropped ones, one argument
+#define OLV_LOG_DROPPED 0xFFFF
+
+typedef struct {
+  unsigned long records;      // drained
+  unsigned long dropped;      // reported so far, both rings
+  unsigned long passes;
+} olv_log_stats;
+
+extern olv_log_stats olv_log;
+
+// writes a record, from any context. use OLV_LOG().
+void olv_log_put (const char* fmt, uint32_t count, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+
+#if OLV_USE_LOG
+#define OLV_LOG(fmt, ...) \
+  OLV_LOG_COUNTED(fmt, OLV_LOG_N(0, ##__VA_ARGS__, 5, 5, 5, 5, 4, 3, 2, 1, 0), ##__VA_ARGS__, 0, 0, 0, 0)
+#else
+#define OLV_LOG(fmt, ...) do {} while (0)
+#endif
+
+// the count of up to 8 arguments, 5 for 5 to 8 of them. the enum needs a
+// constant count of at most OLV_LOG_ARGS, so too many stop the build. with
+// 9 or more n is one of the arguments, only a constant of 4 or less there
+// would get through.
+#define OLV_LOG_N(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define OLV_LOG_COUNTED(fmt, n, ...) OLV_LOG_PUT(fmt, n, __VA_ARGS__)
+#define OLV_LOG_PUT(fmt, n, a, b, c, d, ...) do { \
+    enum { olv_log_too_many_args = 1 /((n) <= OLV_LOG_ARGS) }; \
+    static const char olv_log_fmt[] __attribute__((section(".olv_log"), used)) = fmt; \
+    olv_log_put(olv_log_fmt, n, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)); \
+  } while (0)
+
+// creates the drain thread. records written before are kept.
+void olv_log_start (void);
+
+// the drain writes the records to chp from now on, as text or binary,
+// NULL stops it. returns after the pass in progress.
+void olv_log_attach (BaseSequentialStream* chp, bool_t binary);
+
+// bytes of the format strings, tools/logdump checks its elf against it
+size_t olv_log_strings (void);
+
+#endif
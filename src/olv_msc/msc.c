@@ -0,0 +1,346 @@
+
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+
+#include "usb_msc.h"
+#include "olv_bulk/bulk.h"
+#include "olv_asset/asset.h"
+#include "msc.h"
+
+// a transfer gives up when the host is quiet for so long
+#define OLV_MSC_STALL MS2ST(1000)
+
+#define OLV_MSC_CBW 31
+#define OLV_MSC_CSW 13
+
+#define OLV_MSC_SYNCHRONIZE_CACHE10 0x35
+
+// sense keys and additional sense codes
+#define OLV_MSC_MEDIUM_ERROR 0x03
+#define OLV_MSC_ILLEGAL_REQUEST 0x05
+#define OLV_MSC_WRITE_ERROR 0x0C
+#define OLV_MSC_INVALID_COMMAND 0x20
+#define OLV_MSC_OUT_OF_RANGE 0x21
+#define OLV_MSC_INVALID_FIELD 0x24
+
+olv_msc_stats olv_msc = {0};
+
+static WORKING_AREA(olvMscWorkplace, OLV_MSC_STACK);
+
+// the command being run
+static uint8_t olv_msc_cb[16];
+static uint32_t olv_msc_length;
+static uint8_t olv_msc_in;
+
+// of the last failure
+static uint8_t olv_msc_key, olv_msc_asc;
+
+// the block of an upload expected next
+static uint32_t olv_msc_next;
+
+static const uint8_t olv_msc_boot[62] = {
+  0xEB, 0x3C, 0x90,                         // jump
+  'O', 'L', 'V', ' ', ' ', ' ', ' ', ' ',   // oem name
+  OLV_MSC_BLOCK & 0xFF, OLV_MSC_BLOCK >> 8, // bytes per sector
+  1,                                        // sectors per cluster
+  1, 0,                                     // reserved sectors
+  1,                                        // fats
+  16, 0,                                    // root entries
+  OLV_MSC_BLOCKS & 0xFF, OLV_MSC_BLOCKS >> 8,
+  0xF8,                                     // media, fixed
+  1, 0,                                     // sectors per fat
+  1, 0,                                     // sectors per track
+  1, 0,                                     // heads
+  0, 0, 0, 0,                               // hidden sectors
+  0, 0, 0, 0,                               // sectors, 32 bit
+  0x80, 0, 0x29,                            // drive, extended signature
+  'O', 'L', 'V', 'A',                       // serial
+  'O', 'L', 'V', ' ', 'A', 'S', 'S', 'E', 'T', 'S', ' ',
+  'F', 'A', 'T', '1', '2', ' ', ' ', ' '
+};
+
+static const uint8_t olv_msc_inquiry[36] = {
+  0x00,                                     // direct access
+  0x80,                                     // removable
+  0x02, 0x02, 31, 0, 0, 0,
+  'O', 'L', 'V', ' ', ' ', ' ', ' ', ' ',
+  'A', 's', 's', 'e', 't', ' ', 's', 't', 'o', 'r', 'e', ' ', ' ', ' ', ' ', ' ',
+  '1', '.', '0', ' '
+};
+
+static uint32_t olv_msc_u32 (const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+};
+
+static void olv_msc_put_u32 (uint8_t* p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+};
+
+// scsi numbers are big endian
+static uint32_t olv_msc_be32 (const uint8_t* p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+};
+
+static void olv_msc_put_be32 (uint8_t* p, uint32_t v) {
+  p[0] = v >> 24;
+  p[1] = (v >> 16) & 0xFF;
+  p[2] = (v >> 8) & 0xFF;
+  p[3] = v & 0xFF;
+};
+
+static void olv_msc_fat12 (uint8_t* fat, uint16_t n, uint16_t v) {
+
+  uint8_t* p = fat +n +n /2;
+
+  if (n & 1) {
+    p[0] = (p[0] & 0x0F) | ((v << 4) & 0xF0);
+    p[1] = (v >> 4) & 0xFF;
+  }
+  else {
+    p[0] = v & 0xFF;
+    p[1] = (p[1] & 0xF0) | ((v >> 8) & 0x0F);
+  }
+};
+
+// ---- the disk ----
+
+static void olv_msc_read_block (uint32_t lba, uint8_t* b) {
+
+  const olv_asset_header* h = olv_asset_pack();
+  uint32_t size = h ? h->size : 0;
+  uint32_t at = (lba -3) *OLV_MSC_BLOCK;
+  uint16_t clusters = (uint16_t)((size +OLV_MSC_BLOCK -1) /OLV_MSC_BLOCK);
+  uint16_t i;
+
+  memset(b, 0, OLV_MSC_BLOCK);
+
+  if (lba == 0) {
+    memcpy(b, olv_msc_boot, sizeof(olv_msc_boot));
+    b[510] = 0x55;
+    b[511] = 0xAA;
+  }
+  else if (lba == 1) {
+    olv_msc_fat12(b, 0, 0xFF8);
+    olv_msc_fat12(b, 1, 0xFFF);
+    for (i = 0; i < clusters; i++) olv_msc_fat12(b, 2 +i, i +1 < clusters ? 3 +i : 0xFFF);
+  }
+  else if (lba == 2) {
+    memcpy(b, "OLV ASSETS ", 11);
+    b[11] = 0x08;
+    if (size) {
+      memcpy(b +32, "ASSETS  BIN", 11);
+      b[32 +11] = 0x20;
+      b[32 +26] = 2;
+      olv_msc_put_u32(b +32 +28, size);
+    }
+  }
+  else if (at < size) memcpy(b, (const uint8_t*)h +at, size -at < OLV_MSC_BLOCK ? size -at : OLV_MSC_BLOCK);
+};
+
+// the fat and the directory of the host are not kept
+static bool_t olv_msc_write_block (uint32_t lba, const uint8_t* b) {
+
+  int r;
+
+  if (lba < 3) return TRUE;
+
+  if (olv_asset.loading && lba == olv_msc_next) r = olv_asset_write(b);
+  else if (!memcmp(b, "OLVA", 4)) r = olv_asset_begin(b);
+  else return TRUE;
+
+  olv_msc_next = lba +1;
+  return r >= 0;
+};
+
+// ---- the commands ----
+
+static uint32_t olv_msc_send (const uint8_t* p, uint32_t n) {
+
+  uint8_t* buf;
+
+  if (n > olv_msc_length) n = olv_msc_length;
+  if (!n || (buf = olv_bulk_get(OLV_MSC_STALL)) == NULL) return 0;
+
+  memcpy(buf, p, n);
+  olv_bulk_send(buf, n);
+
+  return n;
+};
+
+static uint32_t olv_msc_read (uint32_t lba, uint32_t count) {
+
+  uint32_t done = 0;
+  uint8_t* buf;
+
+  while (count-- && done +OLV_MSC_BLOCK <= olv_msc_length && (buf = olv_bulk_get(OLV_MSC_STALL)) != NULL) {
+    olv_msc_read_block(lba++, buf);
+    olv_bulk_send(buf, OLV_MSC_BLOCK);
+    done += OLV_MSC_BLOCK;
+    olv_msc.blocks_read++;
+  }
+
+  return done;
+};
+
+static uint32_t olv_msc_write (uint32_t lba, uint32_t count, bool_t* ok) {
+
+  uint32_t done = 0;
+  uint8_t* buf;
+  size_t n;
+
+  while (count-- && done +OLV_MSC_BLOCK <= olv_msc_length && (buf = olv_bulk_receive(&n, OLV_MSC_STALL)) != NULL) {
+    if (n != OLV_MSC_BLOCK || !olv_msc_write_block(lba, buf)) *ok = FALSE;
+    olv_bulk_release(buf);
+    lba++;
+    done += n;
+    olv_msc.blocks_written++;
+  }
+
+  return done;
+};
+
+static uint32_t olv_msc_fail (uint8_t key, uint8_t asc) {
+
+  olv_msc_key = key;
+  olv_msc_asc = asc;
+
+  return 0;
+};
+
+// runs olv_msc_cb, returns the bytes of data moved
+static uint32_t olv_msc_command (void) {
+
+  uint8_t res[18];
+  uint32_t lba, count;
+  bool_t ok = TRUE;
+
+  if (olv_msc_cb[0] != SCSI_REQUEST_SENSE) olv_msc_key = olv_msc_asc = 0;
+  memset(res, 0, sizeof(res));
+
+  switch (olv_msc_cb[0]) {
+  case SCSI_TEST_UNIT_READY:
+  case SCSI_ALLOW_MEDIUM_REMOVAL:
+  case SCSI_START_STOP_UNIT:
+  case SCSI_VERIFY10:
+  case OLV_MSC_SYNCHRONIZE_CACHE10:
+    return 0;
+  case SCSI_REQUEST_SENSE:
+    res[0] = 0x70;
+    res[2] = olv_msc_key;
+    res[7] = 10;
+    res[12] = olv_msc_asc;
+    olv_msc_key = olv_msc_asc = 0;
+    return olv_msc_send(res, 18);
+  case SCSI_INQUIRY:
+    if (olv_msc_cb[1] & 0x01) return olv_msc_fail(OLV_MSC_ILLEGAL_REQUEST, OLV_MSC_INVALID_FIELD);
+    return olv_msc_send(olv_msc_inquiry, sizeof(olv_msc_inquiry));
+  case SCSI_READ_CAPACITY10:
+    olv_msc_put_be32(res, OLV_MSC_BLOCKS -1);
+    olv_msc_put_be32(res +4, OLV_MSC_BLOCK);
+    return olv_msc_send(res, 8);
+  case SCSI_READ_FORMAT_CAPACITIES:
+    res[3] = 8;
+    olv_msc_put_be32(res +4, OLV_MSC_BLOCKS);
+    olv_msc_put_be32(res +8, OLV_MSC_BLOCK);
+    res[8] = 0x02;                          // formatted media
+    return olv_msc_send(res, 12);
+  case SCSI_MODE_SENSE6:
+    res[0] = 3;
+    return olv_msc_send(res, 4);
+  case SCSI_MODE_SENSE10:
+    res[1] = 6;
+    return olv_msc_send(res, 8);
+  case SCSI_READ10:
+  case SCSI_WRITE10:
+    lba = olv_msc_be32(olv_msc_cb +2);
+    count = (uint32_t)olv_msc_cb[7] << 8 | olv_msc_cb[8];
+    if (lba > OLV_MSC_BLOCKS || count > OLV_MSC_BLOCKS -lba) return olv_msc_fail(OLV_MSC_ILLEGAL_REQUEST, OLV_MSC_OUT_OF_RANGE);
+    if ((olv_msc_cb[0] == SCSI_READ10) != (olv_msc_in != 0)) return olv_msc_fail(OLV_MSC_ILLEGAL_REQUEST, OLV_MSC_INVALID_FIELD);
+    if (olv_msc_in) return olv_msc_read(lba, count);
+    count = olv_msc_write(lba, count, &ok);
+    if (!ok) olv_msc_fail(OLV_MSC_MEDIUM_ERROR, OLV_MSC_WRITE_ERROR);
+    return count;
+  };
+
+  return olv_msc_fail(OLV_MSC_ILLEGAL_REQUEST, OLV_MSC_INVALID_COMMAND);
+};
+
+static msg_t olvMscThread (void *arg) {
+  (void)arg;
+
+  uint8_t* buf;
+  size_t n;
+  uint32_t tag, done;
+  bool_t ok;
+
+  chRegSetThreadName("msc");
+
+  while (TRUE) {
+    if ((buf = olv_bulk_receive(&n, TIME_INFINITE)) == NULL) continue;
+
+    // anything but a command block is dropped until the next one
+    ok = n == OLV_MSC_CBW && olv_msc_u32(buf) == MSC_CBW_SIGNATURE && buf[13] == 0 && buf[14] >= 1 && buf[14] <= 16;
+    tag = olv_msc_u32(buf +4);
+    olv_msc_length = olv_msc_u32(buf +8);
+    olv_msc_in = buf[12] & 0x80;
+    memcpy(olv_msc_cb, buf +15, sizeof(olv_msc_cb));
+    olv_bulk_release(buf);
+
+    if (!ok) {
+      olv_msc.errors++;
+      continue;
+    }
+
+    olv_msc.commands++;
+    done = olv_msc_command();
+    if (olv_msc_key) olv_msc.errors++;
+
+    // the host expects as many bytes as it said: a short transfer ends what
+    // it reads, what it sends is dropped
+    if (olv_msc_in && olv_msc_length && !done) done = olv_msc_send(olv_msc_cb, 1);
+    while (!olv_msc_in && done < olv_msc_length && (buf = olv_bulk_receive(&n, OLV_MSC_STALL)) != NULL) {
+      olv_bulk_release(buf);
+      done += n;
+    }
+
+    if ((buf = olv_bulk_get(OLV_MSC_STALL)) == NULL) continue;
+    olv_msc_put_u32(buf, MSC_CSW_SIGNATURE);
+    olv_msc_put_u32(buf +4, tag);
+    olv_msc_put_u32(buf +8, done < olv_msc_length ? olv_msc_length -done : 0);
+    buf[12] = olv_msc_key ? MSC_CSW_STATUS_FAILED : MSC_CSW_STATUS_PASSED;
+    olv_bulk_send(buf, OLV_MSC_CSW);
+  }
+
+  return 0;
+};
+
+bool_t olv_msc_requests (USBDriver* usbp) {
+
+  static uint8_t lun = 0;
+
+  if ((usbp->setup[0] & (USB_RTYPE_TYPE_MASK | USB_RTYPE_RECIPIENT_MASK)) !=
+      (USB_RTYPE_TYPE_CLASS | USB_RTYPE_RECIPIENT_INTERFACE) || usbp->setup[4] != OLV_BULK_INTERFACE) return FALSE;
+
+  switch (usbp->setup[1]) {
+  case MSC_GET_MAX_LUN_COMMAND:
+    usbSetupTransfer(usbp, &lun, 1, NULL);
+    return TRUE;
+  case MSC_MASS_STORAGE_RESET_COMMAND:
+    // the thread finds the next command block by itself
+    usbSetupTransfer(usbp, NULL, 0, NULL);
+    return TRUE;
+  };
+
+  return FALSE;
+};
+
+void olv_msc_start (void) {
+
+  olv_bulk_init();
+
+  (void)chThdCreateStatic(olvMscWorkplace, sizeof(olvMscWorkplace), NORMALPRIO, olvMscThread, NULL);
+};
@@ -0,0 +1,59 @@
+
+#ifndef OLV_MSC
+#define OLV_MSC
+
+// usb mass storage view of the asset region, to drop a new pack on.
+//
+// with OLV_USE_MSC interface 2 of the composite device is a mass storage
+// interface (scsi transparent, bulk only) instead of the vendor interface
+// of tools/bulkbench. it keeps the endpoints and the buffers of
+// olv_bulk/bulk.h: the packet memory has no room for another pair, and a
+// 512 byte buffer is a block. the msc thread takes the commands in place
+// of the throughput test.
+//
+// the disk is a small fat12 volume made up as it is read:
+//   block 0   boot sector
+//   block 1   the fat, one cluster per block
+//   block 2   the root directory, ASSETS.BIN when the pack is valid
+//   block 3   cluster 2 on, ASSETS.BIN is the asset region from the start
+// the host may write whatever it likes, only the data blocks are looked
+// at: a block starting with a pack header begins an upload
+// (olv_asset_begin()), the blocks following it in order go to the flash
+// as they come. copying a pack onto the disk does that, any name will do.
+// the fat and the directory of the host are dropped, the host sees the
+// new ASSETS.BIN once it reads the disk again, after a remount.
+
+#include "ch.h"
+#include "hal.h"
+
+#ifndef OLV_USE_MSC
+#define OLV_USE_MSC FALSE
+#endif
+
+#define OLV_MSC_BLOCK 512
+// the data area, twice the asset region so a new pack fits beside the old
+#define OLV_MSC_CLUSTERS 256
+#define OLV_MSC_BLOCKS (3 +OLV_MSC_CLUSTERS)
+
+// working area of the msc thread. the deepest path is a write10 into
+// olv_asset_write() and the flash programming below it, about 250 bytes
+// with the context switch and an exception frame, the rest is margin.
+// "perf" shows what is left after copying a pack.
+#define OLV_MSC_STACK 512
+
+typedef struct {
+  unsigned long commands;
+  unsigned long errors;       // failed commands, broken command blocks
+  unsigned long blocks_read;
+  unsigned long blocks_written;
+} olv_msc_stats;
+
+extern olv_msc_stats olv_msc;
+
+// before usbStart(), instead of olv_bulk_start()
+void olv_msc_start (void);
+
+// from the requests hook, the class requests of the interface
+bool_t olv_msc_requests (USBDriver* usbp);
+
+#endif
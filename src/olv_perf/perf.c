@@ -0,0 +1,134 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "framebuffer_draw.h"
+#include "olv_events/ev.h"
+#include "olv_i2c/i2cq.h"
+#include "olv_render/render.h"
+#include "olv_bulk/bulk.h"
+#include "olv_time/time.h"
+#include "perf.h"
+
+olv_perf_counters olv_perf = {0};
+
+// the heap is sampled, a peak between two samples is not seen
+static uint32_t olv_perf_heap_min = 0xFFFFFFFF;
+
+static Thread* olv_perf_main = NULL;
+
+// the periodic snapshot, handed from the scheduler thread to the sender
+static olv_perf_snapshot olv_perf_last;
+static BinarySemaphore olv_perf_taken;
+static unsigned long olv_perf_period = 0;
+
+static unsigned long olv_perf_tick (void);
+static olv_event_pool olv_perf_ev = OLV_EVENT(olv_perf_tick, OLV_EV_PRIO_LOGIC);
+
+void olv_perf_init (void) {
+
+  olv_perf_main = chThdSelf();
+  chBSemInit(&olv_perf_taken, TRUE);
+};
+
+long olv_perf_stack_free (Thread* tp) {
+
+  const uint8_t* p = (const uint8_t*)(tp +1);
+
+  // the stack of main is not behind its thread, see chSysInit()
+  if (tp == olv_perf_main) return -1;
+
+  // filled on creation (CH_DBG_FILL_THREADS), the stack grows down to it
+  while (*p == CH_STACK_FILL_VALUE) p++;
+
+  return (long)(p -(const uint8_t*)(tp +1));
+};
+
+void olv_perf_take (olv_perf_snapshot* s) {
+
+  olv_event_pool* ev;
+  Thread* tp;
+  size_t heap;
+  long free;
+
+  s->uptime = (uint32_t)olv_time_mono();
+  s->frames = olv_render.frames;
+  s->pixels = framebuffer_pixels;
+  s->spi_bytes = framebuffer_spi_bytes;
+  s->spi_us = framebuffer_spi_us;
+  s->i2c_done = olv_i2c1.done;
+  s->i2c_errors = olv_i2c1.errors +olv_i2c1.timeouts;
+  s->usb_in = olv_perf.usb_in +olv_bulk.received;
+  s->usb_out = olv_perf.usb_out +olv_bulk.sent;
+
+  s->late_max = 0;
+  for (ev = olv_ev_list; ev; ev = ev->next)
+    if (ev->stats.late_max > s->late_max) s->late_max = ev->stats.late_max;
+
+  chHeapStatus(NULL, &heap);
+  s->heap_free = heap;
+  if (heap < olv_perf_heap_min) olv_perf_heap_min = heap;
+  s->heap_min = olv_perf_heap_min;
+  s->core_free = chCoreStatus();
+
+  s->idle = 0;
+  s->stack_free = 0xFFFFFFFF;
+  for (tp = chRegFirstThread(); tp; tp = chRegNextThread(tp)) {
+    if (tp->p_prio == IDLEPRIO) s->idle = (uint32_t)((uint64_t)chThdGetTicks(tp) *1000 /CH_FREQUENCY);
+    free = olv_perf_stack_free(tp);
+    if (free >= 0 && (uint32_t)free < s->stack_free) s->stack_free = (uint32_t)free;
+  }
+};
+
+static unsigned long olv_perf_tick (void) {
+
+  olv_perf_snapshot s;
+
+  if (!olv_perf_period) return OLV_EV_STOP;
+
+  olv_perf_take(&s);
+
+  // the sender may be copying the last one
+  chSysLock();
+  olv_perf_last = s;
+  chBSemSignalI(&olv_perf_taken);
+  chSysUnlock();
+
+  return olv_perf_period;
+};
+
+void olv_perf_periodic (unsigned long period) {
+
+  olv_perf_period = period;
+  if (period) olv_ev_add(&olv_perf_ev, period);
+  else olv_ev_remove(&olv_perf_ev);
+  chBSemReset(&olv_perf_taken, TRUE);
+};
+
+bool_t olv_perf_next (olv_perf_snapshot* s, systime_t timeout) {
+
+  chSysLock();
+  if (chBSemWaitTimeoutS(&olv_perf_taken, timeout) != RDY_OK) {
+    chSysUnlock();
+    return FALSE;
+  }
+  *s = olv_perf_last;
+  chSysUnlock();
+
+  return TRUE;
+};
+
+void olv_perf_record (const olv_perf_snapshot* s, uint8_t* out) {
+
+  const uint32_t* w = (const uint32_t*)s;
+  uint8_t i;
+
+  *out++ = 'P';
+  *out++ = OLV_PERF_VERSION;
+  for (i = 0; i < OLV_PERF_WORDS; i++, out += 4) {
+    out[0] = w[i] & 0xFF;
+    out[1] = (w[i] >> 8) & 0xFF;
+    out[2] = (w[i] >> 16) & 0xFF;
+    out[3] = w[i] >> 24;
+  }
+};
@@ -0,0 +1,78 @@
+
+#ifndef OLV_PERF
+#define OLV_PERF
+
+// performance counters of the whole firmware in one place.
+//
+// the counters stay with the code that counts, each one has a single
+// writer and is a plain increment, so they cost no lock and stay enabled:
+// olv_render and the framebuffer count frames, pixels and spi transfers,
+// olv_i2c1 the bus, olv_bulk and olv_perf itself the usb bytes, the
+// kernel the ticks of every thread (CH_DBG_THREADS_PROFILING) and the
+// event scheduler its lateness. olv_perf_take() gathers them, the sums of
+// several words may be off by the counts of a moment, never more.
+//
+// the shell shows them with "perf", host tools fetch them as a record
+// with the rpc command of usb_shell.c and graph the differences:
+//   'P' OLV_PERF_VERSION, then OLV_PERF_WORDS u32, little endian, in the
+//   order of olv_perf_snapshot
+// tools/rpctool polls it with "perf".
+//
+// "telemetry [ms]" sends the record periodically instead: an event takes
+// the snapshot every ms (default OLV_PERF_PERIOD) on the scheduler thread,
+// the shell thread sends 'O' 'T' and then each record as it is taken,
+// until a byte comes. tools/rpctool reads them with "telemetry".
+
+#include "ch.h"
+#include "hal.h"
+
+// bytes of the serial port and push mode, from the usb interrupt
+typedef struct {
+  unsigned long usb_in;
+  unsigned long usb_out;
+} olv_perf_counters;
+
+extern olv_perf_counters olv_perf;
+
+#define OLV_PERF_PERIOD 1000
+
+typedef struct {
+  uint32_t uptime;      // ms
+  uint32_t frames;
+  uint32_t pixels;      // drawn into the framebuffer
+  uint32_t spi_bytes;
+  uint32_t spi_us;      // busy sending
+  uint32_t i2c_done;
+  uint32_t i2c_errors;  // errors and timeouts
+  uint32_t usb_in;      // bytes, serial port and bulk interface
+  uint32_t usb_out;
+  uint32_t idle;        // ms the idle thread ran
+  uint32_t late_max;    // ms, the latest event
+  uint32_t heap_free;
+  uint32_t heap_min;    // the least heap_free of every olv_perf_take()
+  uint32_t core_free;   // never given back, the low mark of itself
+  uint32_t stack_free;  // bytes, the least of all threads
+} olv_perf_snapshot;
+
+#define OLV_PERF_VERSION 2
+#define OLV_PERF_WORDS (sizeof(olv_perf_snapshot) /4)
+#define OLV_PERF_RECORD (2 +OLV_PERF_WORDS *4)
+
+// from main(), which it takes as the main thread
+void olv_perf_init (void);
+
+void olv_perf_take (olv_perf_snapshot* s);
+
+// takes a snapshot every period ms from a scheduled event, 0 stops
+void olv_perf_periodic (unsigned long period);
+
+// the next periodic snapshot, FALSE when none was taken within timeout
+bool_t olv_perf_next (olv_perf_snapshot* s, systime_t timeout);
+
+// writes the OLV_PERF_RECORD bytes of the record
+void olv_perf_record (const olv_perf_snapshot* s, uint8_t* out);
+
+// bytes of the stack of tp never used, -1 when unknown
+long olv_perf_stack_free (Thread* tp);
+
+#endif
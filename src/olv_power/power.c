@@ -0,0 +1,110 @@
+
+// tools/powersim builds the policy of this file on the host
+#ifndef OLV_POWER_HOST
+#include "ch.h"
+#include "hal.h"
+#endif
+
+#include "power.h"
+
+// the time left until the idle time reaches t, if it is still ahead
+static void olv_power_until (unsigned long idle, unsigned long t, unsigned long* next) {
+  if (idle < t && t -idle < *next) *next = t -idle;
+};
+
+void olv_power_policy (const olv_power_config* cfg, const olv_power_inputs* in, olv_power_state* out) {
+
+  unsigned long next = OLV_EV_STOP;
+
+  if (in->off) out->display = OLV_POWER_OFF;
+  else if (in->idle < cfg->dim_ms) out->display = OLV_POWER_ON;
+  else if (in->usb || in->idle < cfg->sleep_ms) out->display = OLV_POWER_DIM;
+  else if (in->idle < cfg->off_ms) out->display = OLV_POWER_SLEEP;
+  else out->display = OLV_POWER_OFF;
+
+  // the next step down, usb holds it at dim
+  if (out->display == OLV_POWER_ON) olv_power_until(in->idle, cfg->dim_ms, &next);
+  if (out->display >= OLV_POWER_DIM && !in->usb) olv_power_until(in->idle, cfg->sleep_ms, &next);
+  if (out->display >= OLV_POWER_SLEEP && !in->usb) olv_power_until(in->idle, cfg->off_ms, &next);
+
+  out->seconds = out->display == OLV_POWER_ON && in->seconds;
+
+  out->frame = cfg->frame_slow;
+  if (out->display == OLV_POWER_ON && in->idle < cfg->busy_ms) {
+    out->frame = cfg->frame_fast;
+    olv_power_until(in->idle, cfg->busy_ms, &next);
+  }
+
+  out->next = next;
+};
+
+#ifndef OLV_POWER_HOST
+
+olv_power_state olv_power = {OLV_POWER_OFF, 0, 0, OLV_EV_STOP};
+unsigned long olv_power_changes = 0;
+
+static const olv_power_config* olv_power_cfg;
+static olv_power_apply olv_power_hook;
+static olv_power_inputs olv_power_in;
+static unsigned long olv_power_last;   // time of the last input
+static volatile uint8_t olv_power_usb = 0;
+
+static unsigned long olv_power_run (void);
+static olv_event_pool olv_power_ev = OLV_EVENT(olv_power_run, OLV_EV_PRIO_LOGIC);
+
+static unsigned long olv_power_run (void) {
+
+  olv_power_state from = olv_power;
+
+  olv_power_in.idle = olv_event_time -olv_power_last;
+  olv_power_in.usb = olv_power_usb;
+  olv_power_policy(olv_power_cfg, &olv_power_in, &olv_power);
+
+  // once off it stays off until woken up
+  if (olv_power.display == OLV_POWER_OFF) olv_power_in.off = 1;
+
+  if (from.display != olv_power.display || from.seconds != olv_power.seconds || from.frame != olv_power.frame) {
+    olv_power_changes++;
+    olv_power_hook(&from, &olv_power);
+  }
+
+  return olv_power.next;
+};
+
+void olv_power_init (const olv_power_config* cfg, olv_power_apply apply, uint8_t seconds) {
+
+  olv_power_cfg = cfg;
+  olv_power_hook = apply;
+  olv_power_in.off = 1;
+  olv_power_in.seconds = seconds;
+  olv_power.frame = cfg->frame_slow;
+  olv_power_last = olv_event_time;
+};
+
+void olv_power_input (void) {
+
+  if (olv_power_in.off) return;
+
+  olv_power_last = olv_event_time;
+  olv_ev_at(&olv_power_ev, olv_event_time);
+};
+
+void olv_power_wake (void) {
+
+  olv_power_in.off = 0;
+  olv_power_input();
+};
+
+void olv_power_off (void) {
+
+  olv_power_in.off = 1;
+  olv_ev_at(&olv_power_ev, olv_event_time);
+};
+
+void olv_power_usbI (bool_t attached) {
+
+  olv_power_usb = attached ? 1 : 0;
+  olv_ev_atI(&olv_power_ev, (unsigned long)chTimeNow());
+};
+
+#endif
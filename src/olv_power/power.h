@@ -0,0 +1,91 @@
+
+#ifndef OLV_POWER
+#define OLV_POWER
+
+// power and refresh policy.
+//
+// olv_power_policy() decides from the time since the last input, the usb
+// state and what the face needs how the display and the face run:
+// - on: the full face, the second hand moves. frames run at the fast
+//   rate for a while after every input, then at the slow rate.
+// - dim: the face updates once a minute without second hand and walking
+//   dot. the oled has no brightness control, its current follows the lit
+//   pixels and the update rate.
+// - sleep: the panel is switched off but keeps its state, any button
+//   brings it back at once.
+// - off: the panel is powered down, only olv_power_wake() turns it on.
+// while usb is attached (charging) the display goes no further than dim.
+//
+// the policy is a pure function, tools/powersim runs it on the host
+// against recorded activity traces. on the watch olv_power_init() runs it
+// as a scheduler event on every input, usb change and policy deadline,
+// which calls the apply hook whenever the state changed.
+//
+// the cpu clock is not scaled: usb needs the pll and the i2c and pwm
+// timings are derived from the compile time clock tree. between events
+// the core sleeps in the tickless idle thread instead.
+
+// the host build provides uint8_t and OLV_EV_STOP itself
+#ifndef OLV_POWER_HOST
+#include "olv_events/ev.h"
+#endif
+
+#define OLV_POWER_OFF 0
+#define OLV_POWER_SLEEP 1
+#define OLV_POWER_DIM 2
+#define OLV_POWER_ON 3
+
+// times in ms
+typedef struct {
+  unsigned long dim_ms;      // idle time until the display dims
+  unsigned long sleep_ms;    // until the panel sleeps
+  unsigned long off_ms;      // until the panel is powered down
+  unsigned long busy_ms;     // frames run at the fast rate this long after an input
+  unsigned long frame_fast;  // render period while busy
+  unsigned long frame_slow;  // render period otherwise
+} olv_power_config;
+
+typedef struct {
+  unsigned long idle;  // ms since the last input
+  uint8_t usb;         // usb attached
+  uint8_t off;         // switched off, no input but olv_power_wake() turns it on
+  uint8_t seconds;     // the face has a second hand
+} olv_power_inputs;
+
+typedef struct {
+  uint8_t display;     // one of OLV_POWER_
+  uint8_t seconds;     // the face updates every second, otherwise every minute
+  unsigned long frame; // render period in ms
+  unsigned long next;  // ms until the state changes without input, or OLV_EV_STOP
+} olv_power_state;
+
+void olv_power_policy (const olv_power_config* cfg, const olv_power_inputs* in, olv_power_state* out);
+
+// tools/powersim only uses the policy
+#ifndef OLV_POWER_HOST
+
+// called from the scheduler thread with the old and the new state
+typedef void (*olv_power_apply)(const olv_power_state* from, const olv_power_state* to);
+
+// the current state and the number of changes
+extern olv_power_state olv_power;
+extern unsigned long olv_power_changes;
+
+// starts with the display off, seconds tells if the face has a second hand
+void olv_power_init (const olv_power_config* cfg, olv_power_apply apply, uint8_t seconds);
+
+// a button was used, brings a dim or sleeping display back on
+void olv_power_input (void);
+
+// turns the display on, also when it is off
+void olv_power_wake (void);
+
+// turns the display off
+void olv_power_off (void);
+
+// usb attached or detached, from the usb event isr
+void olv_power_usbI (bool_t attached);
+
+#endif
+
+#endif
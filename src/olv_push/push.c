@@ -0,0 +1,173 @@
+
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+
+#include "usb_cdc.h"
+#include "framebuffer_draw.h"
+#include "olv_events/ev.h"
+#include "olv_render/render.h"
+#include "olv_power/power.h"
+#include "olv_perf/perf.h"
+#include "push.h"
+
+#define OLV_PUSH_EP USB_CDC_DATA_AVAILABLE_EP
+#define OLV_PUSH_ROW (FRAMEBUFFER_WIDTH *2)
+
+// the longest a frame waits for its flush, a sleeping display never flushes
+#define OLV_PUSH_FLUSH_WAIT 200
+
+olv_push_stats olv_push = {0};
+
+// the endpoint of the serial driver and the copy that receives for push mode
+static const USBEndpointConfig* olv_push_sdu_cfg;
+static USBEndpointConfig olv_push_cfg;
+
+static BinarySemaphore olv_push_received;
+static uint8_t olv_push_header[64];
+static volatile uint8_t olv_push_active = 0;
+
+static unsigned long olv_push_frame (void);
+static olv_event_pool olv_push_ev = OLV_EVENT(olv_push_frame, OLV_EV_PRIO_DRAW);
+
+// on the scheduler thread, the render event is only touched there
+static unsigned long olv_push_frame (void) {
+
+  static uint8_t remote = 0;
+
+  if (remote != olv_push_active) {
+    remote = olv_push_active;
+    olv_render_remote(remote);
+  }
+
+  if (remote) {
+    // the host is busy, keeps the display on
+    olv_power_input();
+    framebuffer_invalidate();
+    olv_render_frame();
+  }
+
+  return OLV_EV_STOP;
+};
+
+static void olv_push_out (USBDriver* usbp, usbep_t ep) {
+
+  olv_perf.usb_in += usbp->epc[ep]->out_state->rxcnt;
+
+  chSysLockFromIsr();
+  chBSemSignalI(&olv_push_received);
+  chSysUnlockFromIsr();
+};
+
+// n has to be a multiple of the packet size. locked, the endpoint may still
+// be armed for the queue of the serial driver, then the transfer is only
+// redirected.
+static bool_t olv_push_receive (USBDriver* usbp, uint8_t* buf, size_t n, systime_t timeout) {
+
+  msg_t msg;
+
+  chSysLock();
+  if (usbGetDriverStateI(usbp) != USB_ACTIVE || usbp->epc[OLV_PUSH_EP] != &olv_push_cfg) {
+    chSysUnlock();
+    return FALSE;
+  }
+  usbPrepareReceive(usbp, OLV_PUSH_EP, buf, n);
+  usbStartReceiveI(usbp, OLV_PUSH_EP);
+  msg = chBSemWaitTimeoutS(&olv_push_received, timeout);
+  chSysUnlock();
+
+  return msg == RDY_OK;
+};
+
+static void olv_push_flush (void) {
+
+  EventListener el;
+  systime_t start = chTimeNow();
+  unsigned long wait;
+
+  chEvtRegisterMask(&olv_render_flushed, &el, EVENT_MASK(0));
+  olv_ev_at(&olv_push_ev, (unsigned long)start);
+  chEvtWaitAnyTimeout(EVENT_MASK(0), MS2ST(OLV_PUSH_FLUSH_WAIT));
+  chEvtUnregister(&olv_render_flushed, &el);
+  chEvtGetAndClearEvents(EVENT_MASK(0));
+
+  wait = (unsigned long)(chTimeNow() -start);
+  if (wait > olv_push.flush_wait_max) olv_push.flush_wait_max = wait;
+};
+
+void olv_push_run (SerialUSBDriver* sdup) {
+
+  USBDriver* usbp = sdup->config->usbp;
+  uint8_t* fb = (uint8_t*)FRAMEBUFFER_ADDRESS;
+  uint8_t y, rows;
+  size_t n;
+
+  memset(&olv_push, 0, sizeof(olv_push));
+  chBSemInit(&olv_push_received, TRUE);
+
+  chSysLock();
+  if (usbGetDriverStateI(usbp) != USB_ACTIVE) {
+    chSysUnlock();
+    return;
+  }
+  olv_push_sdu_cfg = usbp->epc[OLV_PUSH_EP];
+  olv_push_cfg = *olv_push_sdu_cfg;
+  olv_push_cfg.out_cb = olv_push_out;
+  usbp->epc[OLV_PUSH_EP] = &olv_push_cfg;
+  chSysUnlock();
+
+  olv_push_active = 1;
+  olv_ev_at(&olv_push_ev, (unsigned long)chTimeNow());
+
+  chSequentialStreamWrite((BaseSequentialStream*)sdup, (const uint8_t*)"OR", 2);
+
+  while (olv_push_receive(usbp, olv_push_header, sizeof(olv_push_header), MS2ST(OLV_PUSH_IDLE))) {
+
+    if (olv_push_header[0] != 'O' || olv_push_header[1] != 'P') {
+      olv_push.errors++;
+      continue;
+    }
+
+    if (olv_push_header[2] == 'E') break;
+
+    if (olv_push_header[2] == 'F') {
+      olv_push.frames++;
+      olv_push_flush();
+      continue;
+    }
+
+    y = olv_push_header[3];
+    rows = olv_push_header[4];
+    if (olv_push_header[2] != 'B' || !rows || y +rows > FRAMEBUFFER_HEIGHT) {
+      olv_push.errors++;
+      continue;
+    }
+
+    // the rows are contiguous, so the band goes in one transfer
+    n = (size_t)rows *OLV_PUSH_ROW;
+    if (!olv_push_receive(usbp, fb +y *OLV_PUSH_ROW, n, MS2ST(1000))) break;
+    olv_push.bands++;
+    olv_push.bytes += n;
+  }
+
+  // a receive that timed out is still armed into the framebuffer or the
+  // header. the endpoint NAKs from now on, a packet already on its way is
+  // in within a packet time and lands there, then the endpoint is idle.
+  chSysLock();
+  while (usbp->epc[OLV_PUSH_EP] == &olv_push_cfg && usb_lld_stop_out(usbp, OLV_PUSH_EP))
+    chThdSleepS(MS2ST(1));
+
+  // gives the endpoint back and restarts the transfer to the input queue
+  if (usbp->epc[OLV_PUSH_EP] == &olv_push_cfg) {
+    usbp->epc[OLV_PUSH_EP] = olv_push_sdu_cfg;
+    n = chIQGetEmptyI(&sdup->iqueue) /olv_push_sdu_cfg->out_maxsize *olv_push_sdu_cfg->out_maxsize;
+    if (n) {
+      usbPrepareQueuedReceive(usbp, OLV_PUSH_EP, &sdup->iqueue, n);
+      usbStartReceiveI(usbp, OLV_PUSH_EP);
+    }
+  }
+  chSysUnlock();
+
+  olv_push_active = 0;
+  olv_ev_at(&olv_push_ev, (unsigned long)chTimeNow());
+};
@@ -0,0 +1,44 @@
+
+#ifndef OLV_PUSH
+#define OLV_PUSH
+
+// remote framebuffer, the host renders and the watch displays.
+//
+// olv_push_run() takes the bulk out endpoint away from the serial driver
+// and receives bands of framebuffer rows with usbPrepareReceive() straight
+// into the framebuffer, without going through the input queue. the render
+// event stops drawing its layers meanwhile and only flushes what the host
+// sent. tools/screentx is the host side.
+//
+// every transfer is a multiple of the 64 byte packet size, the watch sends
+// 'O' 'R' once it listens. then the host sends headers of one packet each:
+//   'O' 'P' 'B' y:u8 rows:u8  rows *FRAMEBUFFER_WIDTH pixels follow, rgb565
+//                             high byte first, to the framebuffer at row y
+//   'O' 'P' 'F'               the frame is complete. the next header is
+//                             taken after the flush, so it does not tear
+//   'O' 'P' 'E'               back to the shell
+// the rest of a header packet is ignored. the rows are in the panel
+// orientation, see olv_stream/stream.h. the host sends only the bands that
+// changed, a frame without any is a flush of the unchanged framebuffer.
+//
+// push mode also ends when no header arrives for OLV_PUSH_IDLE ms.
+
+#include "ch.h"
+#include "hal.h"
+
+#define OLV_PUSH_IDLE 10000
+
+typedef struct {
+  unsigned long frames;
+  unsigned long bands;
+  unsigned long bytes;    // received into the framebuffer
+  unsigned long errors;   // unknown headers, bands out of the framebuffer
+  unsigned long flush_wait_max;  // ms between a frame header and its flush
+} olv_push_stats;
+
+extern olv_push_stats olv_push;
+
+// runs push mode on the serial over usb driver of the shell, from the shell thread
+void olv_push_run (SerialUSBDriver* sdup);
+
+#endif
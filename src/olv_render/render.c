@@ -0,0 +1,127 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "framebuffer_draw.h"
+#include "render.h"
+
+olv_render_stats olv_render = {0};
+EVENTSOURCE_DECL(olv_render_flushed);
+
+static const olv_layer* olv_render_layers = NULL;
+static uint8_t olv_render_count = 0;
+static unsigned long olv_render_period = 0;
+
+static uint8_t olv_render_dirty = 0;
+static unsigned long olv_render_slot;   // time the pending frame is scheduled for
+static unsigned long olv_render_last;   // start of the last frame
+static uint8_t olv_render_drawn = 0;
+static uint8_t olv_render_remote_on = 0;
+
+static unsigned long olv_render_run (void);
+static olv_event_pool olv_render_ev = OLV_EVENT(olv_render_run, OLV_EV_PRIO_DRAW);
+
+static bool_t olv_render_overlap (const olv_layer* a, const olv_layer* b) {
+  return a->x < b->x +b->cx && b->x < a->x +a->cx && a->y < b->y +b->cy && b->y < a->y +a->cy;
+};
+
+void olv_render_init (const olv_layer* layers, uint8_t count, unsigned long period) {
+
+  chDbgAssert(count <= OLV_RENDER_MAX, "olv_render_init(), #1", "too many layers");
+
+  olv_render_layers = layers;
+  olv_render_count = count;
+  olv_render_period = period;
+};
+
+void olv_render_set_period (unsigned long period) {
+  olv_render_period = period;
+};
+
+static void olv_render_schedule (void) {
+
+  unsigned long at;
+
+  // a pending or running frame draws it as well
+  if (olv_ev_scheduled(&olv_render_ev)) {
+    olv_render.coalesced++;
+    return;
+  }
+
+  at = olv_render_last +olv_render_period;
+  if (!olv_render_drawn || (long)(at -olv_event_time) < 0) at = olv_event_time;
+
+  olv_render_slot = at;
+  olv_ev_at(&olv_render_ev, at);
+};
+
+void olv_render_invalidate (uint8_t mask) {
+
+  olv_render_dirty |= mask & (uint8_t)((1 << olv_render_count) -1);
+  if (olv_render_dirty && !olv_render_remote_on) olv_render_schedule();
+};
+
+void olv_render_remote (bool_t on) {
+
+  olv_render_remote_on = on ? 1 : 0;
+  if (!on) olv_render_invalidate(OLV_RENDER_ALL);
+};
+
+void olv_render_frame (void) {
+  olv_render_schedule();
+};
+
+static unsigned long olv_render_run (void) {
+
+  uint32_t start, flush;
+  unsigned long us, late;
+  uint8_t dirty, i, j;
+
+  // the layers stay invalid until the display is switched on again
+  if (!framebuffer_active) return OLV_EV_STOP;
+
+  start = halGetCounterValue();
+  olv_render_last = olv_event_time;
+  olv_render_drawn = 1;
+
+  // the remote writer owns the framebuffer, the layers keep their dirty bits
+  dirty = olv_render_remote_on ? 0 : olv_render_dirty;
+  olv_render_dirty &= ~dirty;
+
+  for (i = 0; i < olv_render_count; i++) {
+    if (!(dirty >> i &1)) continue;
+
+    olv_render_layers[i].draw();
+    olv_render.layers++;
+
+    for (j = i +1; j < olv_render_count; j++)
+      if (olv_render_overlap(&olv_render_layers[i], &olv_render_layers[j])) dirty |= 1 << j;
+  }
+
+  flush = halGetCounterValue();
+  framebuffer_draw();
+  chEvtBroadcast(&olv_render_flushed);
+
+  us = RTT2US(halGetCounterValue() -flush);
+  if (us > olv_render.flush_max) olv_render.flush_max = us;
+  olv_render.flush_sum += us;
+
+  us = RTT2US(halGetCounterValue() -start);
+  if (us > olv_render.cost_max) olv_render.cost_max = us;
+  olv_render.cost_sum += us;
+  olv_render.frames++;
+
+  late = (unsigned long)chTimeNow() -(olv_render_slot +olv_render_period);
+  if ((long)late > 0) {
+    olv_render.missed++;
+    if (late > olv_render.late_max) olv_render.late_max = late;
+  }
+
+  // a layer invalidated while drawing gets the next frame
+  if (olv_render_dirty && !olv_render_remote_on) {
+    olv_render_slot = olv_render_last +olv_render_period;
+    return olv_render_period;
+  }
+
+  return OLV_EV_STOP;
+};
@@ -0,0 +1,70 @@
+
+#ifndef OLV_RENDER
+#define OLV_RENDER
+
+// coalesced redraws.
+//
+// events do not draw themselves. they update their state and mark the
+// layers that show it as invalid with olv_render_invalidate(). a single
+// render event then draws all invalid layers bottom up and flushes the
+// framebuffer once. a redrawn layer also invalidates the layers above it
+// whose areas overlap its own, since it may have painted over them.
+//
+// frames start at least one period apart, everything invalidated in
+// between waits for the next frame. a frame has to be flushed within one
+// period of the time it was scheduled for, otherwise it counts as a
+// missed deadline.
+
+#include "gdisp.h"
+#include "olv_events/ev.h"
+
+// the layer mask has one bit per layer
+#define OLV_RENDER_MAX 8
+#define OLV_RENDER_ALL 0xFF
+
+typedef void (*olv_layer_draw)(void);
+
+typedef struct {
+  olv_layer_draw draw;
+  coord_t x, y, cx, cy;  // the area the layer draws into
+} olv_layer;
+
+#define OLV_LAYER(draw, x, y, cx, cy) {draw, x, y, cx, cy}
+
+// statistics, costs in us and lateness in ms
+typedef struct {
+  unsigned long frames;
+  unsigned long layers;     // layers drawn
+  unsigned long coalesced;  // invalidations that joined a pending frame
+  unsigned long missed;
+  unsigned long late_max;
+  unsigned long cost_max;   // drawing and flushing
+  unsigned long cost_sum;
+  unsigned long flush_max;  // flushing alone
+  unsigned long flush_sum;
+} olv_render_stats;
+
+extern olv_render_stats olv_render;
+
+// broadcast after every flush, from the scheduler thread
+extern EventSource olv_render_flushed;
+
+// the layers in z order, the first one is at the bottom. period is the
+// minimum time between two frames in ms.
+void olv_render_init (const olv_layer* layers, uint8_t count, unsigned long period);
+
+// changes the minimum time between two frames
+void olv_render_set_period (unsigned long period);
+
+// marks layers as invalid, bit n is layer n. from the scheduler thread.
+void olv_render_invalidate (uint8_t mask);
+
+// hands the framebuffer to another writer (olv_push/push.h). while remote
+// the layers are not drawn, invalidations wait until the framebuffer is
+// given back and then everything is drawn again. from the scheduler thread.
+void olv_render_remote (bool_t on);
+
+// schedules a frame that only flushes, for what the remote writer changed
+void olv_render_frame (void);
+
+#endif
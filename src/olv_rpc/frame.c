@@ -0,0 +1,62 @@
+
+#include "frame.h"
+
+// crc of the high nibble of a byte, the low nibble is another round
+static const uint16_t olv_frame_crc_table[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t olv_frame_crc (uint16_t crc, const uint8_t* p, size_t n) {
+
+  while (n--) {
+    crc = (uint16_t)(crc << 4) ^ olv_frame_crc_table[(crc >> 12) ^ (*p >> 4)];
+    crc = (uint16_t)(crc << 4) ^ olv_frame_crc_table[(crc >> 12) ^ (*p++ & 0x0F)];
+  }
+
+  return crc;
+};
+
+size_t olv_frame_encode (uint8_t* out, const uint8_t* msg, size_t n) {
+
+  uint16_t crc = olv_frame_crc(0xFFFF, msg, n);
+  uint8_t* code = out;
+  uint8_t* o = out +1;
+  uint8_t b;
+  size_t i;
+
+  // the crc goes through the encoder after the message
+  for (i = 0; i < n +2; i++) {
+    b = i < n ? msg[i] : i == n ? crc >> 8 : crc & 0xFF;
+    if (b) *o++ = b;
+    // a zero or a full block of 254 bytes ends the block
+    if (!b || o -code == 0xFF) {
+      *code = (uint8_t)(o -code);
+      code = o++;
+    }
+  }
+  *code = (uint8_t)(o -code);
+  *o++ = 0;
+
+  return (size_t)(o -out);
+};
+
+long olv_frame_decode (uint8_t* buf, size_t n) {
+
+  const uint8_t* in = buf;
+  const uint8_t* end = buf +n;
+  uint8_t* o = buf;
+  uint8_t code, i;
+
+  while (in < end) {
+    code = *in++;
+    if (!code || (size_t)(end -in) < (size_t)code -1) return -1;
+    for (i = 1; i < code; i++) *o++ = *in++;
+    // a full block has no zero after it, neither has the last one
+    if (code != 0xFF && in < end) *o++ = 0;
+  }
+
+  if (o -buf < 2 || olv_frame_crc(0xFFFF, buf, (size_t)(o -buf)) != 0) return -1;
+
+  return (long)(o -buf) -2;
+};
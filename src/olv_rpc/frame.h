@@ -0,0 +1,28 @@
+
+#ifndef OLV_FRAME
+#define OLV_FRAME
+
+// framing of the rpc link, plain c so tools/rpctool builds it as well.
+//
+// a frame is the message followed by its crc (crc-16/ccitt-false, high
+// byte first), cobs encoded and ended by a zero byte. the encoded frame
+// has no other zero byte, so a receiver that lost track starts over at
+// the next zero. cobs adds one byte per 254 bytes of the frame.
+
+#include <stdint.h>
+#include <stddef.h>
+
+// bytes an encoded frame of n message bytes takes, with the zero at its end
+#define OLV_FRAME_ENCODED(n) ((n) +2 +((n) +2) /254 +2)
+
+uint16_t olv_frame_crc (uint16_t crc, const uint8_t* p, size_t n);
+
+// encodes n bytes of msg with their crc and the zero to out, which holds
+// OLV_FRAME_ENCODED(n) bytes. returns the bytes written.
+size_t olv_frame_encode (uint8_t* out, const uint8_t* msg, size_t n);
+
+// decodes the n bytes of a frame without its zero, in place. returns the
+// bytes of the message without the crc, or -1 when the frame is broken.
+long olv_frame_decode (uint8_t* buf, size_t n);
+
+#endif
@@ -0,0 +1,126 @@
+
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+
+#include "frame.h"
+#include "rpc.h"
+
+// id, cmd or status and the payload
+#define OLV_RPC_MSG (2 +OLV_RPC_PAYLOAD)
+#define OLV_RPC_STALL MS2ST(1000)
+
+olv_rpc_stats olv_rpc = {0};
+
+// the frame being received, still encoded
+static uint8_t olv_rpc_frame[OLV_FRAME_ENCODED(OLV_RPC_MSG) -1];
+static size_t olv_rpc_frame_len;
+static uint8_t olv_rpc_overflow;
+
+static uint8_t olv_rpc_in[64];
+static uint8_t olv_rpc_res[OLV_RPC_MSG];
+
+// the encoded responses of a batch
+static uint8_t olv_rpc_out[256];
+static size_t olv_rpc_out_len;
+static uint8_t olv_rpc_stalled;
+static uint8_t olv_rpc_done;
+
+uint32_t olv_rpc_u32 (const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+};
+
+void olv_rpc_put_u32 (uint8_t* p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+};
+
+static void olv_rpc_flush (BaseChannel* chp) {
+
+  if (olv_rpc_out_len && !olv_rpc_stalled &&
+      chnWriteTimeout(chp, olv_rpc_out, olv_rpc_out_len, OLV_RPC_STALL) != olv_rpc_out_len)
+    olv_rpc_stalled = 1;
+
+  if (olv_rpc_out_len) olv_rpc.batches++;
+  olv_rpc.bytes_out += olv_rpc_out_len;
+  olv_rpc_out_len = 0;
+};
+
+// decodes and answers the frame received, len 0 for one that overflowed
+static void olv_rpc_request (BaseChannel* chp, const olv_rpc_command* commands, size_t len) {
+
+  long m = len ? olv_frame_decode(olv_rpc_frame, len) : -1;
+  olv_rpc_call c;
+  uint8_t status;
+
+  c.arg = olv_rpc_frame +2;
+  c.arg_n = m > 2 ? (size_t)m -2 : 0;
+  c.res = olv_rpc_res +2;
+  c.res_n = 0;
+
+  if (m < 2) status = OLV_RPC_EFRAME;
+  else if (olv_rpc_frame[1] == OLV_RPC_PING) {
+    memcpy(c.res, c.arg, c.arg_n);
+    c.res_n = c.arg_n;
+    status = OLV_RPC_OK;
+  }
+  else if (olv_rpc_frame[1] == OLV_RPC_EXIT) {
+    olv_rpc_done = 1;
+    status = OLV_RPC_OK;
+  }
+  else {
+    while (commands->fn && commands->cmd != olv_rpc_frame[1]) commands++;
+    status = commands->fn ? commands->fn(&c) : OLV_RPC_ECMD;
+  }
+
+  olv_rpc.requests++;
+  if (status != OLV_RPC_OK) {
+    olv_rpc.errors++;
+    c.res_n = 0;
+  }
+
+  olv_rpc_res[0] = m > 0 ? olv_rpc_frame[0] : 0;
+  olv_rpc_res[1] = status;
+
+  if (sizeof(olv_rpc_out) -olv_rpc_out_len < OLV_FRAME_ENCODED(OLV_RPC_MSG)) olv_rpc_flush(chp);
+  olv_rpc_out_len += olv_frame_encode(olv_rpc_out +olv_rpc_out_len, olv_rpc_res, 2 +c.res_n);
+};
+
+void olv_rpc_run (BaseChannel* chp, const olv_rpc_command* commands) {
+
+  size_t n, i;
+  msg_t b;
+
+  memset(&olv_rpc, 0, sizeof(olv_rpc));
+  olv_rpc_frame_len = olv_rpc_out_len = 0;
+  olv_rpc_overflow = olv_rpc_stalled = olv_rpc_done = 0;
+
+  if (chnWriteTimeout(chp, (const uint8_t*)"OC", 2, OLV_RPC_STALL) != 2) return;
+
+  while (!olv_rpc_done && !olv_rpc_stalled) {
+    // whatever is queued in one go, the responses wait while more comes
+    n = chnReadTimeout(chp, olv_rpc_in, sizeof(olv_rpc_in), TIME_IMMEDIATE);
+    if (!n) {
+      olv_rpc_flush(chp);
+      if ((b = chnGetTimeout(chp, MS2ST(OLV_RPC_IDLE))) < 0) break;
+      olv_rpc_in[0] = (uint8_t)b;
+      n = 1;
+    }
+    olv_rpc.bytes_in += n;
+
+    for (i = 0; i < n && !olv_rpc_done; i++) {
+      if (olv_rpc_in[i]) {
+        if (olv_rpc_frame_len < sizeof(olv_rpc_frame)) olv_rpc_frame[olv_rpc_frame_len++] = olv_rpc_in[i];
+        else olv_rpc_overflow = 1;
+        continue;
+      }
+      if (olv_rpc_overflow || olv_rpc_frame_len) olv_rpc_request(chp, commands, olv_rpc_overflow ? 0 : olv_rpc_frame_len);
+      olv_rpc_frame_len = 0;
+      olv_rpc_overflow = 0;
+    }
+  }
+
+  olv_rpc_flush(chp);
+};
@@ -0,0 +1,76 @@
+
+#ifndef OLV_RPC
+#define OLV_RPC
+
+// binary remote calls over the usb serial link, for host tools and test
+// rigs instead of typing shell commands.
+//
+// olv_rpc_run() takes over the serial port of the shell until the host
+// ends it. the watch sends 'O' 'C' once it listens, from then on both
+// sides send frames (olv_rpc/frame.h), a request is
+//   id:u8 cmd:u8 args
+// and its response
+//   id:u8 status:u8 result
+// numbers little endian. the host picks the ids, the responses come in
+// the order of the requests, the id is a check. the host does not have
+// to wait for one, it may send many requests in one go: they are answered
+// as they are taken from the input queue, and the responses go out
+// together once the queue is empty or the output buffer full. a broken
+// frame is answered with OLV_RPC_EFRAME and id 0, an empty frame is
+// skipped, so the host may send a zero to start clean.
+//
+// the commands are looked up in the table given to olv_rpc_run(), like
+// the commands of the shell. two are built in:
+//   OLV_RPC_PING  the result is the args
+//   OLV_RPC_EXIT  answered, then back to the shell
+// rpc mode also ends when no byte arrives for OLV_RPC_IDLE ms.
+
+#include "ch.h"
+#include "hal.h"
+
+#define OLV_RPC_IDLE 10000
+
+// the longest args and result
+#define OLV_RPC_PAYLOAD 64
+
+#define OLV_RPC_PING 0x00
+#define OLV_RPC_EXIT 0xFF
+
+#define OLV_RPC_OK 0
+#define OLV_RPC_EFRAME 1  // broken frame, bad crc
+#define OLV_RPC_ECMD 2    // unknown command
+#define OLV_RPC_EARG 3    // wrong args
+
+typedef struct {
+  const uint8_t* arg;
+  size_t arg_n;
+  uint8_t* res;           // OLV_RPC_PAYLOAD bytes
+  size_t res_n;           // 0 on the call
+} olv_rpc_call;
+
+// returns the status
+typedef uint8_t (*olv_rpc_fn) (olv_rpc_call* c);
+
+typedef struct {
+  uint8_t cmd;
+  olv_rpc_fn fn;
+} olv_rpc_command;
+
+typedef struct {
+  unsigned long requests;
+  unsigned long errors;   // broken frames, unknown commands, wrong args
+  unsigned long batches;  // writes of responses
+  unsigned long bytes_in;
+  unsigned long bytes_out;
+} olv_rpc_stats;
+
+extern olv_rpc_stats olv_rpc;
+
+// the table ends with a NULL fn. from the shell thread.
+void olv_rpc_run (BaseChannel* chp, const olv_rpc_command* commands);
+
+// little endian args and results
+uint32_t olv_rpc_u32 (const uint8_t* p);
+void olv_rpc_put_u32 (uint8_t* p, uint32_t v);
+
+#endif
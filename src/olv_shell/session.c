@@ -0,0 +1,235 @@
+
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+
+#include "chprintf.h"
+#include "session.h"
+
+olv_shell_stats olv_shell = {0};
+
+// a job line longer than this goes out in parts
+#define OLV_SHELL_JOB_LINE 80
+
+// a stream over the channel of a session whose output takes the output
+// lock, at once or a line at a time
+typedef struct {
+  const struct BaseSequentialStreamVMT* vmt;
+  olv_shell_session* session;
+  uint8_t* line;              // NULL writes through
+  size_t n;
+} olv_shell_stream;
+
+static void olv_shell_flush (olv_shell_stream* st) {
+
+  if (!st->n) return;
+
+  chMtxLock(&st->session->output);
+  (void)chSequentialStreamWrite(st->session->config->shell->sc_channel, st->line, st->n);
+  chMtxUnlock();
+  st->n = 0;
+};
+
+static size_t olv_shell_write (void* ip, const uint8_t* bp, size_t n) {
+
+  olv_shell_stream* st = (olv_shell_stream*)ip;
+  size_t i;
+
+  if (!st->line) {
+    chMtxLock(&st->session->output);
+    n = chSequentialStreamWrite(st->session->config->shell->sc_channel, bp, n);
+    chMtxUnlock();
+    return n;
+  }
+
+  for (i = 0; i < n; i++) {
+    st->line[st->n++] = bp[i];
+    if (bp[i] == '\n' || st->n == OLV_SHELL_JOB_LINE) olv_shell_flush(st);
+  }
+  return n;
+};
+
+static size_t olv_shell_read (void* ip, uint8_t* bp, size_t n) {
+  return chSequentialStreamRead(((olv_shell_stream*)ip)->session->config->shell->sc_channel, bp, n);
+};
+
+static msg_t olv_shell_put (void* ip, uint8_t b) {
+  return olv_shell_write(ip, &b, 1) == 1 ? RDY_OK : Q_RESET;
+};
+
+static msg_t olv_shell_get (void* ip) {
+  return chSequentialStreamGet(((olv_shell_stream*)ip)->session->config->shell->sc_channel);
+};
+
+static const struct BaseSequentialStreamVMT olv_shell_vmt = {
+  olv_shell_write, olv_shell_read, olv_shell_put, olv_shell_get
+};
+
+// the job, its line is a copy of the session's
+static struct {
+  olv_shell_session* session;
+  shellcmd_t fn;
+  char line[SHELL_MAX_LINE_LENGTH];
+  char* args[SHELL_MAX_ARGUMENTS +1];
+  int argc;
+} olv_shell_job;
+
+static Semaphore olv_shell_job_start;
+static Semaphore olv_shell_job_idle;
+
+static uint8_t olv_shell_job_line[OLV_SHELL_JOB_LINE];
+static olv_shell_stream olv_shell_job_out = {&olv_shell_vmt, NULL, olv_shell_job_line, 0};
+
+static WORKING_AREA(olvShellJobWorkplace, OLV_SHELL_JOB_STACK);
+
+static msg_t olvShellJobThread (void *arg) {
+  (void)arg;
+
+  BaseSequentialStream* chp = (BaseSequentialStream*)&olv_shell_job_out;
+  systime_t start;
+  unsigned long ms;
+
+  chRegSetThreadName("shell job");
+
+  while (TRUE) {
+    chSemWait(&olv_shell_job_start);
+
+    olv_shell_job_out.session = olv_shell_job.session;
+    start = chTimeNow();
+    olv_shell_job.fn(chp, olv_shell_job.argc, olv_shell_job.args);
+    ms = (unsigned long)(chTimeNow() -start) *1000 /CH_FREQUENCY;
+    if (ms > olv_shell.ms_max) olv_shell.ms_max = ms;
+    olv_shell.running = NULL;
+
+    // the last line goes out with the prompt
+    chprintf(chp, "ch> ");
+    olv_shell_flush(&olv_shell_job_out);
+    chSemSignal(&olv_shell_job_idle);
+  }
+
+  return 0;
+};
+
+// the function of cmd when it runs as a job, else NULL
+static shellcmd_t olv_shell_job_fn (const olv_shell_config* config, const char* cmd) {
+
+  const ShellCommand* c = config->shell->sc_commands;
+  const shellcmd_t* j;
+
+  if (!c || !config->jobs) return NULL;
+
+  while (c->sc_name && strcasecmp(c->sc_name, cmd)) c++;
+  if (!c->sc_name) return NULL;
+
+  for (j = config->jobs; *j; j++)
+    if (*j == c->sc_function) return *j;
+
+  return NULL;
+};
+
+// locked, a session may start while connected, at most one count
+static void olv_shell_kickI (olv_shell_session* s) {
+  if (s->connected && chSemGetCounterI(&s->connect) < 1) chSemSignalI(&s->connect);
+};
+
+static msg_t olvShellThread (void *arg) {
+
+  olv_shell_session* s = (olv_shell_session*)arg;
+  const ShellConfig* scp = s->config->shell;
+  // the echo and the prompts, the commands and binary modes get the channel
+  olv_shell_stream out = {&olv_shell_vmt, s, NULL, 0};
+  BaseSequentialStream* chp = (BaseSequentialStream*)&out;
+  char line[SHELL_MAX_LINE_LENGTH];
+  char* args[SHELL_MAX_ARGUMENTS +1];
+  char* cmd;
+  shellcmd_t fn;
+  bool_t prompt, done;
+  int n;
+
+  chRegSetThreadName(s->config->name);
+
+  while (TRUE) {
+    chSemWait(&s->connect);
+    s->sessions++;
+    chprintf(chp, "\r\nChibiOS/RT Shell\r\n");
+
+    for (prompt = TRUE, done = FALSE; !done; ) {
+      if (prompt) chprintf(chp, "ch> ");
+      if (shellGetLine(chp, line, sizeof(line))) {
+        chprintf(chp, "\r\nlogout");
+        break;
+      }
+
+      // typed while a job ran, it goes after the job
+      if (chSemWaitTimeout(&olv_shell_job_idle, TIME_IMMEDIATE) != RDY_OK) {
+        s->waits++;
+        chSemWait(&olv_shell_job_idle);
+      }
+
+      prompt = TRUE;
+      if ((cmd = shellParse(chp, line, &n, args)) == NULL) {
+        chSemSignal(&olv_shell_job_idle);
+        continue;
+      }
+      s->commands++;
+
+      if ((fn = olv_shell_job_fn(s->config, cmd)) != NULL) {
+        // the job thread gives the idle count back and prompts
+        memcpy(olv_shell_job.line, line, sizeof(line));
+        olv_shell_job.argc = n;
+        olv_shell_job.args[n] = NULL;
+        while (n--) olv_shell_job.args[n] = olv_shell_job.line +(args[n] -line);
+        olv_shell_job.session = s;
+        olv_shell_job.fn = fn;
+        olv_shell.running = olv_shell_job.line +(cmd -line);
+        s->jobs++;
+        prompt = FALSE;
+        chSemSignal(&olv_shell_job_start);
+        continue;
+      }
+
+      chSemSignal(&olv_shell_job_idle);
+      done = shellExec(scp, cmd, n, args);
+    }
+
+    chSysLock();
+    olv_shell_kickI(s);
+    chSysUnlock();
+  }
+
+  return 0;
+};
+
+void olv_shell_init (void) {
+
+  chSemInit(&olv_shell_job_start, 0);
+  chSemInit(&olv_shell_job_idle, 1);
+
+  (void)chThdCreateStatic(olvShellJobWorkplace, sizeof(olvShellJobWorkplace), NORMALPRIO, olvShellJobThread, NULL);
+};
+
+void olv_shell_start (olv_shell_session* s, const olv_shell_config* config, void* wa, size_t size, tprio_t prio) {
+
+  s->config = config;
+  s->connected = 0;
+  chSemInit(&s->connect, 0);
+  chMtxInit(&s->output);
+
+  (void)chThdCreateStatic(wa, size, prio, olvShellThread, s);
+};
+
+void olv_shell_connectI (olv_shell_session* s) {
+
+  s->connected = 1;
+  olv_shell_kickI(s);
+};
+
+void olv_shell_disconnectI (olv_shell_session* s) {
+
+  s->connected = 0;
+  if (chSemGetCounterI(&s->connect) > 0) chSemFastWaitI(&s->connect);
+
+  // a session waiting for input logs out, output waiting for room goes on
+  if (s->config->input) chIQResetI(s->config->input);
+  if (s->config->output) chOQResetI(s->config->output);
+};
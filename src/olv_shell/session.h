@@ -0,0 +1,74 @@
+
+#ifndef OLV_SHELL
+#define OLV_SHELL
+
+// shell sessions on statically allocated threads, started and ended by
+// the link instead of being polled for.
+//
+// each session has a thread of its own, created once by olv_shell_start()
+// on a working area of the caller, which waits until the link comes up:
+// the usb event handler calls olv_shell_connectI() when the device is
+// configured or resumes, and the prompt follows at once. on a reset or a
+// suspend olv_shell_disconnectI() resets the queues of the channel, the
+// session logs out and its thread waits for the next connect. "exit"
+// starts a new session while the link is up. nothing is allocated, a
+// reconnect leaves the heap alone.
+//
+// the commands are the ones of shell.h, run with shellExec(). those whose
+// function is in the jobs list of the session run deferred on the job
+// thread, which prints the prompt when they are done: the session reads
+// and echoes the next line meanwhile, and waits for the job only before
+// running it. jobs are for commands that print a lot or wait for the
+// hardware, they must not read the channel. the output of the job and the
+// echo of the session go through the output lock of the session, the job
+// a line at a time, so the echo only lands between the lines of a job. the binary modes (stream,
+// push, rpc) take over the channel and stay in the session thread.
+//
+// one job runs at a time, for all sessions.
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+
+// working areas, enough for chprintf() and the binary modes. perf shows
+// the stack left of every thread.
+#define OLV_SHELL_STACK 1024
+#define OLV_SHELL_JOB_STACK 768
+
+typedef struct {
+  const ShellConfig* shell;   // the channel and every command
+  const shellcmd_t* jobs;     // run as deferred jobs, NULL ended
+  InputQueue* input;          // of the channel, reset on a disconnect
+  OutputQueue* output;
+  const char* name;           // of the thread
+} olv_shell_config;
+
+typedef struct {
+  const olv_shell_config* config;
+  Semaphore connect;          // one count while a session may start
+  Mutex output;               // the echo and the lines of the job
+  uint8_t connected;
+  unsigned long sessions;
+  unsigned long commands;
+  unsigned long jobs;
+  unsigned long waits;        // lines typed ahead of a job
+} olv_shell_session;
+
+typedef struct {
+  unsigned long ms_max;       // the longest job
+  const char* running;        // the command of the job running, or NULL
+} olv_shell_stats;
+
+extern olv_shell_stats olv_shell;
+
+// once, before the first olv_shell_start()
+void olv_shell_init (void);
+
+// before usbStart(), wa is a WORKING_AREA of OLV_SHELL_STACK
+void olv_shell_start (olv_shell_session* s, const olv_shell_config* config, void* wa, size_t size, tprio_t prio);
+
+// from the usb event handler, locked
+void olv_shell_connectI (olv_shell_session* s);
+void olv_shell_disconnectI (olv_shell_session* s);
+
+#endif
@@ -0,0 +1,165 @@
+
+// tools/screenrx builds the encoder of this file on the host
+#ifndef OLV_STREAM_HOST
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+
+#include "olv_render/render.h"
+#endif
+
+#include "stream.h"
+
+#define OLV_STREAM_PIXELS (OLV_STREAM_TILE *OLV_STREAM_TILE)
+#define OLV_STREAM_STALL MS2ST(1000)
+
+olv_stream_stats olv_stream = {0};
+
+// the hashes of the tiles as sent and as they are now
+static uint32_t olv_stream_hash[OLV_STREAM_TILES];
+static uint32_t olv_stream_now[OLV_STREAM_TILES];
+
+// output is collected in full usb packets
+static uint8_t olv_stream_buf[64];
+static uint8_t olv_stream_len;
+static uint8_t olv_stream_stalled;
+static unsigned long olv_stream_bytes;
+
+static void olv_stream_flush (BaseChannel* chp) {
+
+  if (olv_stream_len && !olv_stream_stalled &&
+      chnWriteTimeout(chp, olv_stream_buf, olv_stream_len, OLV_STREAM_STALL) != olv_stream_len)
+    olv_stream_stalled = 1;
+
+  olv_stream_bytes += olv_stream_len;
+  olv_stream_len = 0;
+};
+
+static void olv_stream_put (BaseChannel* chp, uint8_t b) {
+
+  olv_stream_buf[olv_stream_len++] = b;
+  if (olv_stream_len == sizeof(olv_stream_buf)) olv_stream_flush(chp);
+};
+
+// the first pixel of a tile, the next row is FRAMEBUFFER_WIDTH further on
+static const uint16_t* olv_stream_tile (uint8_t t) {
+  return (const uint16_t*)FRAMEBUFFER_ADDRESS +(t /OLV_STREAM_TILES_X) *OLV_STREAM_TILE *FRAMEBUFFER_WIDTH
+    +(t %OLV_STREAM_TILES_X) *OLV_STREAM_TILE;
+};
+
+#define OLV_STREAM_PIXEL(tile, i) ((tile)[((i) /OLV_STREAM_TILE) *FRAMEBUFFER_WIDTH +(i) %OLV_STREAM_TILE])
+
+// fnv-1a over two pixels at a time
+static uint32_t olv_stream_hash_tile (const uint16_t* tile) {
+
+  const uint32_t* row;
+  uint32_t h = 2166136261UL;
+  uint8_t y, x;
+
+  for (y = 0; y < OLV_STREAM_TILE; y++) {
+    row = (const uint32_t*)(tile +y *FRAMEBUFFER_WIDTH);
+    for (x = 0; x < OLV_STREAM_TILE /2; x++) h = (h ^ row[x]) *16777619UL;
+  }
+
+  return h;
+};
+
+// runs may cross rows, literals end with the row so they stay contiguous
+static void olv_stream_encode (BaseChannel* chp, const uint16_t* tile) {
+
+  const uint8_t* lit = NULL;
+  uint16_t i = 0, n;
+  uint8_t nlit = 0, k;
+  uint16_t px;
+
+  while (i < OLV_STREAM_PIXELS) {
+
+    px = OLV_STREAM_PIXEL(tile, i);
+    for (n = 1; i +n < OLV_STREAM_PIXELS && n < 128 && OLV_STREAM_PIXEL(tile, i +n) == px; n++);
+
+    if (nlit && (n > 1 || i %OLV_STREAM_TILE == 0)) {
+      olv_stream_put(chp, nlit -1);
+      for (k = 0; k < nlit *2; k++) olv_stream_put(chp, lit[k]);
+      nlit = 0;
+    }
+
+    if (n > 1) {
+      olv_stream_put(chp, 0x80 +n -1);
+      olv_stream_put(chp, ((const uint8_t*)&OLV_STREAM_PIXEL(tile, i))[0]);
+      olv_stream_put(chp, ((const uint8_t*)&OLV_STREAM_PIXEL(tile, i))[1]);
+      i += n;
+    } else {
+      if (!nlit) lit = (const uint8_t*)&OLV_STREAM_PIXEL(tile, i);
+      nlit++;
+      i++;
+    }
+  }
+
+  if (nlit) {
+    olv_stream_put(chp, nlit -1);
+    for (k = 0; k < nlit *2; k++) olv_stream_put(chp, lit[k]);
+  }
+};
+
+static void olv_stream_frame (BaseChannel* chp, uint16_t seq, uint8_t all) {
+
+  uint32_t* h = olv_stream_now;
+  uint8_t t, count = 0;
+  unsigned long start = olv_stream_bytes;
+
+  for (t = 0; t < OLV_STREAM_TILES; t++) {
+    h[t] = olv_stream_hash_tile(olv_stream_tile(t));
+    if (all || h[t] != olv_stream_hash[t]) count++;
+  }
+
+  olv_stream_put(chp, 'O');
+  olv_stream_put(chp, 'F');
+  olv_stream_put(chp, seq &0xFF);
+  olv_stream_put(chp, seq >> 8);
+  olv_stream_put(chp, count);
+
+  for (t = 0; t < OLV_STREAM_TILES; t++) {
+    if (!all && h[t] == olv_stream_hash[t]) continue;
+    olv_stream_hash[t] = h[t];
+    olv_stream_put(chp, t);
+    olv_stream_encode(chp, olv_stream_tile(t));
+  }
+  olv_stream_flush(chp);
+
+  olv_stream.frames++;
+  olv_stream.tiles += count;
+  olv_stream.bytes += olv_stream_bytes -start;
+  if (olv_stream_bytes -start > olv_stream.bytes_max) olv_stream.bytes_max = olv_stream_bytes -start;
+};
+
+void olv_stream_run (BaseChannel* chp, unsigned long frames) {
+
+  EventListener el;
+  unsigned long rendered = olv_render.frames;
+
+  memset(&olv_stream, 0, sizeof(olv_stream));
+  olv_stream_len = 0;
+  olv_stream_stalled = 0;
+  olv_stream_bytes = 0;
+
+  chEvtRegisterMask(&olv_render_flushed, &el, EVENT_MASK(0));
+
+  // the current screen first, it may not change for a while
+  olv_stream_frame(chp, 0, 1);
+
+  while ((!frames || olv_stream.frames < frames) && !olv_stream_stalled &&
+      chnGetTimeout(chp, TIME_IMMEDIATE) == Q_TIMEOUT) {
+    // a flush during the last frame is pending already, flushes in between are skipped
+    if (chEvtWaitAnyTimeout(EVENT_MASK(0), MS2ST(100)))
+      olv_stream_frame(chp, (uint16_t)olv_stream.frames, 0);
+  }
+
+  chEvtUnregister(&olv_render_flushed, &el);
+  chEvtGetAndClearEvents(EVENT_MASK(0));
+
+  olv_stream.rendered = olv_render.frames -rendered;
+
+  olv_stream_put(chp, 'O');
+  olv_stream_put(chp, 'E');
+  olv_stream_flush(chp);
+};
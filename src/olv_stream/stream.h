@@ -0,0 +1,55 @@
+
+#ifndef OLV_STREAM
+#define OLV_STREAM
+
+// screen stream over the usb serial link.
+//
+// after every flush of the render event the framebuffer is split into
+// tiles and only the tiles that changed since the last streamed frame are
+// sent. a tile counts as changed when its hash changed, the hashes take
+// 256 bytes instead of a 32 kB copy of the last frame. the changed tiles
+// are run length encoded straight from framebuffer memory into a usb
+// packet buffer. tools/screenrx rebuilds and saves the frames on the host.
+//
+// the stream, all numbers little endian:
+//   frame:  'O' 'F' seq:u16 tiles:u8, then per tile:
+//           index:u8 (row *OLV_STREAM_TILES_X +column) and tokens until
+//           the tile has OLV_STREAM_TILE *OLV_STREAM_TILE pixels
+//   token:  n < 0x80: n +1 literal pixels follow
+//           n >= 0x80: n -0x80 +1 times the pixel that follows
+//   pixel:  rgb565 high byte first, as in the framebuffer
+//   end:    'O' 'E'
+// the tiles are in the panel orientation and in row order within a tile,
+// the first frame sends all of them.
+//
+// the framebuffer is read while the scheduler thread may draw into it. a
+// tile is hashed before it is sent, so a tile that changed in between
+// differs from its hash on the next frame and is sent again.
+
+// the host build provides the framebuffer and the channel itself
+#ifndef OLV_STREAM_HOST
+#include "ch.h"
+#include "hal.h"
+#include "framebuffer_draw.h"
+#endif
+
+#define OLV_STREAM_TILE 16
+#define OLV_STREAM_TILES_X (FRAMEBUFFER_WIDTH /OLV_STREAM_TILE)
+#define OLV_STREAM_TILES (OLV_STREAM_TILES_X *(FRAMEBUFFER_HEIGHT /OLV_STREAM_TILE))
+
+// statistics of the last stream
+typedef struct {
+  unsigned long frames;     // frames sent
+  unsigned long rendered;   // frames flushed by the render event meanwhile
+  unsigned long tiles;      // tiles sent
+  unsigned long bytes;      // bytes sent, without the end marker
+  unsigned long bytes_max;  // of a single frame
+} olv_stream_stats;
+
+extern olv_stream_stats olv_stream;
+
+// streams until frames frames were sent (0 streams on), a byte arrives on
+// chp or the link stalls for a second. from the shell thread.
+void olv_stream_run (BaseChannel* chp, unsigned long frames);
+
+#endif
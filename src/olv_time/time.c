@@ -0,0 +1,249 @@
+
+#include "ch.h"
+#include "hal.h"
+
+#include "time.h"
+
+unsigned long olv_time_alarms = 0;
+
+// monotonic time: wraps of the tick counter and its last seen value
+static uint32_t olv_time_wraps = 0;
+static systime_t olv_time_last = 0;
+static VirtualTimer olv_time_vt;
+
+// looks at the tick counter four times per wrap
+#define OLV_TIME_WRAP_CHECK ((systime_t)((systime_t)-1 /4))
+
+// the event the rtc alarm schedules
+static olv_event_pool* olv_time_alarm_ev = NULL;
+
+// seconds olv_time_adjust() has not written yet, see olv_time_adjustI()
+static long olv_time_pending = 0;
+static VirtualTimer olv_time_adjust_vt;
+
+// calendar cache
+static olv_calendar olv_time_cal;
+static uint32_t olv_time_cal_sec;
+static uint32_t olv_time_cal_midnight;
+static uint8_t olv_time_cal_valid = 0;
+
+#define OLV_TIME_DAY 86400UL
+
+// must be called locked
+static uint64_t olv_time_monoI (void) {
+
+  systime_t now = chTimeNow();
+
+  if (now < olv_time_last) olv_time_wraps++;
+  olv_time_last = now;
+
+  return (((uint64_t)olv_time_wraps << (sizeof(systime_t) *8)) | now) *1000 /CH_FREQUENCY;
+};
+
+// virtual timer callbacks run unlocked
+static void olv_time_wrap (void *arg) {
+  (void)arg;
+
+  chSysLockFromIsr();
+  (void)olv_time_monoI();
+  chVTSetI(&olv_time_vt, OLV_TIME_WRAP_CHECK, olv_time_wrap, NULL);
+  chSysUnlockFromIsr();
+};
+
+static void olv_time_rtc (RTCDriver *rtcp, rtcevent_t event) {
+  (void)rtcp;
+
+  if (event != RTC_EVENT_ALARM) return;
+
+  chSysLockFromIsr();
+  olv_time_alarms++;
+  if (olv_time_alarm_ev) {
+    olv_ev_atI(olv_time_alarm_ev, (unsigned long)chTimeNow());
+    olv_time_alarm_ev = NULL;
+  }
+  chSysUnlockFromIsr();
+};
+
+void olv_time_start (void) {
+
+  RTCTime t;
+
+  rtcGetTime(&RTCD1, &t);
+  if (t.tv_sec < OLV_TIME_EPOCH) olv_time_set(OLV_TIME_EPOCH);
+
+  rtcSetCallback(&RTCD1, olv_time_rtc);
+
+  chSysLock();
+  // only the alarm is used, the second interrupt would wake the cpu every second
+  while (!(RTC->CRL & RTC_CRL_RTOFF));
+  RTC->CRH = RTC_CRH_ALRIE;
+
+  olv_time_last = chTimeNow();
+  chVTSetI(&olv_time_vt, OLV_TIME_WRAP_CHECK, olv_time_wrap, NULL);
+  chSysUnlock();
+};
+
+uint64_t olv_time_mono (void) {
+
+  uint64_t ms;
+
+  chSysLock();
+  ms = olv_time_monoI();
+  chSysUnlock();
+
+  return ms;
+};
+
+uint64_t olv_time_now (void) {
+
+  RTCTime t;
+
+  rtcGetTime(&RTCD1, &t);
+  return (uint64_t)t.tv_sec *1000 +t.tv_msec;
+};
+
+uint32_t olv_time_sec (void) {
+
+  RTCTime t;
+
+  rtcGetTime(&RTCD1, &t);
+  return t.tv_sec;
+};
+
+void olv_time_set (uint32_t sec) {
+
+  RTCTime t = {sec, 0};
+
+  chSysLock();
+  // rewriting the prescaler reloads its divider, so the new second starts now
+  rtc_lld_set_prescaler();
+  rtcSetTimeI(&RTCD1, &t);
+  chSysUnlock();
+};
+
+static void olv_time_retry (void *arg);
+
+// writes the pending seconds to the counter, must be called locked. the
+// counter must not tick between reading and writing it, close to a tick
+// a virtual timer tries again after it.
+static void olv_time_adjustI (void) {
+
+  RTCTime t;
+
+  rtcGetTimeI(&RTCD1, &t);
+  if (t.tv_msec >= 990) {
+    if (!chVTIsArmedI(&olv_time_adjust_vt)) chVTSetI(&olv_time_adjust_vt, MS2ST(20), olv_time_retry, NULL);
+    return;
+  }
+
+  t.tv_sec += olv_time_pending;
+  olv_time_pending = 0;
+  rtcSetTimeI(&RTCD1, &t);
+
+  // the counter jumped over or away from the alarm second, the event sets it again
+  if (olv_time_alarm_ev) {
+    olv_ev_atI(olv_time_alarm_ev, (unsigned long)chTimeNow());
+    olv_time_alarm_ev = NULL;
+  }
+};
+
+// virtual timer callbacks run unlocked
+static void olv_time_retry (void *arg) {
+  (void)arg;
+
+  chSysLockFromIsr();
+  olv_time_adjustI();
+  chSysUnlockFromIsr();
+};
+
+void olv_time_adjust (long sec) {
+
+  chSysLock();
+  olv_time_pending += sec;
+  olv_time_adjustI();
+  chSysUnlock();
+};
+
+// days since 1970 to the date, see http://howardhinnant.github.io/date_algorithms.html
+static void olv_time_date (uint32_t days, olv_calendar* c) {
+
+  uint32_t z = days +719468;
+  uint32_t era = z /146097;
+  uint32_t doe = z -era *146097;
+  uint32_t yoe = (doe -doe /1460 +doe /36524 -doe /146096) /365;
+  uint32_t doy = doe -(365 *yoe +yoe /4 -yoe /100);
+  uint32_t mp = (5 *doy +2) /153;
+
+  c->day = doy -(153 *mp +2) /5 +1;
+  c->month = mp < 10 ? mp +3 : mp -9;
+  c->year = yoe +era *400 +(c->month <= 2);
+  // 1970-01-01 was a thursday
+  c->wday = (days +4) %7;
+};
+
+const olv_calendar* olv_time_calendar (uint32_t sec) {
+
+  uint32_t rem = sec -olv_time_cal_sec;
+
+  // most calls are a few seconds later in the same minute
+  if (olv_time_cal_valid && sec >= olv_time_cal_sec && rem < 60u -olv_time_cal.sec) {
+    olv_time_cal.sec += rem;
+    olv_time_cal_sec = sec;
+    return &olv_time_cal;
+  }
+
+  // the date only changes at midnight
+  if (!olv_time_cal_valid || sec < olv_time_cal_midnight || sec -olv_time_cal_midnight >= OLV_TIME_DAY) {
+    olv_time_date(sec /OLV_TIME_DAY, &olv_time_cal);
+    olv_time_cal_midnight = sec -sec %OLV_TIME_DAY;
+    olv_time_cal_valid = 1;
+  }
+
+  rem = sec -olv_time_cal_midnight;
+  olv_time_cal.hour = rem /3600;
+  olv_time_cal.min = rem /60 %60;
+  olv_time_cal.sec = rem %60;
+  olv_time_cal_sec = sec;
+
+  return &olv_time_cal;
+};
+
+void olv_time_split (uint32_t sec, olv_calendar* c) {
+
+  uint32_t rem = sec %OLV_TIME_DAY;
+
+  olv_time_date(sec /OLV_TIME_DAY, c);
+  c->hour = rem /3600;
+  c->min = rem /60 %60;
+  c->sec = rem %60;
+};
+
+uint32_t olv_time_make (const olv_calendar* c) {
+
+  uint32_t y = c->year -(c->month <= 2);
+  uint32_t era = y /400;
+  uint32_t yoe = y -era *400;
+  uint32_t doy = (153 *(c->month > 2 ? c->month -3 : c->month +9) +2) /5 +c->day -1;
+  uint32_t doe = yoe *365 +yoe /4 -yoe /100 +doy;
+
+  return ((era *146097 +doe -719468) *OLV_TIME_DAY) +(uint32_t)c->hour *3600 +c->min *60 +c->sec;
+};
+
+void olv_time_alarm (olv_event_pool* ev, uint32_t sec) {
+
+  RTCAlarm alarm = {sec};
+  RTCTime t;
+
+  chSysLock();
+  olv_time_alarm_ev = NULL;
+  if (ev) {
+    // a few cycles of the rtc clock, under the lock so an alarm of the
+    // last call can not schedule ev in between
+    rtcSetAlarmI(&RTCD1, 0, &alarm);
+    // the second may have passed while the alarm was written
+    rtcGetTimeI(&RTCD1, &t);
+    if (t.tv_sec >= sec) olv_ev_atI(ev, (unsigned long)chTimeNow());
+    else olv_time_alarm_ev = ev;
+  }
+  chSysUnlock();
+};
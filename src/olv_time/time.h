@@ -0,0 +1,71 @@
+
+#ifndef OLV_TIME
+#define OLV_TIME
+
+// wall clock and monotonic time.
+//
+// the wall clock is the rtc counter in the backup domain, seconds since
+// 1970 which keep counting through resets. the monotonic time is the
+// system tick extended to 64 bit, a virtual timer looks at the tick
+// counter often enough to see every wrap.
+//
+// the calendar of the last asked second is cached, the next call only
+// recalculates the fields that changed. olv_time_alarm() lets the rtc
+// alarm schedule an event at a wall clock second, so the face is drawn
+// in step with the rtc and the cpu sleeps through the seconds in between.
+
+#include "olv_events/ev.h"
+
+// the wall clock starts here if the rtc has never been set (2014-01-01 00:00:00)
+#define OLV_TIME_EPOCH 1388534400UL
+
+typedef struct {
+  uint16_t year;
+  uint8_t month;   // 1-12
+  uint8_t day;     // 1-31
+  uint8_t wday;    // 0 is sunday
+  uint8_t hour;
+  uint8_t min;
+  uint8_t sec;
+} olv_calendar;
+
+// rtc alarms that went off
+extern unsigned long olv_time_alarms;
+
+// sets the rtc to OLV_TIME_EPOCH if it never ran and enables the alarm
+// interrupt. must be called after halInit().
+void olv_time_start (void);
+
+// ms since start, does not wrap
+uint64_t olv_time_mono (void);
+
+// wall clock in ms since 1970
+uint64_t olv_time_now (void);
+
+// wall clock in seconds since 1970
+uint32_t olv_time_sec (void);
+
+// sets the wall clock, a new second starts at the call
+void olv_time_set (uint32_t sec);
+
+// moves the wall clock by whole seconds without disturbing the running second.
+// within 10 ms of a tick it is written after the tick, from a virtual timer.
+// the event of olv_time_alarm() runs again once it is written.
+void olv_time_adjust (long sec);
+
+// the cached calendar of a wall clock second for the face, valid until
+// the next call. other threads use olv_time_split().
+const olv_calendar* olv_time_calendar (uint32_t sec);
+
+// the calendar of a wall clock second without the cache
+void olv_time_split (uint32_t sec, olv_calendar* c);
+
+// the wall clock second of a calendar date, wday is ignored
+uint32_t olv_time_make (const olv_calendar* c);
+
+// schedules ev when the rtc reaches the wall clock second sec, replacing
+// the last alarm. a second that already passed schedules ev at once.
+// NULL cancels the alarm.
+void olv_time_alarm (olv_event_pool* ev, uint32_t sec);
+
+#endif
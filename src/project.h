@@ -1,3 +0,0 @@
-
-extern unsigned long time_offset;
-
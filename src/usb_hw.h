@@ -1,15 +1,23 @@
 #include "ch.h"
 #include "usb_cdc.h"
 #include "hal.h"
+#include "olv_power/power.h"
+#include "olv_bulk/bulk.h"
+#include "olv_msc/msc.h"
+#include "olv_perf/perf.h"
+#include "olv_shell/session.h"
 
 #ifndef HEADER_USB
 #define HEADER_USB
 
+// the shell of the serial port, in usb_shell.c
+extern olv_shell_session usb_shell;
+
 static const uint8_t vcom_device_descriptor_data[18] = {
-  USB_DESC_DEVICE       (0x0110,        /* bcdUSB (1.1).                    */
-                         0x02,          /* bDeviceClass (CDC).              */
-                         0x00,          /* bDeviceSubClass.                 */
-                         0x00,          /* bDeviceProtocol.                 */
+  USB_DESC_DEVICE       (0x0200,        /* bcdUSB (2.0), for the IAD.       */
+                         0xEF,          /* bDeviceClass (Miscellaneous).    */
+                         0x02,          /* bDeviceSubClass (Common Class).  */
+                         0x01,          /* bDeviceProtocol (IAD).           */
                          0x40,          /* bMaxPacketSize.                  */
                          0x0483,        /* idVendor (ST).                   */
                          0x5740,        /* idProduct.                       */
@@ -25,14 +33,24 @@ static const USBDescriptor vcom_device_descriptor = {
   vcom_device_descriptor_data
 };
 
-static const uint8_t vcom_configuration_descriptor_data[67] = {
+// the serial port of the shell, grouped by an interface association, and
+// the vendor specific bulk interface of olv_bulk/bulk.h, or with
+// OLV_USE_MSC the mass storage interface of olv_msc/msc.h in its place
+static const uint8_t vcom_configuration_descriptor_data[98] = {
   /* Configuration Descriptor.*/
-  USB_DESC_CONFIGURATION(67,            /* wTotalLength.                    */
-                         0x02,          /* bNumInterfaces.                  */
+  USB_DESC_CONFIGURATION(98,            /* wTotalLength.                    */
+                         0x03,          /* bNumInterfaces.                  */
                          0x01,          /* bConfigurationValue.             */
                          0,             /* iConfiguration.                  */
                          0xC0,          /* bmAttributes (self powered).     */
                          50),           /* bMaxPower (100mA).               */
+  /* Interface Association Descriptor.*/
+  USB_DESC_INTERFACE_ASSOCIATION(0x00,  /* bFirstInterface.                 */
+                         0x02,          /* bInterfaceCount.                 */
+                         0x02,          /* bFunctionClass (CDC).            */
+                         0x02,          /* bFunctionSubClass (ACM).         */
+                         0x01,          /* bFunctionProtocol (AT commands). */
+                         0),            /* iFunction.                       */
   /* Interface Descriptor.*/
   USB_DESC_INTERFACE    (0x00,          /* bInterfaceNumber.                */
                          0x00,          /* bAlternateSetting.               */
@@ -98,6 +116,35 @@ static const uint8_t vcom_configuration_descriptor_data[67] = {
   USB_DESC_ENDPOINT     (USB_CDC_DATA_REQUEST_EP|0x80,  /* bEndpointAddress.*/
                          0x02,          /* bmAttributes (Bulk).             */
                          0x0040,        /* wMaxPacketSize.                  */
+                         0x00),         /* bInterval.                       */
+  /* Interface Descriptor.*/
+#if OLV_USE_MSC
+  USB_DESC_INTERFACE    (OLV_BULK_INTERFACE, /* bInterfaceNumber.           */
+                         0x00,          /* bAlternateSetting.               */
+                         0x02,          /* bNumEndpoints.                   */
+                         0x08,          /* bInterfaceClass (Mass Storage).  */
+                         0x06,          /* bInterfaceSubClass (SCSI
+                                           transparent).                    */
+                         0x50,          /* bInterfaceProtocol (Bulk Only).  */
+                         0x00),         /* iInterface.                      */
+#else
+  USB_DESC_INTERFACE    (OLV_BULK_INTERFACE, /* bInterfaceNumber.           */
+                         0x00,          /* bAlternateSetting.               */
+                         0x02,          /* bNumEndpoints.                   */
+                         0xFF,          /* bInterfaceClass (Vendor).        */
+                         0x00,          /* bInterfaceSubClass.              */
+                         0x00,          /* bInterfaceProtocol.              */
+                         0x00),         /* iInterface.                      */
+#endif
+  /* Endpoint 3 Descriptor.*/
+  USB_DESC_ENDPOINT     (OLV_BULK_IN_EP|0x80,           /* bEndpointAddress.*/
+                         0x02,          /* bmAttributes (Bulk).             */
+                         OLV_BULK_PACKET, /* wMaxPacketSize.                */
+                         0x00),         /* bInterval.                       */
+  /* Endpoint 4 Descriptor.*/
+  USB_DESC_ENDPOINT     (OLV_BULK_OUT_EP,               /* bEndpointAddress.*/
+                         0x02,          /* bmAttributes (Bulk).             */
+                         OLV_BULK_PACKET, /* wMaxPacketSize.                */
                          0x00)          /* bInterval.                       */
 };
 
@@ -166,13 +213,38 @@ static USBInEndpointState ep1instate;
 
 static USBOutEndpointState ep1outstate;
 
+// the serial driver callbacks, counting the bytes for olv_perf
+static void usb_data_transmitted(USBDriver *usbp, usbep_t ep) {
+  olv_perf.usb_out += usbp->epc[ep]->in_state->txcnt;
+  sduDataTransmitted(usbp, ep);
+};
+
+static void usb_data_received(USBDriver *usbp, usbep_t ep) {
+  olv_perf.usb_in += usbp->epc[ep]->out_state->rxcnt;
+  sduDataReceived(usbp, ep);
+};
+
+#define USB_DATA_PACKET 0x0040
+#define USB_INTERRUPT_PACKET 0x0008
+
+// the 512 bytes of packet memory: 40 for the descriptors of ep0 to ep4
+// (STM32_USB_BTABLE_ENDPOINTS), 128 for ep0, 128 here, 8 for ep2 and 192
+// for the bulk interface, whose out endpoint is double buffered. 496 in
+// all, the usb driver only asserts an overflow at run time.
+#define USB_PMA_USED (STM32_USB_BTABLE_ENDPOINTS *8 +2 *0x40 \
+  +2 *USB_DATA_PACKET +USB_INTERRUPT_PACKET +3 *OLV_BULK_PACKET)
+
+#if USB_PMA_USED > USB_PMA_SIZE
+#error "the endpoint buffers do not fit the packet memory"
+#endif
+
 static const USBEndpointConfig ep1config = {
   USB_EP_MODE_TYPE_BULK,
   NULL,
-  sduDataTransmitted,
-  sduDataReceived,
-  0x0040,
-  0x0040,
+  usb_data_transmitted,
+  usb_data_received,
+  USB_DATA_PACKET,
+  USB_DATA_PACKET,
   &ep1instate,
   &ep1outstate,
   1,
@@ -186,7 +258,7 @@ static const USBEndpointConfig ep2config = {
   NULL,
   sduInterruptTransmitted,
   NULL,
-  0x0010,
+  USB_INTERRUPT_PACKET,
   0x0000,
   &ep2instate,
   NULL,
@@ -198,6 +270,9 @@ static void usb_event(USBDriver *usbp, usbevent_t event) {
 
   switch (event) {
   case USB_EVENT_RESET:
+    chSysLockFromIsr();
+    olv_shell_disconnectI(&usb_shell);
+    chSysUnlockFromIsr();
     return;
   case USB_EVENT_ADDRESS:
     return;
@@ -206,14 +281,30 @@ static void usb_event(USBDriver *usbp, usbevent_t event) {
 
     usbInitEndpointI(usbp, USB_CDC_DATA_REQUEST_EP, &ep1config);
     usbInitEndpointI(usbp, USB_CDC_INTERRUPT_REQUEST_EP, &ep2config);
+    olv_bulk_configureI(usbp);
 
     sduConfigureHookI(usbp);
 
+    // a configured host supplies power, the watch is charging
+    olv_power_usbI(TRUE);
+    // the prompt goes out now
+    olv_shell_connectI(&usb_shell);
+
     chSysUnlockFromIsr();
     return;
   case USB_EVENT_SUSPEND:
+    // also seen when the cable is pulled
+    chSysLockFromIsr();
+    olv_power_usbI(FALSE);
+    olv_shell_disconnectI(&usb_shell);
+    chSysUnlockFromIsr();
     return;
   case USB_EVENT_WAKEUP:
+    chSysLockFromIsr();
+    olv_power_usbI(usbp->state == USB_ACTIVE);
+    if (usbp->state == USB_ACTIVE)
+      olv_shell_connectI(&usb_shell);
+    chSysUnlockFromIsr();
     return;
   case USB_EVENT_STALLED:
     return;
@@ -221,6 +312,17 @@ static void usb_event(USBDriver *usbp, usbevent_t event) {
   return;
 };
 
+// the class requests of the mass storage interface, the rest are the
+// serial port's
+static bool_t usb_requests(USBDriver *usbp) {
+
+#if OLV_USE_MSC
+  if (olv_msc_requests(usbp))
+    return TRUE;
+#endif
+  return sduRequestsHook(usbp);
+};
+
 static const SerialUSBConfig serusbcfg = {
   &USBD1
 };
@@ -228,7 +330,7 @@ static const SerialUSBConfig serusbcfg = {
 static const USBConfig usbcfg = {
   usb_event,
   get_descriptor,
-  sduRequestsHook,
+  usb_requests,
   NULL
 };
 
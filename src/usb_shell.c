@@ -1,13 +1,27 @@
 #include "usb_shell.h"
-#include "project.h"
 
 #include "chprintf.h"
+#include "gdisp.h"
+#include "olv_events/ev.h"
+#include "olv_i2c/i2cq.h"
+#include "olv_input/input.h"
+#include "olv_time/time.h"
+#include "olv_render/render.h"
+#include "olv_power/power.h"
+#include "olv_stream/stream.h"
+#include "olv_push/push.h"
+#include "olv_bulk/bulk.h"
+#include "olv_rpc/rpc.h"
+#include "olv_perf/perf.h"
+#include "olv_asset/asset.h"
+#include "olv_msc/msc.h"
+#include "olv_log/log.h"
 #include <stdlib.h>
+#include <string.h>
 
 static void cmd_mem(BaseSequentialStream *chp, int argc, char *argv[]) {
   (void)argv;
   size_t n, size;
-  int i;
 
   if (argc > 0) {
     chprintf(chp, "Usage: mem\r\n");
@@ -24,26 +38,327 @@ static void cmd_mem(BaseSequentialStream *chp, int argc, char *argv[]) {
   // will return the bluetooth address and serial number within the device.
   chprintf(chp, "HW Informations:\r\n");
 
-  for (i = 0; i < 43; i++) {
-    chprintf(chp, "%c", ((char*)0x0803E800)[i]);
-    // internal offset: 134473728 = 0x0803E800
-    // fw.bin offset: 243712 = 0x0003B800
-  }
+  // internal offset: 134473728 = 0x0803E800
+  // fw.bin offset: 243712 = 0x0003B800
+  chSequentialStreamWrite(chp, (const uint8_t*)0x0803E800, 43);
 
   chprintf(chp, "\r\n");
 };
 
+// parses a decimal number within min and max, returns -1 otherwise
+static long shell_number(const char *s, long min, long max) {
+  char *end;
+  long n = strtol(s, &end, 10);
+
+  return (*s && !*end && n >= min && n <= max) ? n : -1;
+};
+
 static void cmd_set_time(BaseSequentialStream *chp, int argc, char *argv[]) {
-  if (argc != 3) {
-    chprintf(chp, "Usage: set_time hh mm ss\r\n");
+  static const long min[6] = {1970, 1, 1, 0, 0, 0};
+  static const long max[6] = {2105, 12, 31, 23, 59, 59};
+  olv_calendar c;
+  long v[6];
+  int i;
+
+  if (argc != 3 && argc != 6) {
+    chprintf(chp, "Usage: set_time [yyyy mm dd] hh mm ss\r\n");
+    return;
+  }
+
+  // without a date the day stays the same
+  olv_time_split(olv_time_sec(), &c);
+
+  for (i = 0; i < argc; i++) {
+    // the time alone uses the last three limits
+    v[i] = shell_number(argv[i], min[i +6 -argc], max[i +6 -argc]);
+    if (v[i] < 0) {
+      chprintf(chp, "invalid number: %s\r\n", argv[i]);
+      return;
+    }
+  }
+
+  if (argc == 6) {
+    c.year = v[0];
+    c.month = v[1];
+    c.day = v[2];
+  }
+  c.hour = v[argc -3];
+  c.min = v[argc -2];
+  c.sec = v[argc -1];
+
+  olv_time_set(olv_time_make(&c));
+};
+
+static void cmd_date(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+  olv_calendar c;
+  uint64_t now, mono;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: date\r\n");
+    return;
+  }
+
+  now = olv_time_now();
+  mono = olv_time_mono();
+  olv_time_split(now /1000, &c);
+
+  chprintf(chp, "wall clock : %04u-%02u-%02u %02u:%02u:%02u.%03u\r\n", c.year, c.month, c.day, c.hour, c.min, c.sec, (unsigned)(now %1000));
+  chprintf(chp, "uptime     : %U s\r\n", (unsigned long)(mono /1000));
+  chprintf(chp, "rtc alarms : %U\r\n", olv_time_alarms);
+};
+
+static void cmd_glyphs(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+  uint32_t hits, misses;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: glyphs\r\n");
+    return;
+  }
+
+  gdispGetGlyphCacheStats(&hits, &misses);
+
+  chprintf(chp, "glyph cache hits   : %U\r\n", hits);
+  chprintf(chp, "glyph cache misses : %U\r\n", misses);
+  chprintf(chp, "glyph cache hitrate: %U%%\r\n", hits + misses ? hits * 100 / (hits + misses) : 0);
+};
+
+static void cmd_i2c(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: i2c\r\n");
+    return;
+  }
+
+  chprintf(chp, "i2c transactions : %U in %U batches\r\n", olv_i2c1.done, olv_i2c1.batches);
+  chprintf(chp, "i2c errors       : %U, %U timeouts\r\n", olv_i2c1.errors, olv_i2c1.timeouts);
+  chprintf(chp, "i2c queued max   : %U us\r\n", olv_i2c1.wait_max);
+  chprintf(chp, "i2c transfer     : %U us avg, %U us max\r\n", olv_i2c1.done ? olv_i2c1.busy_sum / olv_i2c1.done : 0, olv_i2c1.busy_max);
+  chprintf(chp, "button irqs      : %U, %U reads, last latency %U ms\r\n", olv_input_irqs, olv_input_reads, olv_input_latency);
+};
+
+static void cmd_render(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: render\r\n");
+    return;
+  }
+
+  chprintf(chp, "frames           : %U, %U layers drawn\r\n", olv_render.frames, olv_render.layers);
+  chprintf(chp, "coalesced        : %U invalidations\r\n", olv_render.coalesced);
+  chprintf(chp, "frame cost       : %U us avg, %U us max\r\n", olv_render.frames ? olv_render.cost_sum / olv_render.frames : 0, olv_render.cost_max);
+  chprintf(chp, "missed deadlines : %U, %U ms late max\r\n", olv_render.missed, olv_render.late_max);
+};
+
+static void cmd_power(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static const char* const names[] = {"off", "sleep", "dim", "on"};
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: power\r\n");
+    return;
+  }
+
+  chprintf(chp, "display          : %s, %s face\r\n", names[olv_power.display], olv_power.seconds ? "second" : "minute");
+  chprintf(chp, "frame period     : %U ms\r\n", olv_power.frame);
+  chprintf(chp, "changes          : %U\r\n", olv_power_changes);
+};
+
+// binary, see olv_stream/stream.h and tools/screenrx
+static void cmd_stream(BaseSequentialStream *chp, int argc, char *argv[]) {
+  long frames = 0;
+
+  if (argc > 1 || (argc == 1 && (frames = shell_number(argv[0], 1, 1000000)) < 0)) {
+    chprintf(chp, "Usage: stream [frames]\r\n");
+    return;
+  }
+
+  olv_stream_run((BaseChannel *)chp, (unsigned long)frames);
+
+  chprintf(chp, "\r\nframes           : %U sent, %U rendered\r\n", olv_stream.frames, olv_stream.rendered);
+  chprintf(chp, "tiles            : %U\r\n", olv_stream.tiles);
+  chprintf(chp, "frame size       : %U bytes avg, %U bytes max\r\n",
+    olv_stream.frames ? olv_stream.bytes / olv_stream.frames : 0, olv_stream.bytes_max);
+};
+
+// binary, see olv_push/push.h and tools/screentx
+static void cmd_push(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: push\r\n");
+    return;
+  }
+
+  olv_push_run((SerialUSBDriver *)chp);
+
+  chprintf(chp, "\r\nframes           : %U, %U bands\r\n", olv_push.frames, olv_push.bands);
+  chprintf(chp, "received         : %U bytes, %U errors\r\n", olv_push.bytes, olv_push.errors);
+  chprintf(chp, "flush wait       : %U ms max\r\n", olv_push.flush_wait_max);
+};
+
+// the throughput test runs from tools/bulkbench, this shows its result
+static void cmd_bulk(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: bulk\r\n");
+    return;
+  }
+
+  chprintf(chp, "sent             : %U bytes\r\n", olv_bulk.sent);
+  chprintf(chp, "received         : %U bytes, %U errors\r\n", olv_bulk.received, olv_bulk.errors);
+  if (olv_bulk.test)
+    chprintf(chp, "last test        : %s %U bytes in %U ms, %U kB/s\r\n", olv_bulk.test == 'I' ? "in" : "out",
+      olv_bulk.test_bytes, olv_bulk.test_ms, olv_bulk.test_ms ? olv_bulk.test_bytes / olv_bulk.test_ms : 0);
+};
+
+// the pack in the asset region and its uploads
+static void cmd_assets(BaseSequentialStream *chp, int argc, char *argv[]) {
+  const olv_asset_header *h = olv_asset_pack();
+  const olv_asset_entry *e;
+  uint16_t i;
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: assets\r\n");
+    return;
+  }
+
+  chprintf(chp, "pack             : %s, %U of %U bytes\r\n", h ? "valid" : olv_asset.loading ? "loading" : "none",
+    h ? (unsigned long)h->size : 0, (unsigned long)olv_asset_capacity());
+  chprintf(chp, "uploads          : %U, %U errors, %U pages erased\r\n", olv_asset.uploads, olv_asset.errors, olv_asset.pages);
+  if (olv_asset.uploads)
+    chprintf(chp, "last upload      : %U ms\r\n", olv_asset.upload_ms);
+#if OLV_USE_MSC
+  chprintf(chp, "mass storage     : %U commands, %U errors, %U blocks read, %U written\r\n",
+    olv_msc.commands, olv_msc.errors, olv_msc.blocks_read, olv_msc.blocks_written);
+#endif
+
+  if (!h) return;
+  e = (const olv_asset_entry *)(h + 1);
+  for (i = 0; i < h->count; i++, e++)
+    chprintf(chp, "%-12.12s %-5s %6U bytes\r\n", e->name, e->type == OLV_ASSET_IMAGE ? "image" : "raw", (unsigned long)e->size);
+};
+
+// the counters of olv_perf/perf.h and the threads
+static void cmd_perf(BaseSequentialStream *chp, int argc, char *argv[]) {
+  olv_perf_snapshot s;
+  Thread *tp;
+  long free;
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: perf\r\n");
+    return;
+  }
+
+  olv_perf_take(&s);
+
+  chprintf(chp, "uptime           : %U s, %U%% idle\r\n", s.uptime /1000, s.uptime ? (unsigned long)((uint64_t)s.idle *100 /s.uptime) : 0);
+  chprintf(chp, "frames           : %U, %U pixels drawn\r\n", s.frames, s.pixels);
+  chprintf(chp, "spi              : %U bytes, %U ms busy\r\n", s.spi_bytes, s.spi_us /1000);
+  chprintf(chp, "i2c              : %U transactions, %U errors\r\n", s.i2c_done, s.i2c_errors);
+  chprintf(chp, "usb              : %U bytes in, %U bytes out\r\n", s.usb_in, s.usb_out);
+  chprintf(chp, "events           : %U ms late max\r\n", s.late_max);
+  chprintf(chp, "memory free      : %U heap (%U min), %U core, %U stack min\r\n", s.heap_free, s.heap_min, s.core_free, s.stack_free);
+  chprintf(chp, "shell            : %U sessions, %U jobs, %U ms longest\r\n", usb_shell.sessions, usb_shell.jobs, olv_shell.ms_max);
+  chprintf(chp, "thread             prio   cpu ms  cpu %%  stack free\r\n");
+  for (tp = chRegFirstThread(); tp; tp = chRegNextThread(tp)) {
+    free = olv_perf_stack_free(tp);
+    chprintf(chp, "%-18s %4U %8U %5U  ", tp->p_name ? tp->p_name : "?", (unsigned long)tp->p_prio,
+      (unsigned long)((uint64_t)chThdGetTicks(tp) *1000 /CH_FREQUENCY),
+      s.uptime ? (unsigned long)((uint64_t)chThdGetTicks(tp) *100000 /CH_FREQUENCY /s.uptime) : 0);
+    if (free >= 0) chprintf(chp, "%10U\r\n", (unsigned long)free);
+    else chprintf(chp, "%10s\r\n", "-");
+  }
+};
+
+// binary, the record of olv_perf/perf.h every ms until a byte comes, see
+// tools/rpctool
+static void cmd_telemetry(BaseSequentialStream *chp, int argc, char *argv[]) {
+  olv_perf_snapshot s;
+  uint8_t record[OLV_PERF_RECORD];
+  unsigned long records = 0;
+  long ms = OLV_PERF_PERIOD;
+
+  if (argc > 1 || (argc == 1 && (ms = shell_number(argv[0], 10, 60000)) < 0)) {
+    chprintf(chp, "Usage: telemetry [ms]\r\n");
+    return;
+  }
+
+  chSequentialStreamWrite(chp, (const uint8_t *)"OT", 2);
+  olv_perf_periodic((unsigned long)ms);
+  while (chnGetTimeout((BaseChannel *)chp, TIME_IMMEDIATE) == Q_TIMEOUT) {
+    // looks for the byte at least every 100 ms
+    if (!olv_perf_next(&s, MS2ST(100))) continue;
+    olv_perf_record(&s, record);
+    chSequentialStreamWrite(chp, record, OLV_PERF_RECORD);
+    records++;
+  }
+  olv_perf_periodic(0);
+
+  chprintf(chp, "\r\nrecords          : %U\r\n", records);
+};
+
+// the records of olv_log/log.h as text until a key, "bin" sends them to
+// tools/logdump until a byte comes: "OL" size:u32, the records, a zero word
+static void cmd_log(BaseSequentialStream *chp, int argc, char *argv[]) {
+  bool_t binary = argc == 1 && !strcmp(argv[0], "bin");
+  uint32_t word = (uint32_t)olv_log_strings();
+
+  if (argc > 1 || (argc == 1 && !binary)) {
+    chprintf(chp, "Usage: log [bin]\r\n");
+    return;
+  }
+
+  if (binary) {
+    chSequentialStreamWrite(chp, (const uint8_t *)"OL", 2);
+    chSequentialStreamWrite(chp, (const uint8_t *)&word, 4);
+  }
+
+  olv_log_attach(chp, binary);
+  (void)chnGetTimeout((BaseChannel *)chp, TIME_INFINITE);
+  olv_log_attach(NULL, FALSE);
+
+  if (binary) {
+    word = 0;
+    chSequentialStreamWrite(chp, (const uint8_t *)&word, 4);
+  }
+
+  chprintf(chp, "\r\nrecords          : %U, %U dropped\r\n", olv_log.records, olv_log.dropped);
+};
+
+static void cmd_events(BaseSequentialStream *chp, int argc, char *argv[]) {
+  olv_event_pool* ev;
+  olv_ev_stats s;
+
+  if (argc > 1 || (argc == 1 && strcmp(argv[0], "reset"))) {
+    chprintf(chp, "Usage: events [reset]\r\n");
     return;
   }
 
-  // yes, it does not check if the input is a valid number.
-  // on the other side: its not much code.
-  time_offset = ((atoi(argv[0])+12) *60 +atoi(argv[1])) *60 +atoi(argv[2]);
-  time_offset *= 1000;
-  time_offset -= chTimeNow();
+  if (argc == 1) {
+    olv_ev_reset();
+    memset(&olv_render, 0, sizeof(olv_render));
+    return;
+  }
+
+  chprintf(chp, "wake-ups %U, runs %U\r\n", olv_ev_wakeups, olv_ev_runs);
+  chprintf(chp, "event                  runs   min us   avg us   max us  late avg max ms\r\n");
+  for (ev = olv_ev_list; ev; ev = ev->next) {
+    // the scheduler thread may be updating it
+    chSysLock();
+    s = ev->stats;
+    chSysUnlock();
+    chprintf(chp, "%-18s %8U %8U %8U %8U  %8U %6U\r\n", ev->name ? ev->name : "?", s.runs,
+      s.cost_min, s.runs ? s.cost_sum / s.runs : 0, s.cost_max, s.runs ? s.late_sum / s.runs : 0, s.late_max);
+  }
+  chprintf(chp, "%-18s %8U %8s %8U %8U\r\n", "flush", olv_render.frames, "",
+    olv_render.frames ? olv_render.flush_sum / olv_render.frames : 0, olv_render.flush_max);
 };
 
 static void cmd_vibrator_enable(BaseSequentialStream *chp, int argc, char *argv[]) {
@@ -70,17 +385,8 @@ static void cmd_vibrator_toggle(BaseSequentialStream *chp, int argc, char *argv[
   palTogglePad(GPIOC, GPIOC_VIBRATOR_ENABLE);
 };
 
-static void cmd_led_enable(BaseSequentialStream *chp, int argc, char *argv[]) {
-	if (argc != 2) {
-		chprintf(chp, "this command requires two arguments:\r\n");
-		chprintf(chp, "the first defines the LED: 1 = R, 2 = G, 4 = B or combined: 5 = RB\r\n");
-		chprintf(chp, "the second argument defines the delay the led is enabled\r\n");
-		chprintf(chp, "keep in mind that this sequence will continue after one second.\r\n");
-		return;
-	}
-	int colors = atoi(argv[0]);
-	uint16_t delay = PWM_PERCENTAGE_TO_WIDTH(&PWMD3, atoi(argv[1]));
-
+// the shell and rpc commands of the leds
+static void led_enable(int colors, uint16_t delay) {
 	if (colors & 1) {
 		// red
 		pwmEnableChannel(&PWMD5, 1, delay);
@@ -95,14 +401,7 @@ static void cmd_led_enable(BaseSequentialStream *chp, int argc, char *argv[]) {
 	}
 };
 
-static void cmd_led_disable(BaseSequentialStream *chp, int argc, char *argv[]) {
-	if (argc != 1) {
-		chprintf(chp, "this command requires one arguments:\r\n");
-		chprintf(chp, "the argument defines the LED: 1 = R, 2 = G, 4 = B or combined: 5 = RB\r\n");
-		return;
-	}
-	int colors = atoi(argv[0]);
-	
+static void led_disable(int colors) {
 	if (colors & 1) {
 		// red
 		pwmDisableChannel(&PWMD5, 1);
@@ -117,9 +416,137 @@ static void cmd_led_disable(BaseSequentialStream *chp, int argc, char *argv[]) {
 	}
 };
 
+static void cmd_led_enable(BaseSequentialStream *chp, int argc, char *argv[]) {
+	if (argc != 2) {
+		chprintf(chp, "this command requires two arguments:\r\n");
+		chprintf(chp, "the first defines the LED: 1 = R, 2 = G, 4 = B or combined: 5 = RB\r\n");
+		chprintf(chp, "the second argument defines the delay the led is enabled\r\n");
+		chprintf(chp, "keep in mind that this sequence will continue after one second.\r\n");
+		return;
+	}
+
+	led_enable(atoi(argv[0]), PWM_PERCENTAGE_TO_WIDTH(&PWMD3, atoi(argv[1])));
+};
+
+static void cmd_led_disable(BaseSequentialStream *chp, int argc, char *argv[]) {
+	if (argc != 1) {
+		chprintf(chp, "this command requires one arguments:\r\n");
+		chprintf(chp, "the argument defines the LED: 1 = R, 2 = G, 4 = B or combined: 5 = RB\r\n");
+		return;
+	}
+
+	led_disable(atoi(argv[0]));
+};
+
+// ---- binary commands, see olv_rpc/rpc.h and tools/rpctool ----
+
+#define RPC_DATE 0x01         // -> wall clock ms:u64, uptime s:u32
+#define RPC_SET_TIME 0x02     // seconds since 1970:u32
+#define RPC_LED_ENABLE 0x03   // colors:u8 percentage:u16, as led_enable
+#define RPC_LED_DISABLE 0x04  // colors:u8
+#define RPC_VIBRATOR 0x05     // 0 off, 1 on, 2 toggle
+#define RPC_PERF 0x06         // -> the record of olv_perf/perf.h
+
+static uint8_t rpc_date(olv_rpc_call *c) {
+  uint64_t now = olv_time_now();
+
+  if (c->arg_n) return OLV_RPC_EARG;
+
+  olv_rpc_put_u32(c->res, (uint32_t)now);
+  olv_rpc_put_u32(c->res +4, (uint32_t)(now >> 32));
+  olv_rpc_put_u32(c->res +8, (uint32_t)(olv_time_mono() /1000));
+  c->res_n = 12;
+  return OLV_RPC_OK;
+};
+
+static uint8_t rpc_set_time(olv_rpc_call *c) {
+
+  if (c->arg_n != 4) return OLV_RPC_EARG;
+
+  olv_time_set(olv_rpc_u32(c->arg));
+  return OLV_RPC_OK;
+};
+
+static uint8_t rpc_led_enable(olv_rpc_call *c) {
+  unsigned percentage;
+
+  if (c->arg_n != 3 || (percentage = c->arg[1] | c->arg[2] << 8) > 10000) return OLV_RPC_EARG;
+
+  led_enable(c->arg[0], PWM_PERCENTAGE_TO_WIDTH(&PWMD3, percentage));
+  return OLV_RPC_OK;
+};
+
+static uint8_t rpc_led_disable(olv_rpc_call *c) {
+
+  if (c->arg_n != 1) return OLV_RPC_EARG;
+
+  led_disable(c->arg[0]);
+  return OLV_RPC_OK;
+};
+
+static uint8_t rpc_vibrator(olv_rpc_call *c) {
+
+  if (c->arg_n != 1 || c->arg[0] > 2) return OLV_RPC_EARG;
+
+  if (c->arg[0] == 2) palTogglePad(GPIOC, GPIOC_VIBRATOR_ENABLE);
+  else if (c->arg[0]) palSetPad(GPIOC, GPIOC_VIBRATOR_ENABLE);
+  else palClearPad(GPIOC, GPIOC_VIBRATOR_ENABLE);
+  return OLV_RPC_OK;
+};
+
+static uint8_t rpc_perf(olv_rpc_call *c) {
+  olv_perf_snapshot s;
+
+  if (c->arg_n) return OLV_RPC_EARG;
+
+  olv_perf_take(&s);
+  olv_perf_record(&s, c->res);
+  c->res_n = OLV_PERF_RECORD;
+  return OLV_RPC_OK;
+};
+
+static const olv_rpc_command rpc_commands[] = {
+  {RPC_DATE, rpc_date},
+  {RPC_SET_TIME, rpc_set_time},
+  {RPC_LED_ENABLE, rpc_led_enable},
+  {RPC_LED_DISABLE, rpc_led_disable},
+  {RPC_VIBRATOR, rpc_vibrator},
+  {RPC_PERF, rpc_perf},
+  {0, NULL}
+};
+
+static void cmd_rpc(BaseSequentialStream *chp, int argc, char *argv[]) {
+  (void)argv;
+
+  if (argc > 0) {
+    chprintf(chp, "Usage: rpc\r\n");
+    return;
+  }
+
+  olv_rpc_run((BaseChannel *)chp, rpc_commands);
+
+  chprintf(chp, "\r\nrequests         : %U, %U errors\r\n", olv_rpc.requests, olv_rpc.errors);
+  chprintf(chp, "batches          : %U\r\n", olv_rpc.batches);
+  chprintf(chp, "bytes            : %U in, %U out\r\n", olv_rpc.bytes_in, olv_rpc.bytes_out);
+};
+
 static const ShellCommand commands[] = {
   {"mem", cmd_mem},
   {"set_time", cmd_set_time},
+  {"date", cmd_date},
+  {"glyphs", cmd_glyphs},
+  {"i2c", cmd_i2c},
+  {"render", cmd_render},
+  {"events", cmd_events},
+  {"perf", cmd_perf},
+  {"telemetry", cmd_telemetry},
+  {"log", cmd_log},
+  {"power", cmd_power},
+  {"stream", cmd_stream},
+  {"push", cmd_push},
+  {"bulk", cmd_bulk},
+  {"assets", cmd_assets},
+  {"rpc", cmd_rpc},
   {"vibrator_enable", cmd_vibrator_enable},
   {"vibrator_disable", cmd_vibrator_disable},
   {"vibrator_toggle", cmd_vibrator_toggle},
@@ -128,8 +555,39 @@ static const ShellCommand commands[] = {
   {NULL, NULL}
 };
 
+SerialUSBDriver SDU1;
+
+// print a lot, the session keeps echoing meanwhile
+static const shellcmd_t jobs[] = {
+  cmd_mem,
+  cmd_i2c,
+  cmd_events,
+  cmd_perf,
+  cmd_assets,
+  NULL
+};
+
 static const ShellConfig shell_cfg1 = {
   (BaseSequentialStream *)&SDU1,
   commands
 };
 
+static const olv_shell_config usb_shell_cfg = {
+  &shell_cfg1,
+  jobs,
+  &SDU1.iqueue,
+  &SDU1.oqueue,
+  "shell"
+};
+
+olv_shell_session usb_shell;
+
+static WORKING_AREA(usbShellWorkplace, OLV_SHELL_STACK);
+
+void usb_shell_start(void) {
+
+  shellInit();
+  olv_shell_init();
+  olv_shell_start(&usb_shell, &usb_shell_cfg, usbShellWorkplace, sizeof(usbShellWorkplace), NORMALPRIO);
+};
+
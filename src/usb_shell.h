@@ -3,7 +3,12 @@
 #include "usb_hw.h"
 #include "shell.h"
 
-static const ShellConfig shell_cfg1;
+#ifndef HEADER_USB_SHELL
+#define HEADER_USB_SHELL
 
-static SerialUSBDriver SDU1;
+extern SerialUSBDriver SDU1;
 
+// after sduStart(), before usbStart()
+void usb_shell_start(void);
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * assetpack - builds and checks the asset packs of src/olv_asset/asset.h.
+ *
+ * build: gcc -O2 -o assetpack assetpack.c
+ *
+ *   assetpack pack.bin file ...
+ *     packs the files, each named after its file name without the
+ *     directory and the extension (up to 12 characters). files ending in
+ *     .qim are images written by "qimg bin", the others raw data.
+ *
+ *   assetpack list pack.bin
+ *     checks a pack and prints its assets.
+ *
+ * a firmware built with OLV_USE_MSC shows a small disk, copying the pack
+ * onto it replaces the assets of the watch:
+ *   cp pack.bin /media/$USER/OLV\ ASSETS/ && sync
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/olv_rpc/frame.c"
+
+#define MAGIC "OLVA"
+#define VERSION 1
+#define NAME 12
+#define HEADER 16
+#define ENTRY 24
+#define CAPACITY 65536
+
+#define RAW 0
+#define IMAGE 1
+
+static uint8_t pack[CAPACITY];
+
+static void put16 (uint8_t *p, unsigned v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8 & 0xFF;
+}
+
+static void put32 (uint8_t *p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8 & 0xFF;
+  p[2] = v >> 16 & 0xFF;
+  p[3] = v >> 24 & 0xFF;
+}
+
+static unsigned get16 (const uint8_t *p) {
+  return p[0] | p[1] << 8;
+}
+
+static uint32_t get32 (const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// an image must hold its header and sync table
+static int check_image (const uint8_t *p, uint32_t n) {
+  return n >= 8 && get16(p + 4) && 8 + get16(p + 6) * 4u <= n;
+}
+
+static int cmd_pack (const char *out, int count, char *files[]) {
+  uint32_t at = HEADER + count * ENTRY;
+  const char *name, *dot;
+  uint8_t *e;
+  size_t n, len;
+  FILE *f;
+  int i;
+
+  if (at > CAPACITY) { fprintf(stderr, "assetpack: too many files\n"); return 1; }
+
+  for (i = 0; i < count; i++) {
+    e = pack + HEADER + i * ENTRY;
+    name = strrchr(files[i], '/') ? strrchr(files[i], '/') + 1 : files[i];
+    dot = strrchr(name, '.');
+    len = dot ? (size_t)(dot - name) : strlen(name);
+    if (!len || len > NAME) { fprintf(stderr, "%s: the name must have 1 to %d characters\n", files[i], NAME); return 1; }
+    memcpy(e, name, len);
+    e[NAME] = dot && !strcmp(dot, ".qim") ? IMAGE : RAW;
+
+    if (!(f = fopen(files[i], "rb"))) { perror(files[i]); return 1; }
+    n = fread(pack + at, 1, CAPACITY - at, f);
+    if (!feof(f) && fgetc(f) != EOF) { fprintf(stderr, "%s: the pack is full\n", files[i]); return 1; }
+    fclose(f);
+    if (e[NAME] == IMAGE && !check_image(pack + at, n)) { fprintf(stderr, "%s: not an image of qimg bin\n", files[i]); return 1; }
+
+    put32(e + 16, at);
+    put32(e + 20, n);
+    at = (at + n + 3) & ~3u;
+  }
+
+  memcpy(pack, MAGIC, 4);
+  put16(pack + 4, VERSION);
+  put16(pack + 6, count);
+  put32(pack + 8, at);
+  put16(pack + 12, olv_frame_crc(0xFFFF, pack + HEADER, at - HEADER));
+
+  if (!(f = fopen(out, "wb")) || fwrite(pack, 1, at, f) != at || fclose(f)) { perror(out); return 1; }
+  printf("%s: %d assets, %u of %u bytes\n", out, count, at, CAPACITY);
+  return 0;
+}
+
+static int cmd_list (const char *path) {
+  uint32_t size, offset, n;
+  unsigned count, i;
+  const uint8_t *e;
+  size_t len;
+  FILE *f;
+
+  if (!(f = fopen(path, "rb"))) { perror(path); return 1; }
+  len = fread(pack, 1, CAPACITY, f);
+  fclose(f);
+
+  size = get32(pack + 8);
+  count = get16(pack + 6);
+  if (len < HEADER || memcmp(pack, MAGIC, 4) || get16(pack + 4) != VERSION || size > len || HEADER + count * ENTRY > size) {
+    fprintf(stderr, "%s: not an asset pack\n", path);
+    return 1;
+  }
+  if (olv_frame_crc(0xFFFF, pack + HEADER, size - HEADER) != get16(pack + 12)) {
+    fprintf(stderr, "%s: bad crc\n", path);
+    return 1;
+  }
+
+  printf("%s: %u assets, %u bytes\n", path, count, size);
+  for (i = 0; i < count; i++) {
+    e = pack + HEADER + i * ENTRY;
+    offset = get32(e + 16);
+    n = get32(e + 20);
+    if (offset & 3 || offset > size || n > size - offset) { fprintf(stderr, "%.12s: out of the pack\n", e); return 1; }
+    printf("%-12.12s %-5s %6u bytes", e, e[NAME] == IMAGE ? "image" : "raw", n);
+    if (e[NAME] == IMAGE && check_image(pack + offset, n))
+      printf("  %ux%u", get16(pack + offset), get16(pack + offset + 2));
+    putchar('\n');
+  }
+  return 0;
+}
+
+int main (int argc, char *argv[]) {
+  if (argc == 3 && !strcmp(argv[1], "list")) return cmd_list(argv[2]);
+  if (argc >= 3) return cmd_pack(argv[1], argc - 2, argv + 2);
+
+  fprintf(stderr, "usage: assetpack pack.bin file ...\n       assetpack list pack.bin\n");
+  return 1;
+}
@@ -0,0 +1,278 @@
+/*
+ * bdf2font - converts a BDF bitmap font into a GDISP span font.
+ *
+ * build: gcc -O2 -o bdf2font bdf2font.c
+ *
+ *   bdf2font [-a] [-r first-last] [-x list] font.bdf fontName > font.c
+ *
+ *   -a            anti-alias: the BDF is drawn at twice the wanted size and
+ *                 every 2x2 block becomes one pixel with 2 bit coverage.
+ *   -r first-last directly indexed character range (default 32-126,
+ *                 "-r 1-0" for none).
+ *   -x list       extra unicode characters stored in the sparse table, eg.
+ *                 "-x 0xC4,0xD6,0xDC,0xDF,0xE4,0xF6,0xFC,0x410-0x44F".
+ *                 the BDF must use unicode (ISO10646) encodings.
+ *
+ * the generated file defines "const struct font fontName" which can be
+ * passed to every gdisp text function. each glyph is stored as rows of
+ * horizontal spans and identical rows are folded into repeats, which is
+ * what makes tall digit fonts both small and fast to draw. the flash size
+ * compared to the column font format is printed on stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CELL 512
+#define MAX_SPANS 127
+
+typedef struct {
+  int width;           // advance in output pixels, 0 if missing
+  int top, rows;       // first row with pixels and the number of rows
+  unsigned char *ops;  // encoded rows
+  int size;
+  int present;
+} glyph;
+
+static int ascent = -1, descent = -1;
+static int first_char = 32, last_char = 126;
+static int antialias = 0;
+static glyph glyphs[65536];
+static unsigned char extra[65536];
+
+// coverage of the glyph cell currently being read, in source pixels
+static unsigned char cell[MAX_CELL][MAX_CELL];
+
+static void put (glyph *g, unsigned char b) {
+  g->ops = realloc(g->ops, g->size + 1);
+  g->ops[g->size++] = b;
+};
+
+// the alpha (0..3) of an output pixel
+static int alpha (int x, int y) {
+  int cov;
+
+  if (!antialias) return cell[y][x] ? 3 : 0;
+
+  cov = cell[y * 2][x * 2] + cell[y * 2][x * 2 + 1] + cell[y * 2 + 1][x * 2] + cell[y * 2 + 1][x * 2 + 1];
+  return (cov * 3 + 2) / 4;
+};
+
+// collects the spans of an output row as (x, aa:2|len:6) pairs
+static int row_spans (int y, int width, unsigned char *spans) {
+  int x, a, start, n = 0;
+
+  for (x = 0; x < width; ) {
+    a = alpha(x, y);
+    if (!a) {
+      x++;
+      continue;
+    }
+    start = x;
+    while (x < width && alpha(x, y) == a && x - start < 63) x++;
+    if (n == MAX_SPANS || start > 255) {
+      fprintf(stderr, "too many spans or glyph too wide\n");
+      exit(1);
+    }
+    spans[n * 2] = start;
+    spans[n * 2 + 1] = a << 6 | (x - start);
+    n++;
+  }
+  return n;
+};
+
+static void encode (glyph *g, int width, int height) {
+  unsigned char spans[MAX_SPANS * 2], prev[MAX_SPANS * 2];
+  int y, n, prevn = -1, repeat = 0, last = -1;
+
+  g->top = -1;
+  for (y = 0; y < height; y++) {
+    if (row_spans(y, width, spans)) {
+      if (g->top < 0) g->top = y;
+      last = y;
+    }
+  }
+  if (g->top < 0) {
+    g->top = g->rows = 0;
+    return;
+  }
+  g->rows = last - g->top + 1;
+
+  for (y = g->top; y <= last; y++) {
+    n = row_spans(y, width, spans);
+    if (n == prevn && !memcmp(spans, prev, n * 2) && repeat < 128) {
+      repeat++;
+      continue;
+    }
+    if (repeat) put(g, 0x80 | (repeat - 1));
+    repeat = 0;
+
+    put(g, n);
+    for (int i = 0; i < n * 2; i++) put(g, spans[i]);
+    memcpy(prev, spans, n * 2);
+    prevn = n;
+  }
+  if (repeat) put(g, 0x80 | (repeat - 1));
+};
+
+// parses "a,b-c,..." into the extra table
+static int parse_extra (char *list) {
+  char *tok;
+  unsigned long a, b;
+
+  for (tok = strtok(list, ","); tok; tok = strtok(0, ",")) {
+    a = b = strtoul(tok, &tok, 0);
+    if (*tok == '-') b = strtoul(tok + 1, 0, 0);
+    if (a > b || b > 0xFFFF) return 0;
+    while (a <= b) extra[a++] = 1;
+  }
+  return 1;
+};
+
+static void read_bdf (FILE *f) {
+  char line[1024];
+  int bbw = 0, bbh = 0, bbx = 0, bby = 0;
+  int enc = -1, dwidth = 0, w = 0, h = 0, xo = 0, yo = 0, row, x, cx, cy;
+  int height, out_w, out_h;
+  unsigned long bits = 0;
+
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &bbw, &bbh, &bbx, &bby) == 4) continue;
+    if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1) continue;
+    if (sscanf(line, "FONT_DESCENT %d", &descent) == 1) continue;
+    if (sscanf(line, "ENCODING %d", &enc) == 1) continue;
+    if (sscanf(line, "DWIDTH %d", &dwidth) == 1) continue;
+    if (sscanf(line, "BBX %d %d %d %d", &w, &h, &xo, &yo) == 4) continue;
+    if (strncmp(line, "BITMAP", 6)) continue;
+
+    if (ascent < 0) ascent = bbh + bby;
+    if (descent < 0) descent = -bby;
+    height = ascent + descent;
+    if (height > MAX_CELL || dwidth > MAX_CELL) {
+      fprintf(stderr, "glyph %d is too large\n", enc);
+      exit(1);
+    }
+
+    memset(cell, 0, sizeof(cell));
+    for (row = 0; row < h && fgets(line, sizeof(line), f); row++) {
+      cy = ascent - (yo + h) + row;
+      for (x = 0; x < w; x++) {
+        // every hex digit holds four pixels, MSBit first
+        if (x % 4 == 0) {
+          char digit[2] = {line[x / 4], 0};
+          bits = strtoul(digit, 0, 16);
+        }
+        cx = xo + x;
+        if (cx >= 0 && cx < MAX_CELL && cy >= 0 && cy < MAX_CELL && (bits >> (3 - x % 4) & 1))
+          cell[cy][cx] = 1;
+      }
+    }
+
+    if (enc >= 0 && enc <= 0xFFFF && ((enc >= first_char && enc <= last_char) || extra[enc])) {
+      out_w = antialias ? (dwidth + 1) / 2 : dwidth;
+      out_h = antialias ? (height + 1) / 2 : height;
+      glyphs[enc].width = out_w > 0 ? out_w : 0;
+      glyphs[enc].present = 1;
+      encode(&glyphs[enc], out_w, out_h);
+    }
+    enc = -1;
+  }
+};
+
+int main (int argc, char *argv[]) {
+  FILE *f;
+  const char *name;
+  int c, i, n, height, descend, minw = 255, maxw = 0, span_size = 0, count = 0;
+  long column_size = 0;
+  int chars[65536];
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (!strcmp(argv[i], "-a")) antialias = 1;
+    else if (!strcmp(argv[i], "-r") && i + 1 < argc && sscanf(argv[++i], "%d-%d", &first_char, &last_char) == 2) ;
+    else if (!strcmp(argv[i], "-x") && i + 1 < argc && parse_extra(argv[++i])) ;
+    else break;
+  }
+  if (argc - i != 2 || first_char < 0 || last_char > 127 || first_char > last_char + 1) {
+    fprintf(stderr, "usage: bdf2font [-a] [-r first-last] [-x list] font.bdf fontName > font.c\n");
+    return 1;
+  }
+  if (!(f = fopen(argv[i], "r"))) {
+    perror(argv[i]);
+    return 1;
+  }
+  name = argv[i + 1];
+  read_bdf(f);
+  fclose(f);
+
+  // the direct range first, then the sparse characters in ascending order
+  for (c = first_char; c <= last_char; c++) chars[count++] = c;
+  for (c = 0; c <= 0xFFFF; c++)
+    if (glyphs[c].present && (c < first_char || c > last_char)) chars[count++] = c;
+
+  height = ascent + descent;
+  descend = descent;
+  if (antialias) {
+    height = (height + 1) / 2;
+    descend = (descend + 1) / 2;
+  }
+  if (height > 255) {
+    fprintf(stderr, "font is too tall\n");
+    return 1;
+  }
+
+  printf("/* generated by tools/bdf2font from %s */\n", argv[i]);
+  printf("#include \"ch.h\"\n#include \"hal.h\"\n#include \"gdisp.h\"\n\n");
+  printf("#if GFX_USE_GDISP && GDISP_NEED_TEXT\n\n#include \"gdisp/fonts.h\"\n\n");
+
+  printf("static const uint8_t %s_Widths[] = {\n\t", name);
+  for (i = 0; i < count; i++) {
+    c = chars[i];
+    printf("%d%s", glyphs[c].width, i == count - 1 ? "\n};\n\n" : (i % 16 == 15 ? ",\n\t" : ", "));
+    if (glyphs[c].width) {
+      if (glyphs[c].width < minw) minw = glyphs[c].width;
+      if (glyphs[c].width > maxw) maxw = glyphs[c].width;
+    }
+  }
+
+  printf("static const uint16_t %s_Offsets[] = {\n\t", name);
+  for (i = 0, n = 0; i < count; i++) {
+    printf("%d%s", n, i == count - 1 ? "\n};\n\n" : (i % 8 == 7 ? ",\n\t" : ", "));
+    n += 2 + glyphs[chars[i]].size;
+  }
+  span_size = n;
+  if (span_size > 0xFFFF) {
+    fprintf(stderr, "span data exceeds the 16 bit offset table\n");
+    return 1;
+  }
+
+  printf("static const uint8_t %s_Spans[] = {\n", name);
+  for (i = 0; i < count; i++) {
+    c = chars[i];
+    printf("\t/* %4X */ %d, %d", c, glyphs[c].top, glyphs[c].rows);
+    for (n = 0; n < glyphs[c].size; n++) printf(", 0x%02X", glyphs[c].ops[n]);
+    printf("%s\n", i == count - 1 ? "" : ",");
+    column_size += glyphs[c].width * ((height + 15) / 16) * 2;
+  }
+  printf("};\n\n");
+
+  n = count - (last_char - first_char + 1);
+  if (n) {
+    printf("static const uint16_t %s_Chars[] = {\n\t", name);
+    for (i = count - n; i < count; i++)
+      printf("0x%04X%s", chars[i], i == count - 1 ? "\n};\n\n" : ((i - count + n) % 8 == 7 ? ",\n\t" : ", "));
+  }
+
+  printf("const struct font %s = { %d, 0, %d, %d, %d, %d, %d, %d, 1, 1,\n", name, height, height + 1, descend, minw == 255 ? 0 : minw, maxw, first_char, last_char);
+  printf("\t%s_Widths,\n\t%s_Offsets,\n\tNULL,\n\t%s_Spans,\n", name, name, name);
+  if (n)
+    printf("\t%s_Chars, %d,\n\tNULL};\n\n#endif\n", name, n);
+  else
+    printf("\tNULL, 0,\n\tNULL};\n\n#endif\n");
+
+  // widths and offsets per character, plus the sparse code points
+  fprintf(stderr, "%s: %d characters (%d sparse), %d px high, span font %d bytes, column font %ld bytes%s\n",
+    name, count, n, height, span_size + count * 3 + n * 2, column_size + count * 3 + n * 2,
+    height > 32 ? " (not possible, taller than 32)" : "");
+  return 0;
+};
@@ -0,0 +1,147 @@
+/*
+ * bulkbench - throughput of the olv vendor bulk interface.
+ *
+ * build: gcc -O2 -o bulkbench bulkbench.c
+ *
+ *   bulkbench [kB] [/dev/bus/usb/BBB/DDD]
+ *     finds the watch (0483:5740) unless the device is given, claims the
+ *     bulk interface and runs both tests of src/olv_bulk/bulk.h with the
+ *     given amount (default 1024 kB): the watch sends, then the host sends.
+ *
+ * prints the rate seen by the host and the one the watch measured. linux
+ * only, it talks to usbfs directly. the serial port of the shell stays
+ * with its driver meanwhile.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+#include <linux/usbdevice_fs.h>
+
+#define VENDOR 0x0483
+#define PRODUCT 0x5740
+#define INTERFACE 2
+#define EP_IN 0x83
+#define EP_OUT 0x04
+#define PACKET 64
+#define BUFFER 512
+#define CHUNK 16384
+
+static double now (void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static unsigned sysfs (const char *dev, const char *name, int base) {
+  char path[512], buf[32];
+  FILE *f;
+  snprintf(path, sizeof(path), "/sys/bus/usb/devices/%s/%s", dev, name);
+  if (!(f = fopen(path, "r"))) return 0;
+  if (!fgets(buf, sizeof(buf), f)) buf[0] = 0;
+  fclose(f);
+  return (unsigned)strtoul(buf, NULL, base);
+}
+
+static int find (char *path, size_t size) {
+  DIR *d = opendir("/sys/bus/usb/devices");
+  struct dirent *e;
+  int found = 0;
+
+  if (!d) return 0;
+  while (!found && (e = readdir(d))) {
+    if (e->d_name[0] == '.' || strchr(e->d_name, ':')) continue;
+    if (sysfs(e->d_name, "idVendor", 16) != VENDOR || sysfs(e->d_name, "idProduct", 16) != PRODUCT) continue;
+    snprintf(path, size, "/dev/bus/usb/%03u/%03u", sysfs(e->d_name, "busnum", 10), sysfs(e->d_name, "devnum", 10));
+    found = 1;
+  }
+  closedir(d);
+  return found;
+}
+
+static int bulk (int fd, unsigned ep, void *buf, unsigned n) {
+  struct usbdevfs_bulktransfer t;
+  t.ep = ep;
+  t.len = n;
+  t.timeout = 2000;
+  t.data = buf;
+  return ioctl(fd, USBDEVFS_BULK, &t);
+}
+
+static void put32 (uint8_t *p, unsigned long v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8 & 0xFF;
+  p[2] = v >> 16 & 0xFF;
+  p[3] = v >> 24 & 0xFF;
+}
+
+static unsigned long get32 (const uint8_t *p) {
+  return p[0] | (unsigned long)p[1] << 8 | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+}
+
+static int test (int fd, char cmd, unsigned long n) {
+  static uint8_t buf[CHUNK];
+  uint8_t c[16] = {'O', 'B'};
+  unsigned long done = 0;
+  double start;
+  int r;
+
+  c[2] = (uint8_t)cmd;
+  put32(c + 3, n);
+  // shorter than a packet, so it ends the transfer on the watch
+  if (bulk(fd, EP_OUT, c, 7) != 7) { perror("command"); return 0; }
+
+  start = now();
+  while (done < n) {
+    unsigned k = n - done > CHUNK ? CHUNK : (unsigned)(n - done);
+    r = bulk(fd, cmd == 'I' ? EP_IN : EP_OUT, buf, k);
+    if (r <= 0) { perror(cmd == 'I' ? "read" : "write"); break; }
+    done += (unsigned long)r;
+  }
+  // the watch waits for a short packet or a full buffer, a zero length
+  // packet ends a partial buffer of whole packets
+  if (cmd == 'O' && done == n && n % BUFFER && n % PACKET == 0 && bulk(fd, EP_OUT, buf, 0) < 0) perror("write");
+  start = now() - start;
+
+  if ((r = bulk(fd, EP_IN, buf, PACKET)) < 11 || buf[0] != 'O' || buf[1] != 'B' || buf[2] != (uint8_t)cmd) {
+    fprintf(stderr, "no answer from the watch\n");
+    return 0;
+  }
+  printf("%-4s %lu bytes, host %.0f kB/s, watch %lu bytes in %lu ms", cmd == 'I' ? "in" : "out", done,
+    done / start / 1000, get32(buf + 7), get32(buf + 3));
+  if (get32(buf + 3)) printf(", %lu kB/s", get32(buf + 7) / get32(buf + 3));
+  printf("\n");
+  return done == n && get32(buf + 7) == n;
+}
+
+int main (int argc, char *argv[]) {
+  unsigned long kb = argc > 1 ? strtoul(argv[1], NULL, 10) : 1024;
+  unsigned iface = INTERFACE;
+  char path[64];
+  int fd, ok;
+
+  if (argc > 3 || !kb) {
+    fprintf(stderr, "usage: bulkbench [kB] [/dev/bus/usb/BBB/DDD]\n");
+    return 1;
+  }
+  if (argc > 2) snprintf(path, sizeof(path), "%s", argv[2]);
+  else if (!find(path, sizeof(path))) {
+    fprintf(stderr, "no watch found\n");
+    return 1;
+  }
+
+  if ((fd = open(path, O_RDWR)) < 0) { perror(path); return 1; }
+  if (ioctl(fd, USBDEVFS_CLAIMINTERFACE, &iface) < 0) { perror("claim"); return 1; }
+
+  ok = test(fd, 'I', kb * 1024) && test(fd, 'O', kb * 1024);
+
+  ioctl(fd, USBDEVFS_RELEASEINTERFACE, &iface);
+  close(fd);
+  return !ok;
+}
@@ -0,0 +1,230 @@
+/*
+ * evsim - host simulation of the olv event scheduler.
+ *
+ * build: gcc -O2 -o evsim evsim.c
+ *
+ *   evsim [hours] [sessions_per_hour] [flush_ms]
+ *
+ * runs src/olv_events/ev.c against a simulated ChibiOS clock with the
+ * event set of main.c (button poll, menu, clock face, debug info) and
+ * compares it to the old linear olv_event[] scan that slept at least
+ * 10 ms. the watch is woken up sessions_per_hour times per hour and goes
+ * back to sleep after the 20 s display timeout. while awake every pass
+ * ends with a framebuffer flush taking flush_ms (default 15). the old loop
+ * counted the poll delay from after the flush, the heap gives the polls
+ * flush_ms of slack to match and keeps the clock face exact. prints the
+ * wake-ups, the wake-ups that ran nothing and the callback runs per
+ * simulated hour and how late the clock face was drawn.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <setjmp.h>
+
+// just enough of ChibiOS to run the scheduler
+#define OLV_EV_HOST
+typedef uint32_t systime_t;
+typedef uint32_t eventmask_t;
+typedef int bool_t;
+typedef struct { int dummy; } Thread;
+#define TRUE 1
+#define FALSE 0
+#define EVENT_MASK(eid) ((eventmask_t)(1 << (eid)))
+#define chDbgAssert(c, m, r) { if (!(c)) { fprintf(stderr, "%s %s\n", m, r); exit(1); } }
+
+static uint32_t sim_now, sim_end;
+static eventmask_t sim_pending;
+static Thread sim_thread;
+static jmp_buf sim_done;
+
+#define chSysLock()
+#define chSysUnlock()
+#define chSchRescheduleS()
+#define chTimeNow() sim_now
+#define chThdSelf() (&sim_thread)
+
+// callbacks take no time of their own, the profile only sees the lateness
+#define olv_ev_cycles() 0
+#define olv_ev_us(cycles) (cycles)
+
+static void chEvtSignal (Thread *tp, eventmask_t mask) { (void)tp; sim_pending |= mask; }
+static void chEvtSignalI (Thread *tp, eventmask_t mask) { (void)tp; sim_pending |= mask; }
+
+static eventmask_t chEvtGetAndClearEvents (eventmask_t mask) {
+  eventmask_t m = sim_pending & mask;
+  sim_pending &= ~mask;
+  return m;
+}
+
+static eventmask_t chEvtWaitAnyTimeout (eventmask_t mask, systime_t time) {
+  if (!(sim_pending & mask)) sim_now += time;
+  if (sim_now >= sim_end) longjmp(sim_done, 1);
+  return chEvtGetAndClearEvents(mask);
+}
+#define chEvtWaitAny(mask) chEvtWaitAnyTimeout(mask, sim_end - sim_now)
+
+#include "../src/olv_events/ev.c"
+
+// ---- the event set of main.c ----
+
+#define EV_BUTTON 0
+#define EV_MENU 1
+#define EV_ACLOCK 2
+#define EV_DEBUG 3
+#define EV_COUNT 4
+
+#define DISP_TIMEOUT 20000
+
+static int use_heap;
+static unsigned sessions, flush_ms;
+static int awake;
+static unsigned long disp_timeout, late_sum, late_max, late_count, idle_wakeups, last_runs;
+
+static olv_event_pool heap_ev[EV_COUNT];
+
+static struct {
+  unsigned char enabled;
+  unsigned long ttn;
+} scan_ev[EV_COUNT];
+
+static void ev_schedule (int i, int on) {
+  if (use_heap) {
+    if (on) olv_ev_at(&heap_ev[i], olv_event_time);
+    else olv_ev_remove(&heap_ev[i]);
+  } else {
+    scan_ev[i].enabled = on;
+    scan_ev[i].ttn = 0;
+  }
+}
+
+static unsigned long ev_ttn (int i) {
+  return use_heap ? heap_ev[i].ttn : scan_ev[i].ttn;
+}
+
+// how late an event runs compared to the deadline it asked for
+static void ev_late (unsigned long deadline) {
+  unsigned long late = olv_event_time - deadline;
+  late_sum += late;
+  late_count++;
+  if (late > late_max) late_max = late;
+}
+
+static unsigned long sim_button (void) {
+  // a button press at the start of every session
+  if (olv_event_time % (3600000 / sessions) < (awake ? 20 : 250) && !awake) {
+    awake = 1;
+    disp_timeout = olv_event_time + DISP_TIMEOUT;
+    ev_schedule(EV_MENU, 1);
+    ev_schedule(EV_ACLOCK, 1);
+    ev_schedule(EV_DEBUG, 1);
+  } else if (awake && disp_timeout < olv_event_time) {
+    awake = 0;
+    ev_schedule(EV_MENU, 0);
+    ev_schedule(EV_ACLOCK, 0);
+    ev_schedule(EV_DEBUG, 0);
+  }
+  return awake ? 20 : 250;
+}
+
+static unsigned long sim_follow (void) {
+  return ev_ttn(EV_BUTTON) - olv_event_time;
+}
+
+static unsigned long sim_aclock (void) {
+  static unsigned long deadline;
+  if (deadline && olv_event_time >= deadline && olv_event_time - deadline < 1000) ev_late(deadline);
+  deadline = olv_event_time + 1000 - olv_event_time % 1000;
+  return 1000 - olv_event_time % 1000;
+}
+
+static olv_event_func funcs[EV_COUNT] = {sim_button, sim_follow, sim_aclock, sim_follow};
+
+// framebuffer_draw()
+static void sim_flush (unsigned long runs) {
+  if (runs == last_runs) idle_wakeups++;
+  last_runs = runs;
+  if (awake) sim_now += flush_ms;
+}
+
+static void sim_flush_heap (void) {
+  sim_flush(olv_ev_runs);
+}
+
+static void sim_reset (void) {
+  int i;
+  sim_now = 1;
+  sim_pending = 0;
+  awake = 0;
+  late_sum = late_max = late_count = idle_wakeups = last_runs = 0;
+  olv_ev_wakeups = olv_ev_runs = 0;
+  olv_ev_count = 0;
+  for (i = 0; i < EV_COUNT; i++) {
+    heap_ev[i].func = funcs[i];
+    heap_ev[i].prio = i == EV_BUTTON ? OLV_EV_PRIO_INPUT : OLV_EV_PRIO_DRAW;
+    // the old loop counted the poll delay from after the flush, the polls
+    // may slip as far. the clock face has no slack.
+    heap_ev[i].slack = i == EV_ACLOCK ? 0 : flush_ms;
+    heap_ev[i].slot = OLV_EV_SLOT_NONE;
+    scan_ev[i].enabled = i == EV_BUTTON;
+    scan_ev[i].ttn = 0;
+  }
+}
+
+// the old olvThread loop
+static void run_scan (unsigned long *wakeups, unsigned long *runs) {
+  unsigned long smallest;
+  int i;
+
+  for (;;) {
+    olv_event_time = sim_now;
+    smallest = 120000 + olv_event_time;
+    (*wakeups)++;
+    for (i = 0; i < EV_COUNT; i++) {
+      if (scan_ev[i].enabled) {
+        if (scan_ev[i].ttn <= olv_event_time) {
+          scan_ev[i].ttn = funcs[i]() + olv_event_time;
+          (*runs)++;
+        }
+        if (scan_ev[i].ttn < smallest) smallest = scan_ev[i].ttn;
+      }
+    }
+    sim_flush(*runs);
+    smallest = smallest - olv_event_time;
+    sim_now += smallest < 10 ? 10 : smallest;
+    if (sim_now >= sim_end) return;
+  }
+}
+
+static void report (const char *label, unsigned hours, unsigned long wakeups, unsigned long runs) {
+  printf("%-14s %8.0f wake-ups/h (%6.0f idle) %8.0f runs/h   clock late avg %5.2f ms max %3lu ms\n",
+    label, (double)wakeups / hours, (double)idle_wakeups / hours, (double)runs / hours,
+    late_count ? (double)late_sum / late_count : 0.0, late_max);
+}
+
+int main (int argc, char *argv[]) {
+  unsigned hours = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+  unsigned long wakeups = 0, runs = 0;
+
+  sessions = argc > 2 ? (unsigned)atoi(argv[2]) : 12;
+  flush_ms = argc > 3 ? (unsigned)atoi(argv[3]) : 15;
+  if (!hours || !sessions) {
+    fprintf(stderr, "usage: evsim [hours] [sessions_per_hour] [flush_ms]\n");
+    return 1;
+  }
+  sim_end = hours * 3600000UL;
+
+  use_heap = 0;
+  sim_reset();
+  run_scan(&wakeups, &runs);
+  report("linear scan", hours, wakeups, runs);
+
+  use_heap = 1;
+  sim_reset();
+  if (!setjmp(sim_done)) {
+    olv_ev_at(&heap_ev[EV_BUTTON], sim_now);
+    olv_ev_run(sim_flush_heap);
+  }
+  report("deadline heap", hours, olv_ev_wakeups, olv_ev_runs);
+  return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * logdump - formats the binary log of src/olv_log/log.h on the host.
+ *
+ * build: gcc -O2 -o logdump logdump.c
+ *
+ *   logdump firmware.elf /dev/ttyACM0
+ *     starts "log bin" on the watch shell and prints the records as they
+ *     come, with the format strings of the .olv_log section of the elf the
+ *     watch runs. ctrl-c stops the watch and prints its counts.
+ *
+ * the watch sends "OL", the size of its .olv_log section as u32, then the
+ * records (header, time, arguments as u32, little endian) until a zero
+ * word. the elf must be the one flashed, a different size of the section
+ * is refused.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define VALID 0x80
+#define ISR 0x40
+#define COUNT 0x0F
+#define DROPPED 0xFFFF
+
+static int fd;
+static volatile sig_atomic_t stop;
+
+static char *strings;
+static uint32_t strings_size;
+
+static uint32_t get16 (const uint8_t *p) {
+  return p[0] | p[1] << 8;
+}
+
+static uint32_t get32 (const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// the .olv_log section of a 32 bit little endian elf
+static int load_strings (const char *path) {
+  uint8_t eh[52], sh[40], names_sh[40];
+  uint32_t shoff, shentsize, shnum, i;
+  char name[16];
+  FILE *f;
+
+  if (!(f = fopen(path, "rb"))) { perror(path); return 0; }
+  if (fread(eh, 1, sizeof(eh), f) != sizeof(eh) || memcmp(eh, "\177ELF\1\1", 6)) {
+    fprintf(stderr, "%s: not a 32 bit little endian elf\n", path);
+    return 0;
+  }
+  shoff = get32(eh + 32);
+  shentsize = get16(eh + 46);
+  shnum = get16(eh + 48);
+
+  if (fseek(f, shoff + get16(eh + 50) * shentsize, SEEK_SET) || fread(names_sh, 1, sizeof(names_sh), f) != sizeof(names_sh)) {
+    fprintf(stderr, "%s: no section names\n", path);
+    return 0;
+  }
+
+  for (i = 0; i < shnum; i++) {
+    if (fseek(f, shoff + i * shentsize, SEEK_SET) || fread(sh, 1, sizeof(sh), f) != sizeof(sh)) break;
+    memset(name, 0, sizeof(name));
+    if (fseek(f, get32(names_sh + 16) + get32(sh), SEEK_SET) || !fread(name, 1, sizeof(name) - 1, f)) break;
+    if (strcmp(name, ".olv_log")) continue;
+
+    strings_size = get32(sh + 20);
+    strings = calloc(1, strings_size + 1);
+    if (fseek(f, get32(sh + 16), SEEK_SET) || fread(strings, 1, strings_size, f) != strings_size) break;
+    fclose(f);
+    return 1;
+  }
+
+  fprintf(stderr, "%s: no .olv_log section\n", path);
+  return 0;
+}
+
+static int out (const void *buf, size_t n) {
+  const uint8_t *p = buf;
+  ssize_t r;
+  while (n) {
+    if ((r = write(fd, p, n)) <= 0) { perror("logdump"); return 0; }
+    p += r;
+    n -= (size_t)r;
+  }
+  return 1;
+}
+
+// the next byte from the watch, waiting as long as it takes. after ctrl-c
+// one byte stops the watch, two seconds without any give up.
+static int next (void) {
+  static uint8_t in[4096];
+  static size_t in_len, in_pos;
+  static int idle;
+  ssize_t r;
+
+  while (in_pos == in_len) {
+    if (stop == 1) {
+      stop = 2;
+      if (!out("q", 1)) return -1;
+    }
+    if ((r = read(fd, in, sizeof(in))) < 0) return -1;
+    if (r == 0) {
+      if (!stop || ++idle == 10) continue;
+      return -1;
+    }
+    in_len = (size_t)r;
+    in_pos = 0;
+    idle = 0;
+  }
+  return in[in_pos++];
+}
+
+static int next32 (uint32_t *v) {
+  uint8_t b[4];
+  int i, c;
+  for (i = 0; i < 4; i++) {
+    if ((c = next()) < 0) return 0;
+    b[i] = (uint8_t)c;
+  }
+  *v = get32(b);
+  return 1;
+}
+
+// waits for the marker, what comes before is echoed text
+static int expect (const char *marker, int echo) {
+  int k = 0, c;
+  while (marker[k]) {
+    if ((c = next()) < 0) return 0;
+    if (echo) putchar(c);
+    k = c == marker[k] ? k + 1 : c == marker[0];
+  }
+  return 1;
+}
+
+// the conversions of chprintf, the arguments are u32 of the watch
+static void format (const char *fmt, const uint32_t *args, unsigned count) {
+  char spec[32];
+  unsigned used = 0;
+  uint32_t a;
+  size_t k;
+
+  for (; *fmt; fmt++) {
+    if (*fmt != '%') { putchar(*fmt); continue; }
+    if (fmt[1] == '%') { putchar('%'); fmt++; continue; }
+
+    spec[0] = '%';
+    for (k = 1, fmt++; *fmt && strchr("-+ #0123456789.", *fmt) && k < sizeof(spec) - 4; fmt++) spec[k++] = *fmt;
+    if (*fmt == 'l') fmt++;
+    if (!*fmt) break;
+
+    a = used < count ? args[used] : 0;
+    used++;
+    switch (*fmt) {
+    case 'd': case 'D': case 'i': case 'I':
+      strcpy(spec + k, "ld");
+      printf(spec, (long)(int32_t)a);
+      break;
+    case 'u': case 'U': case 'x': case 'X': case 'o': case 'O':
+      spec[k++] = 'l';
+      spec[k++] = (char)(*fmt == 'U' ? 'u' : *fmt == 'O' ? 'o' : *fmt);
+      spec[k] = 0;
+      printf(spec, (unsigned long)a);
+      break;
+    case 'c':
+      strcpy(spec + k, "c");
+      printf(spec, (int)a);
+      break;
+    case 'p':
+      printf("0x%08lx", (unsigned long)a);
+      break;
+    default:
+      // strings are in the flash of the watch
+      printf("<%c 0x%08lx>", *fmt, (unsigned long)a);
+    }
+  }
+}
+
+static void on_signal (int sig) {
+  (void)sig;
+  stop = 1;
+}
+
+int main (int argc, char *argv[]) {
+  uint32_t header, time, args[COUNT], size, id, i;
+  struct termios tio;
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: logdump firmware.elf /dev/ttyACM0\n");
+    return 1;
+  }
+  if (!load_strings(argv[1])) return 1;
+
+  if ((fd = open(argv[2], O_RDWR | O_NOCTTY)) < 0 || tcgetattr(fd, &tio)) { perror(argv[2]); return 1; }
+  cfmakeraw(&tio);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 2;
+  tcsetattr(fd, TCSANOW, &tio);
+  tcflush(fd, TCIOFLUSH);
+  signal(SIGINT, on_signal);
+
+  if (!out("log bin\r", 8) || !expect("OL", 0) || !next32(&size)) {
+    fprintf(stderr, "%s: log mode did not start\n", argv[2]);
+    return 1;
+  }
+  if (size != strings_size) {
+    fprintf(stderr, "%s: the watch has %u bytes of strings, the elf %u, not the firmware flashed\n", argv[1], size, strings_size);
+    out("q", 1);
+    return 1;
+  }
+
+  while (next32(&header) && header) {
+    if (!(header & VALID)) { fprintf(stderr, "logdump: broken record\n"); break; }
+    if (!next32(&time)) break;
+    for (i = 0; i < (header & COUNT) && next32(args + i); i++);
+
+    id = header >> 16;
+    printf("%5u.%03u %c ", time / 1000, time % 1000, header & ISR ? 'i' : 't');
+    if (id == DROPPED) printf("%u records dropped", args[0]);
+    else if (id < strings_size) format(strings + id, args, header & COUNT);
+    else printf("bad string %u", id);
+    putchar('\n');
+    fflush(stdout);
+  }
+
+  // the counts of the watch
+  if (!expect("ch> ", 1)) fprintf(stderr, "\nlogdump: the watch stopped sending\n");
+  putchar('\n');
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * powersim - host simulation of the olv power and refresh policy.
+ *
+ * build: gcc -O2 -o powersim powersim.c
+ *
+ *   powersim trace_file
+ *   powersim [hours] [sessions_per_hour] [usb_hours]
+ *
+ * runs olv_power_policy() of src/olv_power/power.c against an activity
+ * trace and compares it to the old fixed policy: the display on for 20 s
+ * after every input and as long as usb is attached, with the second hand
+ * always moving. a trace has one "<ms> button|power|usb+|usb-" line per
+ * input, ordered by time. without a trace every session of the synthetic
+ * one starts with the power button followed by a few presses, usb is
+ * attached for the first usb_hours (default 0). prints the wake-ups per
+ * hour (face updates, inputs and policy deadlines), the frames per hour
+ * and how many seconds per hour the display spent in every state.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define OLV_POWER_HOST
+#define OLV_EV_STOP 0xFFFFFFFFUL
+
+#include "../src/olv_power/power.c"
+
+// the values of main.c
+static const olv_power_config cfg = {10000, 20000, 60000, 2000, 33, 100};
+#define OLD_TIMEOUT 20000
+
+#define IN_BUTTON 0
+#define IN_POWER 1
+#define IN_USB_ON 2
+#define IN_USB_OFF 3
+
+typedef struct {
+  unsigned long t;
+  int kind;
+} input;
+
+static input *trace;
+static unsigned count, size;
+
+static void add (unsigned long t, int kind) {
+  if (count == size) {
+    size = size ? size * 2 : 256;
+    trace = realloc(trace, size * sizeof(*trace));
+    if (!trace) { perror("powersim"); exit(1); }
+  }
+  trace[count].t = t;
+  trace[count].kind = kind;
+  count++;
+}
+
+static int load (const char *path) {
+  static const char *const kinds[] = {"button", "power", "usb+", "usb-"};
+  char line[80], word[16];
+  unsigned long t;
+  int k, n = 0;
+  FILE *f = fopen(path, "r");
+
+  if (!f) { perror(path); return 0; }
+  while (fgets(line, sizeof(line), f)) {
+    n++;
+    if (line[0] == '#' || line[0] == '\n') continue;
+    if (sscanf(line, "%lu %15s", &t, word) != 2) k = 4;
+    else for (k = 0; k < 4 && strcmp(word, kinds[k]); k++);
+    if (k == 4 || (count && t < trace[count - 1].t)) {
+      fprintf(stderr, "%s:%d: bad line\n", path, n);
+      fclose(f);
+      return 0;
+    }
+    add(t, k);
+  }
+  fclose(f);
+  return 1;
+}
+
+static void synthesize (unsigned hours, unsigned sessions, unsigned usb_hours) {
+  unsigned long t, period = 3600000UL / sessions;
+  unsigned h, s;
+
+  srand(1);
+  if (usb_hours) add(0, IN_USB_ON);
+  for (h = 0; h < hours; h++) {
+    if (usb_hours && h == usb_hours) add(h * 3600000UL, IN_USB_OFF);
+    for (s = 0; s < sessions; s++) {
+      t = h * 3600000UL + s * period + (unsigned long)rand() % (period / 2);
+      add(t, IN_POWER);
+      // a glance is a single press, sometimes the menu is used for a while
+      if (rand() % 4 == 0) {
+        int presses = 2 + rand() % 8;
+        while (presses--) add(t += 500 + (unsigned long)rand() % 3000, IN_BUTTON);
+      }
+    }
+  }
+}
+
+typedef struct {
+  unsigned long wakeups, frames;
+  unsigned long ms[4];  // time in each OLV_POWER_ state
+} result;
+
+// steps through the trace one ms at a time
+static void simulate (int use_policy, unsigned long end, result *r) {
+  olv_power_inputs in = {0, 0, 1, 1};
+  olv_power_state st = {OLV_POWER_OFF, 0, 100, OLV_EV_STOP};
+  unsigned long t, last = 0, deadline = OLV_EV_STOP, frame_at = 0;
+  unsigned i = 0;
+  int on = 0, usb = 0;
+  uint8_t display;
+
+  memset(r, 0, sizeof(*r));
+  for (t = 0; t < end; t++) {
+    int changed = 0, inputs = 0;
+
+    for (; i < count && trace[i].t == t; i++) {
+      inputs++;
+      if (trace[i].kind == IN_USB_ON) usb = 1;
+      else if (trace[i].kind == IN_USB_OFF) usb = 0;
+      else if (use_policy) {
+        if (trace[i].kind == IN_POWER && st.display >= OLV_POWER_DIM) in.off = 1;
+        else if (trace[i].kind == IN_POWER) in.off = 0, last = t;
+        else if (!in.off) last = t;
+        else inputs--;
+      } else {
+        if (trace[i].kind == IN_POWER) on = !on;
+        last = t;
+      }
+      changed = 1;
+    }
+    r->wakeups += inputs;
+
+    if (use_policy) {
+      if (changed || t == deadline) {
+        uint8_t from = st.display;
+        if (t == deadline && !changed) r->wakeups++;
+        in.idle = t - last;
+        in.usb = usb;
+        olv_power_policy(&cfg, &in, &st);
+        if (st.display == OLV_POWER_OFF) in.off = 1;
+        deadline = st.next == OLV_EV_STOP ? OLV_EV_STOP : t + st.next;
+        // waking up draws the whole face
+        if (st.display >= OLV_POWER_DIM && (from < OLV_POWER_DIM || changed)) frame_at = t;
+      }
+      display = st.display;
+    } else {
+      if (on && !usb && t - last >= OLD_TIMEOUT) on = 0;
+      display = on || usb ? OLV_POWER_ON : OLV_POWER_OFF;
+      if (changed && display == OLV_POWER_ON) frame_at = t;
+      st.seconds = display == OLV_POWER_ON;
+      st.frame = cfg.frame_slow;
+    }
+    r->ms[display]++;
+
+    // face updates by the rtc alarm
+    if (display >= OLV_POWER_DIM && t % (st.seconds ? 1000 : 60000) == 0) {
+      r->wakeups++;
+      if (frame_at < t) frame_at = t;
+    }
+
+    // an invalidation waits for the next frame slot
+    if (frame_at == t && display >= OLV_POWER_DIM) {
+      r->frames++;
+      frame_at = 0;
+    } else if (frame_at == t) {
+      frame_at = 0;
+    }
+  }
+}
+
+static void report (const char *label, double hours, const result *r) {
+  printf("%-14s %7.0f wake-ups/h %7.0f frames/h   on %5.0f  dim %5.0f  sleep %5.0f  off %5.0f s/h\n",
+    label, r->wakeups / hours, r->frames / hours, r->ms[OLV_POWER_ON] / 1000.0 / hours,
+    r->ms[OLV_POWER_DIM] / 1000.0 / hours, r->ms[OLV_POWER_SLEEP] / 1000.0 / hours,
+    r->ms[OLV_POWER_OFF] / 1000.0 / hours);
+}
+
+int main (int argc, char *argv[]) {
+  unsigned long end;
+  double hours;
+  result r;
+
+  if (argc == 2 && (argv[1][0] < '0' || argv[1][0] > '9')) {
+    if (!load(argv[1]) || !count) return 1;
+    end = trace[count - 1].t + cfg.off_ms + 1;
+  } else {
+    unsigned h = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+    unsigned sessions = argc > 2 ? (unsigned)atoi(argv[2]) : 12;
+    unsigned usb_hours = argc > 3 ? (unsigned)atoi(argv[3]) : 0;
+    if (!h || !sessions) {
+      fprintf(stderr, "usage: powersim trace_file | powersim [hours] [sessions_per_hour] [usb_hours]\n");
+      return 1;
+    }
+    synthesize(h, sessions, usb_hours);
+    end = h * 3600000UL;
+  }
+  hours = end / 3600000.0;
+
+  simulate(0, end, &r);
+  report("fixed 20 s", hours, &r);
+  simulate(1, end, &r);
+  report("adaptive", hours, &r);
+  return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * qimg - encoder and decode benchmark for the GDISP compressed image format.
+ *
+ * build: gcc -O2 -I../include/chibios/ext/gfx/include -o qimg qimg.c -lm
+ *
+ *   qimg enc image.ppm name [sync_rows] > name.h
+ *     converts a binary ppm (P6, maxval 255) into a C header holding
+ *     "static const struct image name", ready for gdispDrawImage().
+ *
+ *   qimg bin image.ppm [sync_rows] > name.qim
+ *     the same as the image payload of an asset pack, for tools/assetpack.
+ *
+ *   qimg bench [image.ppm ...]
+ *     encodes every image, checks that it decodes back to the same pixels
+ *     and prints the compression ratio and the decode throughput for full
+ *     frames and for a 32x32 damage region. without arguments a gradient
+ *     and a synthetic watch face are benchmarked.
+ *
+ * the host decode rate is only useful to compare encoder settings,
+ * the cortex-m3 at 72 MHz is roughly 20-30 times slower.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "gdisp/image.h"
+
+#define DEFAULT_SYNC_ROWS 16
+
+typedef struct {
+  unsigned width, height;
+  uint16_t *pixels;
+} picture;
+
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  uint32_t *sync;
+  unsigned sync_count;
+  struct image img;
+} encoded;
+
+static uint16_t rgb565 (unsigned r, unsigned g, unsigned b) {
+  return (r & 0xF8) << 8 | (g & 0xFC) << 3 | (b & 0xF8) >> 3;
+};
+
+static int read_ppm (const char *path, picture *pic) {
+  FILE *f = fopen(path, "rb");
+  unsigned maxval, i;
+  uint8_t rgb[3];
+
+  if (!f || fscanf(f, "P6 %u %u %u", &pic->width, &pic->height, &maxval) != 3 || maxval != 255) {
+    fprintf(stderr, "%s: not a binary 8 bit ppm\n", path);
+    if (f) fclose(f);
+    return 0;
+  }
+  fgetc(f);
+
+  pic->pixels = malloc(pic->width * pic->height * sizeof(uint16_t));
+  for (i = 0; i < pic->width * pic->height; i++) {
+    if (fread(rgb, 3, 1, f) != 1) {
+      fprintf(stderr, "%s: truncated\n", path);
+      fclose(f);
+      return 0;
+    }
+    pic->pixels[i] = rgb565(rgb[0], rgb[1], rgb[2]);
+  }
+
+  fclose(f);
+  return 1;
+};
+
+static void put (encoded *e, uint8_t b) {
+  e->data = realloc(e->data, e->size + 1);
+  e->data[e->size++] = b;
+};
+
+static void put_run (encoded *e, unsigned run) {
+  if (!run) return;
+  if (run <= IMAGE_RUN_MAX) {
+    put(e, IMAGE_OP_RUN | (run - 1));
+  } else {
+    put(e, IMAGE_OP_LRUN);
+    put(e, run - 63);
+  }
+};
+
+// wrap a component difference into the signed range of its bit width
+static int wrap (int d, int bits) {
+  int m = 1 << bits;
+  d &= m - 1;
+  return d >= m / 2 ? d - m : d;
+};
+
+static void encode (const picture *pic, unsigned sync_rows, encoded *e) {
+  uint16_t index[64];
+  uint16_t prev, px;
+  unsigned run, blk, i, start, end, h;
+  int dr, dg, db, drdg, dbdg;
+
+  memset(e, 0, sizeof(*e));
+  e->sync_count = (pic->height + sync_rows - 1) / sync_rows;
+  e->sync = malloc(e->sync_count * sizeof(uint32_t));
+
+  for (blk = 0; blk < e->sync_count; blk++) {
+    e->sync[blk] = e->size;
+    memset(index, 0, sizeof(index));
+    prev = 0;
+    run = 0;
+
+    start = blk * sync_rows * pic->width;
+    end = (blk + 1) * sync_rows;
+    end = (end > pic->height ? pic->height : end) * pic->width;
+
+    for (i = start; i < end; i++) {
+      px = pic->pixels[i];
+
+      if (px == prev) {
+        if (++run == IMAGE_LRUN_MAX) {
+          put_run(e, run);
+          run = 0;
+        }
+        continue;
+      }
+      put_run(e, run);
+      run = 0;
+
+      h = IMAGE_HASH(px);
+      if (index[h] == px) {
+        put(e, IMAGE_OP_INDEX | h);
+      } else {
+        index[h] = px;
+
+        dr = wrap((px >> 11) - (prev >> 11), 5);
+        dg = wrap(((px >> 5) & 0x3F) - ((prev >> 5) & 0x3F), 6);
+        db = wrap((px & 0x1F) - (prev & 0x1F), 5);
+        drdg = wrap(dr - dg, 5);
+        dbdg = wrap(db - dg, 5);
+
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+          put(e, IMAGE_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+        } else if (drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+          put(e, IMAGE_OP_LUMA | (dg + 32));
+          put(e, (drdg + 8) << 4 | (dbdg + 8));
+        } else {
+          put(e, IMAGE_OP_RGB);
+          put(e, px >> 8);
+          put(e, px & 0xFF);
+        }
+      }
+      prev = px;
+    }
+    put_run(e, run);
+  }
+
+  e->img.width = pic->width;
+  e->img.height = pic->height;
+  e->img.syncRows = sync_rows;
+  e->img.syncCount = e->sync_count;
+  e->img.syncTable = e->sync;
+  e->img.data = e->data;
+};
+
+static int cmd_enc (const char *path, const char *name, unsigned sync_rows) {
+  picture pic;
+  encoded e;
+  size_t i;
+
+  if (!read_ppm(path, &pic)) return 1;
+  encode(&pic, sync_rows, &e);
+
+  printf("// generated by tools/qimg from %s: %ux%u, %u bytes (raw %u bytes)\n\n",
+    path, pic.width, pic.height, (unsigned)e.size, pic.width * pic.height * 2);
+  printf("#include \"gdisp/image.h\"\n\n");
+
+  printf("static const uint8_t %s_data[%u] = {", name, (unsigned)e.size);
+  for (i = 0; i < e.size; i++) printf("%s0x%X", i ? (i % 24 ? "," : ",\n\t") : "\n\t", e.data[i]);
+  printf("\n};\n\n");
+
+  printf("static const uint32_t %s_sync[%u] = {", name, e.sync_count);
+  for (i = 0; i < e.sync_count; i++) printf("%s%u", i ? (i % 16 ? "," : ",\n\t") : "\n\t", e.sync[i]);
+  printf("\n};\n\n");
+
+  printf("static const struct image %s = {\n\t%u, %u, %u, %u, %s_sync, %s_data\n};\n",
+    name, pic.width, pic.height, sync_rows, e.sync_count, name, name);
+  return 0;
+};
+
+// width, height, sync rows, sync count as u16, the sync table as u32 and the
+// data, little endian, see src/olv_asset/asset.h
+static int cmd_bin (const char *path, unsigned sync_rows) {
+  picture pic;
+  encoded e;
+  uint8_t b[4];
+  unsigned i;
+
+  if (!read_ppm(path, &pic)) return 1;
+  encode(&pic, sync_rows, &e);
+
+  b[0] = pic.width & 0xFF; b[1] = pic.width >> 8;
+  b[2] = pic.height & 0xFF; b[3] = pic.height >> 8;
+  fwrite(b, 1, 4, stdout);
+  b[0] = sync_rows & 0xFF; b[1] = sync_rows >> 8;
+  b[2] = e.sync_count & 0xFF; b[3] = e.sync_count >> 8;
+  fwrite(b, 1, 4, stdout);
+  for (i = 0; i < e.sync_count; i++) {
+    b[0] = e.sync[i] & 0xFF; b[1] = e.sync[i] >> 8 & 0xFF;
+    b[2] = e.sync[i] >> 16 & 0xFF; b[3] = e.sync[i] >> 24;
+    fwrite(b, 1, 4, stdout);
+  }
+  fwrite(e.data, 1, e.size, stdout);
+  return 0;
+};
+
+static double now (void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+};
+
+// decode a part the same way gdispDrawImagePart() does
+static void decode_part (const struct image *img, unsigned x, unsigned y, unsigned cx, unsigned cy, uint16_t *out) {
+  imagedecoder_t d;
+  unsigned row;
+
+  for (row = _imageDecodeStart(&d, img, y); row < y; row++)
+    _imageDecode(&d, 0, img->width);
+
+  for (; cy; cy--, out += cx) {
+    if (x) _imageDecode(&d, 0, x);
+    _imageDecode(&d, out, cx);
+    if (x + cx < img->width) _imageDecode(&d, 0, img->width - x - cx);
+    if (++y % img->syncRows == 0 && cy > 1) _imageDecodeStart(&d, img, y);
+  }
+};
+
+static void bench (const char *label, const picture *pic) {
+  encoded e;
+  uint16_t *out = malloc(pic->width * pic->height * sizeof(uint16_t));
+  unsigned raw = pic->width * pic->height * 2;
+  unsigned loops, i, cx, cy, x, y;
+  double t;
+
+  encode(pic, DEFAULT_SYNC_ROWS, &e);
+
+  decode_part(&e.img, 0, 0, pic->width, pic->height, out);
+  if (memcmp(out, pic->pixels, raw)) {
+    printf("%-20s DECODE MISMATCH\n", label);
+    exit(1);
+  }
+
+  loops = 2000;
+  t = now();
+  for (i = 0; i < loops; i++) decode_part(&e.img, 0, 0, pic->width, pic->height, out);
+  t = (now() - t) / loops;
+
+  printf("%-20s %4ux%-4u %6u -> %6u bytes (%4.2fx)  full %7.1f us %7.1f Mpx/s",
+    label, pic->width, pic->height, raw, (unsigned)(e.size + e.sync_count * 4),
+    (double)raw / (e.size + e.sync_count * 4), t * 1e6, pic->width * pic->height / t / 1e6);
+
+  cx = pic->width < 32 ? pic->width : 32;
+  cy = pic->height < 32 ? pic->height : 32;
+  x = (pic->width - cx) / 2;
+  y = (pic->height - cy) / 2;
+  loops = 20000;
+  t = now();
+  for (i = 0; i < loops; i++) decode_part(&e.img, x, y, cx, cy, out);
+  t = (now() - t) / loops;
+  printf("  %ux%u part %6.1f us\n", cx, cy, t * 1e6);
+
+  free(out);
+  free(e.data);
+  free(e.sync);
+};
+
+// synthetic stand-ins for face backgrounds, 128x128 like the display
+static void make_gradient (picture *pic) {
+  unsigned x, y;
+  pic->width = pic->height = 128;
+  pic->pixels = malloc(128 * 128 * sizeof(uint16_t));
+  for (y = 0; y < 128; y++)
+    for (x = 0; x < 128; x++)
+      pic->pixels[y * 128 + x] = rgb565(x * 2, y * 2, 255 - (x + y));
+};
+
+static void make_face (picture *pic) {
+  unsigned x, y;
+  double dx, dy, r, a, v;
+  pic->width = pic->height = 128;
+  pic->pixels = malloc(128 * 128 * sizeof(uint16_t));
+  for (y = 0; y < 128; y++) {
+    for (x = 0; x < 128; x++) {
+      dx = x - 63.5;
+      dy = y - 63.5;
+      r = sqrt(dx * dx + dy * dy);
+      a = atan2(dy, dx) * 30 / M_PI;
+      v = 0;
+      if (r < 58) v = 40 - r / 2;
+      if (r > 56 && r < 58.5) v = 255;
+      if (r > 51 && r < 56.5 && fabs(a - floor(a + 0.5)) < 0.08) v = 200;
+      pic->pixels[y * 128 + x] = rgb565(v * 0.6, v * 0.8, v);
+    }
+  }
+};
+
+int main (int argc, char *argv[]) {
+  picture pic;
+  int i;
+
+  if (argc >= 4 && !strcmp(argv[1], "enc"))
+    return cmd_enc(argv[2], argv[3], argc > 4 ? (unsigned)atoi(argv[4]) : DEFAULT_SYNC_ROWS);
+
+  if (argc >= 3 && !strcmp(argv[1], "bin"))
+    return cmd_bin(argv[2], argc > 3 ? (unsigned)atoi(argv[3]) : DEFAULT_SYNC_ROWS);
+
+  if (argc >= 2 && !strcmp(argv[1], "bench")) {
+    if (argc == 2) {
+      make_gradient(&pic);
+      bench("gradient", &pic);
+      make_face(&pic);
+      bench("face", &pic);
+    }
+    for (i = 2; i < argc; i++) {
+      if (!read_ppm(argv[i], &pic)) return 1;
+      bench(argv[i], &pic);
+    }
+    return 0;
+  }
+
+  fprintf(stderr, "usage: qimg enc image.ppm name [sync_rows] > name.h\n       qimg bin image.ppm [sync_rows] > name.qim\n"
+    "       qimg bench [image.ppm ...]\n");
+  return 1;
+};
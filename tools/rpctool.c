@@ -0,0 +1,340 @@
+/*
+ * rpctool - host side of the olv binary remote calls.
+ *
+ * build: gcc -O2 -o rpctool rpctool.c
+ *
+ *   rpctool /dev/ttyACM0 command ...
+ *     starts "rpc" on the watch shell, runs the commands in one batch and
+ *     prints their results:
+ *       ping              round trip
+ *       date              wall clock and uptime of the watch
+ *       sync              sets the watch to the local time of the host
+ *       led COLORS PCT    1 = R, 2 = G, 4 = B, PCT in hundredths of a percent
+ *       led_off COLORS
+ *       vibrator 0|1|2    off, on, toggle
+ *       bench [N]         N pings (default 10000) one at a time, then
+ *                         pipelined, and the calls per second of both
+ *       perf [MS] [N]     the counters of src/olv_perf/perf.h every MS ms
+ *                         (default 1000), N times (default 10), as csv
+ *                         for graphing
+ *
+ *   rpctool /dev/ttyACM0 telemetry [MS] [N]
+ *     the same csv from the records the watch sends every MS ms on its
+ *     own ("telemetry" on the shell), without polling
+ *
+ * the protocol is described in src/olv_rpc/rpc.h, the framing is
+ * src/olv_rpc/frame.c itself.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/time.h>
+
+#include "../src/olv_rpc/frame.c"
+
+#define PAYLOAD 64
+#define WINDOW 32
+
+#define PING 0x00
+#define DATE 0x01
+#define SET_TIME 0x02
+#define LED_ENABLE 0x03
+#define LED_DISABLE 0x04
+#define VIBRATOR 0x05
+#define PERF 0x06
+#define EXIT 0xFF
+
+static const char *status_names[] = {"ok", "broken frame", "unknown command", "wrong args"};
+
+static int fd;
+static uint8_t next_id;
+
+// the responses as received
+static uint8_t in[4096], frame[4096];
+static size_t in_len, in_pos, frame_len;
+
+static double now (void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int out (const void *buf, size_t n) {
+  const uint8_t *p = buf;
+  ssize_t r;
+  while (n) {
+    if ((r = write(fd, p, n)) <= 0) { perror("rpctool"); return 0; }
+    p += r;
+    n -= (size_t)r;
+  }
+  return 1;
+}
+
+// the next byte from the watch, -1 after two seconds without any
+static int next (void) {
+  ssize_t r;
+  if (in_pos == in_len) {
+    if ((r = read(fd, in, sizeof(in))) <= 0) return -1;
+    in_len = (size_t)r;
+    in_pos = 0;
+  }
+  return in[in_pos++];
+}
+
+// waits for the marker, what comes before is echoed text
+static int expect (const char *marker, int echo) {
+  int k = 0, c;
+  while (marker[k]) {
+    if ((c = next()) < 0) return 0;
+    if (echo) putchar(c);
+    k = c == marker[k] ? k + 1 : c == marker[0];
+  }
+  return 1;
+}
+
+static uint8_t request (uint8_t cmd, const uint8_t *arg, size_t n) {
+  uint8_t msg[2 + PAYLOAD], enc[OLV_FRAME_ENCODED(2 + PAYLOAD)];
+  msg[0] = next_id;
+  msg[1] = cmd;
+  if (n) memcpy(msg + 2, arg, n);
+  if (!out(enc, olv_frame_encode(enc, msg, n + 2))) exit(1);
+  return next_id++;
+}
+
+// the next response, its message is in frame and frame_len bytes long
+static void response (uint8_t id, uint8_t cmd) {
+  int b;
+  long m;
+
+  for (;;) {
+    if ((b = next()) < 0) { fprintf(stderr, "rpctool: no response\n"); exit(1); }
+    if (b) {
+      if (frame_len < sizeof(frame)) frame[frame_len++] = (uint8_t)b;
+      continue;
+    }
+    if (!frame_len) continue;
+    m = olv_frame_decode(frame, frame_len);
+    frame_len = 0;
+    if (m < 2 || frame[0] != id) {
+      fprintf(stderr, "rpctool: broken response to 0x%02x\n", cmd);
+      exit(1);
+    }
+    if (frame[1]) {
+      fprintf(stderr, "rpctool: 0x%02x: %s\n", cmd, frame[1] < 4 ? status_names[frame[1]] : "?");
+      exit(1);
+    }
+    frame_len = (size_t)m;
+    return;
+  }
+}
+
+static uint32_t get32 (const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put32 (uint8_t *p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8 & 0xFF;
+  p[2] = v >> 16 & 0xFF;
+  p[3] = v >> 24 & 0xFF;
+}
+
+// pings with up to window of them on the way
+static double bench (unsigned long n, unsigned window) {
+  uint8_t arg[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  uint8_t first = next_id;
+  unsigned long sent = 0, done = 0;
+  double start = now();
+
+  while (done < n) {
+    while (sent < n && sent - done < window) {
+      request(PING, arg, sizeof(arg));
+      sent++;
+    }
+    response((uint8_t)(first + done), PING);
+    if (frame_len != 2 + sizeof(arg) || memcmp(frame + 2, arg, sizeof(arg))) {
+      fprintf(stderr, "rpctool: ping came back wrong\n");
+      exit(1);
+    }
+    done++;
+  }
+  return n / (now() - start);
+}
+
+// in the order of olv_perf_snapshot
+static const char *perf_names[] = {"uptime", "frames", "pixels", "spi_bytes", "spi_us", "i2c_done", "i2c_errors",
+  "usb_in", "usb_out", "idle", "late_max", "heap_free", "heap_min", "core_free", "stack_free"};
+#define PERF_WORDS (sizeof(perf_names) / sizeof(perf_names[0]))
+
+static void perf (unsigned long ms, unsigned long n) {
+  unsigned i;
+
+  for (i = 0; i < PERF_WORDS; i++) printf("%s%s", perf_names[i], i + 1 < PERF_WORDS ? "," : "\n");
+  while (n--) {
+    response(request(PERF, NULL, 0), PERF);
+    if (frame_len != 4 + PERF_WORDS * 4 || frame[2] != 'P' || frame[3] != 2) {
+      fprintf(stderr, "rpctool: unknown perf record\n");
+      exit(1);
+    }
+    for (i = 0; i < PERF_WORDS; i++) printf("%u%s", get32(frame + 4 + i * 4), i + 1 < PERF_WORDS ? "," : "\n");
+    fflush(stdout);
+    if (n) usleep(ms * 1000);
+  }
+}
+
+static void telemetry (unsigned long ms, unsigned long n) {
+  uint8_t rec[2 + PERF_WORDS * 4];
+  char cmd[32];
+  unsigned long waited;
+  unsigned i;
+  size_t k;
+  int c;
+
+  snprintf(cmd, sizeof(cmd), "telemetry %lu\r", ms);
+  if (!out(cmd, strlen(cmd)) || !expect("OT", 0)) {
+    fprintf(stderr, "rpctool: telemetry did not start\n");
+    exit(1);
+  }
+
+  for (i = 0; i < PERF_WORDS; i++) printf("%s%s", perf_names[i], i + 1 < PERF_WORDS ? "," : "\n");
+  while (n--) {
+    for (k = 0; k < sizeof(rec); k++) {
+      // next() gives up after two seconds, a record may take longer
+      for (waited = 0; (c = next()) < 0; waited += 2000)
+        if (waited > ms) { fprintf(stderr, "rpctool: no record\n"); exit(1); }
+      rec[k] = (uint8_t)c;
+    }
+    if (rec[0] != 'P' || rec[1] != 2) {
+      fprintf(stderr, "rpctool: unknown perf record\n");
+      exit(1);
+    }
+    for (i = 0; i < PERF_WORDS; i++) printf("%u%s", get32(rec + 2 + i * 4), i + 1 < PERF_WORDS ? "," : "\n");
+    fflush(stdout);
+  }
+
+  // a record may still come before the statistics
+  out("x", 1);
+  expect("records", 0);
+  fputs("records", stdout);
+  expect("ch> ", 1);
+  putchar('\n');
+}
+
+static uint8_t ids[64], cmds[64];
+static int pending;
+
+// the responses to the requests sent so far
+static void results (void) {
+  uint64_t ms;
+  time_t t;
+  char s[32];
+  int i;
+
+  for (i = 0; i < pending; i++) {
+    response(ids[i], cmds[i]);
+    if (cmds[i] == DATE && frame_len == 14) {
+      ms = get32(frame + 2) | (uint64_t)get32(frame + 6) << 32;
+      t = (time_t)(ms / 1000);
+      strftime(s, sizeof(s), "%Y-%m-%d %H:%M:%S", gmtime(&t));
+      printf("date %s.%03u, up %u s\n", s, (unsigned)(ms % 1000), get32(frame + 10));
+    }
+    else printf("%s ok\n", cmds[i] == PING ? "ping" : cmds[i] == SET_TIME ? "sync" : cmds[i] == LED_ENABLE ? "led" :
+      cmds[i] == LED_DISABLE ? "led_off" : "vibrator");
+  }
+  pending = 0;
+}
+
+static void call (uint8_t cmd, const uint8_t *arg, size_t n) {
+  if (pending == 64) results();
+  cmds[pending] = cmd;
+  ids[pending++] = request(cmd, arg, n);
+}
+
+int main (int argc, char *argv[]) {
+  struct termios tio;
+  uint8_t arg[PAYLOAD];
+  unsigned long n;
+  time_t t;
+  int i;
+
+  if (argc < 3) {
+    fprintf(stderr, "usage: rpctool device command ...\n");
+    return 1;
+  }
+
+  if ((fd = open(argv[1], O_RDWR | O_NOCTTY)) < 0) { perror(argv[1]); return 1; }
+  tcgetattr(fd, &tio);
+  cfmakeraw(&tio);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 20;
+  tcsetattr(fd, TCSANOW, &tio);
+  tcflush(fd, TCIOFLUSH);
+
+  if (!strcmp(argv[2], "telemetry")) {
+    telemetry(argc > 3 ? strtoul(argv[3], NULL, 10) : 1000, argc > 4 ? strtoul(argv[4], NULL, 10) : 10);
+    close(fd);
+    return 0;
+  }
+
+  if (!out("rpc\r", 4) || !expect("OC", 0)) {
+    fprintf(stderr, "%s: rpc mode did not start\n", argv[1]);
+    return 1;
+  }
+
+  // the requests go out together, the responses are taken in order after
+  for (i = 2; i < argc; i++) {
+    if (!strcmp(argv[i], "bench")) {
+      n = i + 1 < argc ? strtoul(argv[++i], NULL, 10) : 10000;
+      results();
+      printf("one at a time %.0f calls/s\n", bench(n, 1));
+      printf("pipelined     %.0f calls/s\n", bench(n, WINDOW));
+    }
+    else if (!strcmp(argv[i], "perf")) {
+      // the watch leaves rpc mode after 10 s without a request
+      n = i + 1 < argc ? strtoul(argv[++i], NULL, 10) : 1000;
+      results();
+      perf(n < 9000 ? n : 9000, i + 1 < argc ? strtoul(argv[++i], NULL, 10) : 10);
+    }
+    else if (!strcmp(argv[i], "ping")) call(PING, NULL, 0);
+    else if (!strcmp(argv[i], "date")) call(DATE, NULL, 0);
+    else if (!strcmp(argv[i], "sync")) {
+      // the watch keeps the local time
+      t = time(NULL);
+      put32(arg, (uint32_t)(t + localtime(&t)->tm_gmtoff));
+      call(SET_TIME, arg, 4);
+    }
+    else if (!strcmp(argv[i], "led") && i + 2 < argc) {
+      arg[0] = (uint8_t)atoi(argv[i + 1]);
+      arg[1] = atoi(argv[i + 2]) & 0xFF;
+      arg[2] = atoi(argv[i + 2]) >> 8 & 0xFF;
+      i += 2;
+      call(LED_ENABLE, arg, 3);
+    }
+    else if (!strcmp(argv[i], "led_off") && i + 1 < argc) {
+      arg[0] = (uint8_t)atoi(argv[++i]);
+      call(LED_DISABLE, arg, 1);
+    }
+    else if (!strcmp(argv[i], "vibrator") && i + 1 < argc) {
+      arg[0] = (uint8_t)atoi(argv[++i]);
+      call(VIBRATOR, arg, 1);
+    }
+    else {
+      fprintf(stderr, "unknown command %s\n", argv[i]);
+      break;
+    }
+  }
+  results();
+
+  // back to the shell, its statistics up to the prompt
+  response(request(EXIT, NULL, 0), EXIT);
+  expect("ch> ", 1);
+  putchar('\n');
+  close(fd);
+  return 0;
+}
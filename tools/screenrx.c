@@ -0,0 +1,316 @@
+/*
+ * screenrx - receiver for the olv screen stream.
+ *
+ * build: gcc -O2 -o screenrx screenrx.c -lm
+ *
+ *   screenrx /dev/ttyACM0 [frames] [prefix]
+ *     starts "stream [frames]" on the watch shell and rebuilds the frames,
+ *     with a prefix every frame is saved as prefix00000.ppm and so on.
+ *     ctrl-c ends the stream. a file instead of a tty is read as a
+ *     recorded stream.
+ *
+ *   screenrx bench [frames]
+ *     runs src/olv_stream/stream.c on a synthetic watch face with a moving
+ *     second hand, checks that every frame decodes back to the same pixels
+ *     and prints the bytes per frame.
+ *
+ * prints the frames, the bytes per frame and the rate. the frames are in
+ * the panel orientation, the watch turns them by 90 degrees.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/time.h>
+
+// just enough of ChibiOS to run the encoder
+#define OLV_STREAM_HOST
+#define FRAMEBUFFER_WIDTH 128
+#define FRAMEBUFFER_HEIGHT 128
+#define FRAMEBUFFER_ADDRESS sim_fb
+#define MS2ST(ms) (ms)
+#define TIME_IMMEDIATE 0
+#define Q_TIMEOUT -1
+#define EVENT_MASK(eid) (1 << (eid))
+typedef struct { int dummy; } BaseChannel;
+typedef struct { int dummy; } EventListener;
+typedef struct { unsigned long frames; } olv_render_stats;
+
+static uint16_t sim_fb[FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT];
+static uint8_t *sim_out;
+static size_t sim_len, sim_size;
+static olv_render_stats olv_render;
+static int olv_render_flushed;
+
+static size_t chnWriteTimeout (BaseChannel *chp, const uint8_t *bp, size_t n, int time) {
+  (void)chp; (void)time;
+  if (sim_len + n > sim_size) {
+    sim_size = (sim_len + n) * 2;
+    sim_out = realloc(sim_out, sim_size);
+    if (!sim_out) { perror("screenrx"); exit(1); }
+  }
+  memcpy(sim_out + sim_len, bp, n);
+  sim_len += n;
+  return n;
+}
+
+#define chnGetTimeout(chp, time) Q_TIMEOUT
+#define chEvtRegisterMask(esp, elp, mask) ((void)(esp), (void)(elp))
+#define chEvtUnregister(esp, elp) ((void)(esp), (void)(elp))
+#define chEvtWaitAnyTimeout(mask, time) 1
+#define chEvtGetAndClearEvents(mask)
+
+#include "../src/olv_stream/stream.c"
+
+#define W FRAMEBUFFER_WIDTH
+#define H FRAMEBUFFER_HEIGHT
+#define TILE OLV_STREAM_TILE
+
+// ---- the decoder ----
+
+typedef struct {
+  uint16_t px[W * H];   // rgb565
+  unsigned long frames, bytes, bytes_max, tiles;
+  unsigned long frame_bytes;
+} screen;
+
+// input, from a tty, a file or the bench output
+typedef struct {
+  int fd;
+  const uint8_t *mem;
+  size_t len, pos;
+} source;
+
+static int next (source *s) {
+  uint8_t b;
+  if (s->mem) return s->pos < s->len ? s->mem[s->pos++] : -1;
+  if (read(s->fd, &b, 1) != 1) return -1;
+  return b;
+}
+
+static int pixel (source *s, screen *sc, uint16_t *px) {
+  int hi = next(s), lo = next(s);
+  if (hi < 0 || lo < 0) return 0;
+  *px = (uint16_t)(hi << 8 | lo);
+  sc->frame_bytes += 2;
+  return 1;
+}
+
+static int tile (source *s, screen *sc, unsigned t) {
+  unsigned i = 0, n, k;
+  uint16_t px = 0;
+  int c;
+
+  if (t >= OLV_STREAM_TILES) return 0;
+  while (i < TILE * TILE) {
+    if ((c = next(s)) < 0) return 0;
+    sc->frame_bytes++;
+    n = (c & 0x7F) + 1;
+    if (i + n > TILE * TILE) return 0;
+    if (c & 0x80 && !pixel(s, sc, &px)) return 0;
+    for (k = 0; k < n; k++, i++) {
+      if (!(c & 0x80) && !pixel(s, sc, &px)) return 0;
+      sc->px[(t / OLV_STREAM_TILES_X * TILE + i / TILE) * W + t % OLV_STREAM_TILES_X * TILE + i % TILE] = px;
+    }
+  }
+  return 1;
+}
+
+// 1 for a frame, 0 at the end marker, -1 on an error
+static int frame (source *s, screen *sc, int sync) {
+  int c, prev = -1, count, t;
+
+  // text before the first frame is the echo of the command
+  for (;;) {
+    if ((c = next(s)) < 0) return -1;
+    if (prev == 'O' && (c == 'F' || c == 'E')) break;
+    if (!sync && prev >= 0) return -1;
+    prev = c;
+  }
+  if (c == 'E') return 0;
+
+  sc->frame_bytes = 5;
+  if (next(s) < 0 || next(s) < 0 || (count = next(s)) < 0) return -1;
+  sc->tiles += count;
+  while (count--) {
+    if ((t = next(s)) < 0) return -1;
+    sc->frame_bytes++;
+    if (!tile(s, sc, (unsigned)t)) return -1;
+  }
+
+  sc->frames++;
+  sc->bytes += sc->frame_bytes;
+  if (sc->frame_bytes > sc->bytes_max) sc->bytes_max = sc->frame_bytes;
+  return 1;
+}
+
+static int save (const screen *sc, const char *prefix) {
+  char name[256];
+  FILE *f;
+  unsigned i;
+
+  snprintf(name, sizeof(name), "%s%05lu.ppm", prefix, sc->frames - 1);
+  if (!(f = fopen(name, "wb"))) { perror(name); return 0; }
+  fprintf(f, "P6\n%d %d\n255\n", W, H);
+  for (i = 0; i < W * H; i++) {
+    uint16_t c = sc->px[i];
+    fputc((c >> 11) * 255 / 31, f);
+    fputc((c >> 5 & 0x3F) * 255 / 63, f);
+    fputc((c & 0x1F) * 255 / 31, f);
+  }
+  fclose(f);
+  return 1;
+}
+
+static void report (const screen *sc, double seconds) {
+  printf("%lu frames, %lu tiles, %.0f bytes avg, %lu bytes max", sc->frames, sc->tiles,
+    sc->frames ? (double)sc->bytes / sc->frames : 0.0, sc->bytes_max);
+  if (seconds > 0) printf(", %.1f frames/s, %.0f kB/s", sc->frames / seconds, sc->bytes / seconds / 1000);
+  printf("\n");
+}
+
+// ---- the watch ----
+
+static volatile sig_atomic_t stop;
+
+static void on_sigint (int sig) {
+  (void)sig;
+  stop = 1;
+}
+
+static double now (void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int receive (const char *path, unsigned long frames, const char *prefix) {
+  static screen sc;
+  struct termios tio;
+  source s = {0};
+  char cmd[32];
+  double start;
+  int r, tty, stopped = 0;
+
+  if ((s.fd = open(path, O_RDWR | O_NOCTTY)) < 0) { perror(path); return 1; }
+  tty = isatty(s.fd);
+
+  if (tty) {
+    tcgetattr(s.fd, &tio);
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(s.fd, TCSANOW, &tio);
+    tcflush(s.fd, TCIOFLUSH);
+    snprintf(cmd, sizeof(cmd), frames ? "stream %lu\r" : "stream\r", frames);
+    if (write(s.fd, cmd, strlen(cmd)) != (ssize_t)strlen(cmd)) { perror(path); return 1; }
+    signal(SIGINT, on_sigint);
+  }
+
+  start = now();
+  while ((r = frame(&s, &sc, sc.frames == 0)) > 0) {
+    if (prefix && !save(&sc, prefix)) return 1;
+    if (stop && !stopped) {
+      // any byte ends the stream, the frames sent meanwhile still arrive
+      stopped = write(s.fd, "\r", 1) == 1;
+    }
+  }
+  if (r < 0) fprintf(stderr, "%s: stream broken after %lu frames\n", path, sc.frames);
+
+  // the statistics of the watch up to the next prompt
+  if (!r && tty) {
+    const char *prompt = "ch> ";
+    int c, k = 0;
+    while (prompt[k] && (c = next(&s)) >= 0) {
+      putchar(c);
+      k = c == prompt[k] ? k + 1 : c == prompt[0];
+    }
+    putchar('\n');
+  }
+  report(&sc, tty ? now() - start : 0);
+  close(s.fd);
+  return r < 0;
+}
+
+// ---- the bench ----
+
+static uint16_t swap (uint16_t c) {
+  return (uint16_t)(c << 8 | c >> 8);
+}
+
+static void line (int x0, int y0, int x1, int y1, uint16_t c) {
+  int dx = abs(x1 - x0), dy = -abs(y1 - y0), sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1, e = dx + dy, e2;
+  for (;;) {
+    if (x0 >= 0 && x0 < W && y0 >= 0 && y0 < H) sim_fb[y0 * W + x0] = swap(c);
+    if (x0 == x1 && y0 == y1) return;
+    e2 = 2 * e;
+    if (e2 >= dy) { e += dy; x0 += sx; }
+    if (e2 <= dx) { e += dx; y0 += sy; }
+  }
+}
+
+static void hand (double turn, int len, uint16_t c) {
+  line(64, 64, 64 + (int)lround(len * sin(turn * 2 * M_PI)), 64 - (int)lround(len * cos(turn * 2 * M_PI)), c);
+}
+
+// a face with ticks, hour and minute hands and a second hand at sec
+static void face (int sec) {
+  int i;
+  memset(sim_fb, 0, sizeof(sim_fb));
+  for (i = 0; i < 60; i++) {
+    double a = i / 60.0 * 2 * M_PI;
+    int r = i % 5 ? 56 : 50;
+    line(64 + (int)lround(r * sin(a)), 64 - (int)lround(r * cos(a)),
+      64 + (int)lround(60 * sin(a)), 64 - (int)lround(60 * cos(a)), i % 5 ? 0x7BEF : 0xFFFF);
+  }
+  hand(10.2 / 12, 30, 0xFFFF);
+  hand(12.0 / 60, 45, 0xFFFF);
+  hand(sec / 60.0, 55, 0xF800);
+}
+
+static int bench (unsigned long frames) {
+  static screen sc;
+  source s = {0};
+  unsigned long f;
+  unsigned i;
+
+  for (f = 0; f < frames; f++) {
+    face((int)f % 60);
+    sim_len = 0;
+    olv_stream_frame(NULL, (uint16_t)f, f == 0);
+    s.mem = sim_out;
+    s.len = sim_len;
+    s.pos = 0;
+    if (frame(&s, &sc, 0) != 1 || s.pos != s.len) {
+      fprintf(stderr, "frame %lu does not decode\n", f);
+      return 1;
+    }
+    for (i = 0; i < W * H; i++)
+      if (sc.px[i] != swap(sim_fb[i])) {
+        fprintf(stderr, "frame %lu differs at pixel %u\n", f, i);
+        return 1;
+      }
+    if (f == 0) printf("first frame %lu bytes of %d raw\n", sc.frame_bytes, W * H * 2);
+  }
+
+  printf("encoder  %lu frames, %lu tiles, %lu bytes avg, %lu bytes max\n", olv_stream.frames,
+    olv_stream.tiles, olv_stream.frames ? olv_stream.bytes / olv_stream.frames : 0, olv_stream.bytes_max);
+  printf("decoder  ");
+  report(&sc, 0);
+  return 0;
+}
+
+int main (int argc, char *argv[]) {
+  if (argc >= 2 && !strcmp(argv[1], "bench"))
+    return bench(argc > 2 ? strtoul(argv[2], NULL, 10) : 120);
+  if (argc >= 2 && argc <= 4)
+    return receive(argv[1], argc > 2 ? strtoul(argv[2], NULL, 10) : 0, argc > 3 ? argv[3] : NULL);
+  fprintf(stderr, "usage: screenrx device [frames] [prefix] | screenrx bench [frames]\n");
+  return 1;
+}
@@ -0,0 +1,204 @@
+/*
+ * screentx - host side of the olv remote framebuffer.
+ *
+ * build: gcc -O2 -o screentx screentx.c -lm
+ *
+ *   screentx /dev/ttyACM0 [frames] [image.ppm ...]
+ *     starts "push" on the watch shell and sends frames to it, the images
+ *     (binary ppm, 128x128, in the panel orientation) in turn or without
+ *     images a synthetic face with a moving second hand. only the row bands
+ *     that changed since the last frame are sent. ctrl-c or the frame count
+ *     (default 300) ends it.
+ *
+ *   screentx - [frames] [image.ppm ...] > file
+ *     writes the push stream instead, to see the bytes per frame.
+ *
+ * prints the frames, the bytes per frame and the rate. the protocol is
+ * described in src/olv_push/push.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/time.h>
+
+#define W 128
+#define H 128
+#define PACKET 64
+
+// the framebuffer as the watch holds it, high byte first
+static uint8_t frame[H][W * 2], sent[H][W * 2];
+static unsigned long frames, bands, bytes, bytes_max;
+static volatile sig_atomic_t stop;
+
+static void on_sigint (int sig) {
+  (void)sig;
+  stop = 1;
+}
+
+static double now (void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void put (int x, int y, uint16_t c) {
+  if (x < 0 || x >= W || y < 0 || y >= H) return;
+  frame[y][x * 2] = c >> 8;
+  frame[y][x * 2 + 1] = c & 0xFF;
+}
+
+static int load (const char *path) {
+  unsigned w, h, max;
+  int x, y;
+  uint8_t rgb[3];
+  FILE *f = fopen(path, "rb");
+
+  if (!f) { perror(path); return 0; }
+  if (fscanf(f, "P6 %u %u %u", &w, &h, &max) != 3 || w != W || h != H || max != 255 || fgetc(f) < 0) {
+    fprintf(stderr, "%s: not a %dx%d binary ppm\n", path, W, H);
+    fclose(f);
+    return 0;
+  }
+  for (y = 0; y < H; y++)
+    for (x = 0; x < W; x++) {
+      if (fread(rgb, 3, 1, f) != 1) { fprintf(stderr, "%s: short\n", path); fclose(f); return 0; }
+      put(x, y, (uint16_t)((rgb[0] >> 3) << 11 | (rgb[1] >> 2) << 5 | rgb[2] >> 3));
+    }
+  fclose(f);
+  return 1;
+}
+
+static void line (int x0, int y0, int x1, int y1, uint16_t c) {
+  int dx = abs(x1 - x0), dy = -abs(y1 - y0), sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1, e = dx + dy, e2;
+  for (;;) {
+    put(x0, y0, c);
+    if (x0 == x1 && y0 == y1) return;
+    e2 = 2 * e;
+    if (e2 >= dy) { e += dy; x0 += sx; }
+    if (e2 <= dx) { e += dx; y0 += sy; }
+  }
+}
+
+// ticks and a second hand that turns once in 60 frames
+static void face (unsigned long n) {
+  double a;
+  int i;
+
+  memset(frame, 0, sizeof(frame));
+  for (i = 0; i < 60; i++) {
+    a = i / 60.0 * 2 * M_PI;
+    line(64 + (int)lround((i % 5 ? 56 : 50) * sin(a)), 64 - (int)lround((i % 5 ? 56 : 50) * cos(a)),
+      64 + (int)lround(60 * sin(a)), 64 - (int)lround(60 * cos(a)), i % 5 ? 0x7BEF : 0xFFFF);
+  }
+  a = n % 60 / 60.0 * 2 * M_PI;
+  line(64, 64, 64 + (int)lround(55 * sin(a)), 64 - (int)lround(55 * cos(a)), 0xF800);
+}
+
+static int out (int fd, const void *buf, size_t n) {
+  const uint8_t *p = buf;
+  ssize_t r;
+  while (n) {
+    if ((r = write(fd, p, n)) <= 0) { perror("screentx"); return 0; }
+    p += r;
+    n -= (size_t)r;
+  }
+  return 1;
+}
+
+static int header (int fd, char type, int y, int rows) {
+  uint8_t h[PACKET] = {'O', 'P'};
+  h[2] = (uint8_t)type;
+  h[3] = (uint8_t)y;
+  h[4] = (uint8_t)rows;
+  return out(fd, h, sizeof(h));
+}
+
+// the bands of rows that differ from what the watch has
+static int send_frame (int fd, int all) {
+  unsigned long n = PACKET;
+  int y = 0, rows;
+
+  while (y < H) {
+    if (!all && !memcmp(frame[y], sent[y], W * 2)) { y++; continue; }
+    for (rows = 1; y + rows < H && (all || memcmp(frame[y + rows], sent[y + rows], W * 2)); rows++);
+    if (!header(fd, 'B', y, rows) || !out(fd, frame[y], (size_t)rows * W * 2)) return 0;
+    memcpy(sent[y], frame[y], (size_t)rows * W * 2);
+    n += PACKET + (unsigned long)rows * W * 2;
+    bands++;
+    y += rows;
+  }
+  if (!header(fd, 'F', 0, 0)) return 0;
+
+  frames++;
+  bytes += n;
+  if (n > bytes_max) bytes_max = n;
+  return 1;
+}
+
+// waits for the marker, what comes before is echoed text
+static int expect (int fd, const char *marker, int echo) {
+  int k = 0;
+  char c;
+  while (marker[k]) {
+    if (read(fd, &c, 1) != 1) return 0;
+    if (echo) putchar(c);
+    k = c == marker[k] ? k + 1 : c == marker[0];
+  }
+  return 1;
+}
+
+int main (int argc, char *argv[]) {
+  unsigned long count = argc > 2 ? strtoul(argv[2], NULL, 10) : 300, n;
+  int images = argc > 3 ? argc - 3 : 0, fd, tty;
+  struct termios tio;
+  double start;
+
+  if (argc < 2 || !count) {
+    fprintf(stderr, "usage: screentx device|- [frames] [image.ppm ...]\n");
+    return 1;
+  }
+
+  if (!strcmp(argv[1], "-")) fd = 1;
+  else if ((fd = open(argv[1], O_RDWR | O_NOCTTY)) < 0) { perror(argv[1]); return 1; }
+  tty = isatty(fd) && fd != 1;
+
+  if (tty) {
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    if (!out(fd, "push\r", 5) || !expect(fd, "OR", 0)) {
+      fprintf(stderr, "%s: push mode did not start\n", argv[1]);
+      return 1;
+    }
+    signal(SIGINT, on_sigint);
+  }
+
+  start = now();
+  for (n = 0; n < count && !stop; n++) {
+    if (images ? !load(argv[3 + n % images]) : (face(n), 0)) break;
+    if (!send_frame(fd, n == 0)) break;
+  }
+  header(fd, 'E', 0, 0);
+
+  // the statistics of the watch up to the next prompt
+  if (tty) {
+    expect(fd, "ch> ", 1);
+    putchar('\n');
+  }
+
+  fprintf(stderr, "%lu frames, %lu bands, %.0f bytes avg, %lu bytes max", frames, bands,
+    frames ? (double)bytes / frames : 0.0, bytes_max);
+  if (tty) fprintf(stderr, ", %.1f frames/s, %.0f kB/s", frames / (now() - start), bytes / (now() - start) / 1000);
+  fprintf(stderr, "\n");
+  return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * ticksim - host test of the tickless idle arithmetic of the ARMv7-M port.
+ *
+ * build: gcc -O2 -o ticksim ticksim.c
+ *
+ *   ticksim [entries] [seed]
+ *
+ * runs the SysTick arithmetic of include/chibios/os/ports/GCC/ARMCMx/
+ * chcore_tickless.h against a model of the counter: random run times
+ * between idle entries, random cycles while the counter stands still and
+ * sleeps that end early, on the deadline or a little after it. every tick
+ * boundary of the real time must be counted once, by an interrupt or as a
+ * skipped tick, and the next tick must end on a boundary again. a tick
+ * stretched by the one cycle reload clamp moves the boundaries by a
+ * cycle, those are counted and followed. exits 1 on the first mismatch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "../include/chibios/os/ports/GCC/ARMCMx/chcore_tickless.h"
+
+#define RVR_RELOAD_MASK 0xFFFFFFU
+
+// 1 kHz tick at 72 MHz, as the watch runs
+#define PERIOD 72000U
+
+static uint64_t now;        // cycles of real time
+static uint64_t boundary;   // the next tick boundary of real time
+static uint64_t next;       // the end of the current tick as the counter has it
+static uint64_t ticks;      // counted by interrupts and skips
+static uint64_t expected;   // boundaries of real time passed
+static unsigned long clamps;
+
+static uint32_t rnd (uint32_t n) {
+  return (uint32_t)(((uint64_t)rand() << 16 ^ (uint64_t)rand()) % n);
+}
+
+// real time passes with the counter running, every boundary interrupts
+static void run (uint32_t cycles) {
+  now += cycles;
+  while (next <= now) {
+    ticks++;
+    next += PERIOD;
+  }
+  while (boundary <= now) {
+    expected++;
+    boundary += PERIOD;
+  }
+}
+
+// real time passes with the counter stopped
+static void stand (uint32_t cycles) {
+  now += cycles;
+  while (boundary <= now) {
+    expected++;
+    boundary += PERIOD;
+  }
+}
+
+static int fail (unsigned long entry, const char *what) {
+  fprintf(stderr, "entry %lu: %s (ticks %llu expected %llu)\n", entry, what,
+    (unsigned long long)ticks, (unsigned long long)expected);
+  return 1;
+}
+
+int main (int argc, char *argv[]) {
+  unsigned long entries = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+  unsigned long i;
+  uint32_t first, reload, elapsed, passed, left, cvr, k, idle, wrapped;
+
+  srand(argc > 2 ? (unsigned)atoi(argv[2]) : 1);
+  next = boundary = PERIOD;
+
+  for (i = 0; i < entries; i++) {
+    run(rnd(3 * PERIOD));
+    idle = 1 + rnd(400);
+
+    // stopping the counter, at zero the interrupt of that tick is pending
+    cvr = (uint32_t)(next - now);
+    if (cvr == PERIOD) cvr = 0;
+    first = cvr == 0 ? PERIOD : cvr;
+    elapsed = 0;
+    wrapped = 0;
+
+    // the instructions while the counter stands still
+    k = rnd(200);
+    stand(k);
+    elapsed += k;
+
+    // a pending interrupt is served before sleeping
+    if (cvr != 0) {
+      if (idle > (RVR_RELOAD_MASK - first) / PERIOD) idle = (RVR_RELOAD_MASK - first) / PERIOD;
+      reload = first + idle * PERIOD;
+
+      // woken early, on the deadline or a few cycles after it
+      switch (rnd(3)) {
+      case 0: k = rnd(reload); break;
+      case 1: k = reload; break;
+      default: k = reload + 1 + rnd(300);
+      }
+      wrapped = k >= reload;
+      cvr = k == 0 ? 0 : k <= reload ? reload - k : reload - (k - reload);
+      if (port_tickless_slept(reload, cvr, wrapped) != k) return fail(i, "sleep miscounted");
+      stand(k);
+      elapsed += k;
+    }
+
+    // the cycles of the arithmetic itself
+    k = rnd(100);
+    stand(k);
+    passed = port_tickless_passed(PERIOD, first, elapsed + k, &left);
+    k = rnd(60);
+    stand(k);
+    passed += port_tickless_passed(PERIOD, left, k, &left);
+    if (left < 1 || left > PERIOD) return fail(i, "left out of range");
+
+    // the pending interrupt serves the last tick of a full sleep
+    if (wrapped) passed--;
+    ticks += passed + wrapped;
+    if (left == 1) {
+      clamps++;
+      // the stretched tick ends a cycle late, real time follows it
+      boundary++;
+    }
+    next = now + port_tickless_reload(left) + 1;
+    if (next != boundary) return fail(i, "out of phase");
+    if (ticks != expected) return fail(i, "ticks lost");
+  }
+
+  printf("%lu idle entries, %llu ticks, %lu clamped reloads: ok\n", entries,
+    (unsigned long long)ticks, clamps);
+  return 0;
+}